@@ -0,0 +1,554 @@
+// Microbenchmarks for the scalar operations of every format and for the
+// kernels in include/algorithms.
+//
+// Each case is calibrated so one sample runs for at least --min-sample-ms,
+// warmed up, and then timed for --samples samples. Results are reported per
+// element (one output value, or one matrix entry per iteration for gradient
+// descent) as median, p99 and minimum nanoseconds, plus GFLOP/s at the
+// median where the case has a defined flop count. `--out results.csv` or
+// `--out results.json` writes the same rows in a machine-readable form.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "algorithms/fft.hpp"
+#include "algorithms/fir.hpp"
+#include "algorithms/gradient_descent.hpp"
+#include "algorithms/matmul.hpp"
+#include "algorithms/mx.hpp"
+#include "algorithms/newton.hpp"
+#include "core/io.hpp"
+#include "core/random.hpp"
+#include "formats/dispatch.hpp"
+#include "formats/mx.hpp"
+#include "formats/packed.hpp"
+#include "formats/precision.hpp"
+
+namespace {
+
+namespace alg = fpstudy::algorithms;
+namespace core = fpstudy::core;
+namespace fmt = fpstudy::formats;
+namespace json = fpstudy::core::json;
+
+#ifndef FPSTUDY_VERSION
+#define FPSTUDY_VERSION "unknown"
+#endif
+
+// Keeps the compiler from discarding a benchmark's results.
+inline void keep(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(p) : "memory");
+#else
+    static const void* volatile sink;
+    sink = p;
+#endif
+}
+
+struct BenchCase {
+    std::string group;     // "op", "matmul", "fir", ...
+    std::string name;      // operation or kernel variant
+    std::string format;
+    std::string backend;
+    std::size_t size = 0;
+    double elements = 0;   // per call
+    double flops = 0;      // per call; 0 when not defined
+    std::function<void()> body;
+
+    std::string label() const {
+        std::string text = group;
+        text += '/';
+        text += format;
+        text += '/';
+        text += name;
+        if (!backend.empty()) {
+            text += '/';
+            text += backend;
+        }
+        if (size > 0) {
+            text += '/';
+            text += std::to_string(size);
+        }
+        return text;
+    }
+};
+
+struct BenchResult {
+    std::size_t reps = 0;
+    std::size_t samples = 0;
+    double median_ns = 0;  // per element
+    double p99_ns = 0;
+    double min_ns = 0;
+    double gflops = 0;
+};
+
+struct BenchSettings {
+    std::size_t samples = 15;
+    std::size_t warmup = 2;
+    double min_sample_ms = 5.0;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nearest-rank percentile of sorted samples.
+double percentile(const std::vector<double>& sorted, double q) {
+    std::size_t rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+BenchResult run_case(const BenchCase& bench, const BenchSettings& settings) {
+    // One call for calibration, then as many per sample as min_sample_ms needs.
+    auto start = std::chrono::steady_clock::now();
+    bench.body();
+    const double once = std::max(seconds_since(start), 1e-9);
+    BenchResult result;
+    result.reps = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(settings.min_sample_ms * 1e-3 / once)));
+    result.samples = settings.samples;
+
+    std::vector<double> per_element;
+    for (std::size_t s = 0; s < settings.warmup + settings.samples; ++s) {
+        start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < result.reps; ++r) {
+            bench.body();
+        }
+        const double elapsed = seconds_since(start);
+        if (s >= settings.warmup) {
+            per_element.push_back(elapsed * 1e9 / (static_cast<double>(result.reps) * bench.elements));
+        }
+    }
+    std::sort(per_element.begin(), per_element.end());
+    result.median_ns = percentile(per_element, 0.5);
+    result.p99_ns = percentile(per_element, 0.99);
+    result.min_ns = per_element.front();
+    if (bench.flops > 0) {
+        result.gflops = bench.flops / (result.median_ns * bench.elements);
+    }
+    return result;
+}
+
+std::vector<double> random_values(std::size_t n, uint32_t seed) {
+    core::Random rng(seed);
+    auto values = core::random_vector(n, rng, 0.5);
+    return values;
+}
+
+template <typename T>
+constexpr bool has_vectorized_backend() {
+    return fmt::Fp32Emulation<T>::enabled;
+}
+
+// encode, decode, add, mul and fma over arrays of one format. FMA is a * b + c
+// in T, i.e. the product rounded before the add, as every kernel evaluates it
+// (the build disables contraction).
+template <fmt::Precision P>
+void add_scalar_cases(std::vector<BenchCase>& cases) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    constexpr std::size_t n = 4096;
+    const std::string format = fmt::precision_to_string(P);
+    auto doubles = std::make_shared<std::vector<double>>(random_values(n, 11));
+    auto packed = std::make_shared<fmt::PackedVector<P>>(fmt::PackedVector<P>::encode(*doubles));
+    auto decoded = std::make_shared<std::vector<double>>(n);
+    auto a = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(*doubles));
+    auto b = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n, 12)));
+    auto c = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n, 13)));
+    auto out = std::make_shared<std::vector<T>>(n, T{});
+
+    cases.push_back({"op", "encode", format, "", 0, n, 0, [=] {
+                         packed->assign(*doubles);
+                         keep(packed.get());
+                     }});
+    cases.push_back({"op", "decode", format, "", 0, n, 0, [=] {
+                         packed->decode(*decoded);
+                         keep(decoded->data());
+                     }});
+    cases.push_back({"op", "add", format, "", 0, n, n, [=] {
+                         for (std::size_t i = 0; i < n; ++i) {
+                             (*out)[i] = (*a)[i] + (*b)[i];
+                         }
+                         keep(out->data());
+                     }});
+    cases.push_back({"op", "mul", format, "", 0, n, n, [=] {
+                         for (std::size_t i = 0; i < n; ++i) {
+                             (*out)[i] = (*a)[i] * (*b)[i];
+                         }
+                         keep(out->data());
+                     }});
+    cases.push_back({"op", "fma", format, "", 0, n, 2.0 * n, [=] {
+                         for (std::size_t i = 0; i < n; ++i) {
+                             (*out)[i] = (*a)[i] * (*b)[i] + (*c)[i];
+                         }
+                         keep(out->data());
+                     }});
+}
+
+template <fmt::Precision P>
+void add_kernel_cases(std::vector<BenchCase>& cases) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    const std::string format = fmt::precision_to_string(P);
+    std::vector<alg::Backend> backends = {alg::Backend::Reference, alg::Backend::Blocked, alg::Backend::Fixed};
+    if constexpr (has_vectorized_backend<T>()) {
+        backends.push_back(alg::Backend::Vectorized);
+    }
+
+    for (std::size_t n : {32, 64, 128}) {
+        auto A = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n * n, 21)));
+        auto B = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n * n, 22)));
+        auto C = std::make_shared<std::vector<T>>(n * n, T{});
+        for (auto backend : backends) {
+            alg::MatMulOptions opts;
+            opts.backend = backend;
+            const double nn = static_cast<double>(n * n);
+            cases.push_back({"matmul", "square", format, alg::backend_to_string(backend), n, nn,
+                             2.0 * nn * static_cast<double>(n), [=] {
+                                 alg::matmul_square_into<T>(*A, *B, n, std::span<T>(*C), opts);
+                                 keep(C->data());
+                             }});
+        }
+    }
+
+    // fir and gradient descent have no blocked variant; gradient descent has
+    // no fixed one either.
+    std::vector<alg::Backend> row_backends = {alg::Backend::Reference};
+    if constexpr (has_vectorized_backend<T>()) {
+        row_backends.push_back(alg::Backend::Vectorized);
+    }
+    constexpr std::size_t taps = 32;
+    for (std::size_t length : {1024, 16384}) {
+        auto h = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(taps, 31)));
+        auto x = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(length, 32)));
+        std::vector<alg::Backend> fir_backends = row_backends;
+        fir_backends.push_back(alg::Backend::Fixed);
+        for (auto backend : fir_backends) {
+            alg::FIROptions opts;
+            opts.backend = backend;
+            cases.push_back({"fir", "taps32", format, alg::backend_to_string(backend), length,
+                             static_cast<double>(length), 2.0 * taps * static_cast<double>(length), [=] {
+                                 auto y = alg::fir_filter<T>(*h, *x, opts);
+                                 keep(y.data());
+                             }});
+        }
+    }
+
+    constexpr std::size_t gd_iters = 10;
+    for (std::size_t dim : {64, 256}) {
+        std::vector<double> Q(dim * dim);
+        for (std::size_t i = 0; i < dim; ++i) {
+            for (std::size_t j = 0; j < dim; ++j) {
+                Q[i * dim + j] = i == j ? 1.0 : 0.1 / (1.0 + static_cast<double>(i + j));
+            }
+        }
+        auto Qt = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(Q));
+        auto b = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(dim, 41)));
+        auto x0 = std::make_shared<std::vector<T>>(dim, T{});
+        for (auto backend : row_backends) {
+            alg::GradientDescentOptions opts;
+            opts.backend = backend;
+            opts.max_iters = gd_iters;
+            opts.tol = 0.0;  // never converges, so every call runs gd_iters iterations
+            opts.step_size = 0.1;
+            const double entries = static_cast<double>(dim * dim * gd_iters);
+            cases.push_back({"gd", "quadratic", format, alg::backend_to_string(backend), dim, entries,
+                             2.0 * entries, [=] {
+                                 auto result = alg::gradient_descent_quadratic<T>(*Qt, *b, *x0, dim, opts);
+                                 keep(result.x.data());
+                             }});
+        }
+    }
+
+    // Newton on x^3 - 2 with double evaluation, as the sweep runs it:
+    // 3 flops for f, 2 for df and 2 for the update per lane iteration.
+    constexpr std::size_t points = 4096;
+    std::vector<double> starts(points);
+    for (std::size_t i = 0; i < points; ++i) {
+        starts[i] = 0.5 + 2.5 * static_cast<double>(i) / static_cast<double>(points);
+    }
+    auto initials = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(starts));
+    alg::NewtonOptions newton_opts;
+    newton_opts.max_iters = 50;
+    newton_opts.tol = 1e-6;
+    auto f = [](T x) { double v = static_cast<double>(x); return T(v * v * v - 2.0); };
+    auto df = [](T x) { double v = static_cast<double>(x); return T(3.0 * v * v); };
+    auto probe = alg::newton_raphson_batch<T>(*initials, f, df, newton_opts);
+    double lane_iterations = 0;
+    for (std::size_t it : probe.iterations) {
+        lane_iterations += static_cast<double>(it);
+    }
+    cases.push_back({"newton", "batch", format, "", points, static_cast<double>(points), 7.0 * lane_iterations, [=] {
+                         auto result = alg::newton_raphson_batch<T>(*initials, f, df, newton_opts);
+                         keep(result.roots.data());
+                     }});
+}
+
+// E4M3 through the runtime tables, to compare with the compiled layout's
+// "op" cases under the same name.
+void add_runtime_minifloat_cases(std::vector<BenchCase>& cases) {
+    using T = fmt::RuntimeMiniFloat<>;
+    constexpr std::size_t n = 4096;
+    const auto& format = fmt::MiniFloatFormat::get(fmt::minifloat_layout(fmt::kMiniFloatE4M3));
+    const std::string name = fmt::precision_to_string(fmt::kMiniFloatE4M3);
+    fmt::MiniFloatScope scope(format);
+    auto a = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n, 11)));
+    auto b = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n, 12)));
+    auto out = std::make_shared<std::vector<T>>(n, T{});
+    cases.push_back({"op", "add", name, "runtime", 0, n, n, [=, &format] {
+                         fmt::MiniFloatScope active(format);
+                         for (std::size_t i = 0; i < n; ++i) {
+                             (*out)[i] = (*a)[i] + (*b)[i];
+                         }
+                         keep(out->data());
+                     }});
+    cases.push_back({"op", "mul", name, "runtime", 0, n, n, [=, &format] {
+                         fmt::MiniFloatScope active(format);
+                         for (std::size_t i = 0; i < n; ++i) {
+                             (*out)[i] = (*a)[i] * (*b)[i];
+                         }
+                         keep(out->data());
+                     }});
+}
+
+// MiniFloatRuntime is a dispatch tag rather than a format; its cases come
+// from add_runtime_minifloat_cases.
+template <fmt::Precision... Ps>
+void add_all_cases(std::vector<BenchCase>& cases, fmt::PrecisionList<Ps...>) {
+    constexpr auto runtime = fmt::Precision::MiniFloatRuntime;
+    ([&] { if constexpr (Ps != runtime) add_scalar_cases<Ps>(cases); }(), ...);
+    add_runtime_minifloat_cases(cases);
+    ([&] { if constexpr (Ps != runtime) add_kernel_cases<Ps>(cases); }(), ...);
+}
+
+std::vector<BenchCase> all_cases() {
+    std::vector<BenchCase> cases;
+    add_all_cases(cases, fmt::AllPrecisions{});
+    // The FFT truth engine only exists in FP64.
+    constexpr std::size_t taps = 32;
+    for (std::size_t length : {1024, 16384}) {
+        auto h = std::make_shared<std::vector<double>>(random_values(taps, 51));
+        auto x = std::make_shared<std::vector<double>>(random_values(length, 52));
+        cases.push_back({"fir", "taps32_fft", "fp64", "", length, static_cast<double>(length), 0, [=] {
+                             auto y = alg::fir_filter_fft(*h, *x);
+                             keep(y.data());
+                         }});
+    }
+    // Block-scaled MX kernels, with the same shapes as the per-element ones.
+    for (auto layout : {fmt::P3109Layout{4, 3, 7}, fmt::P3109Layout{2, 1, 1}}) {
+        const std::string format = fmt::precision_to_string(fmt::mx_precision(layout));
+        for (std::size_t n : {32, 64, 128}) {
+            auto A = std::make_shared<fmt::MxVector>(fmt::MxVector::encode(layout, random_values(n * n, 21), n));
+            auto Bt = std::make_shared<fmt::MxVector>(fmt::MxVector::encode(layout, random_values(n * n, 22), n));
+            auto C = std::make_shared<std::vector<float>>(n * n);
+            const double nn = static_cast<double>(n * n);
+            cases.push_back({"matmul", "square", format, "", n, nn, 2.0 * nn * static_cast<double>(n), [=] {
+                                 alg::matmul_square_mx_into(*A, *Bt, n, *C);
+                                 keep(C->data());
+                             }});
+        }
+        for (std::size_t length : {1024, 16384}) {
+            auto h = std::make_shared<fmt::MxVector>(fmt::MxVector::encode(layout, random_values(taps, 31)));
+            auto x = std::make_shared<fmt::MxVector>(fmt::MxVector::encode(layout, random_values(length, 32)));
+            cases.push_back({"fir", "taps32", format, "", length, static_cast<double>(length),
+                             2.0 * taps * static_cast<double>(length), [=] {
+                                 auto y = alg::fir_filter_mx(*h, *x);
+                                 keep(y.data());
+                             }});
+        }
+    }
+    // Split-K with FP32 partials against the single-chain FP32 accumulation
+    // it replaces; slices run on every core.
+    {
+        using T = fmt::BF16;
+        constexpr std::size_t n = 256;
+        auto A = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n * n, 21)));
+        auto B = std::make_shared<std::vector<T>>(fmt::cast_vector<T>(random_values(n * n, 22)));
+        auto C = std::make_shared<std::vector<T>>(n * n, T{});
+        const double nn = static_cast<double>(n * n);
+        for (std::size_t split_k : {1, 8}) {
+            alg::MatMulOptions opts{false, true, alg::Backend::Blocked};
+            opts.split_k = split_k;
+            opts.threads = 0;
+            cases.push_back({"matmul", "square_fp32_splitk" + std::to_string(split_k), "bf16", "blocked", n, nn,
+                             2.0 * nn * static_cast<double>(n), [=] {
+                                 alg::matmul_square_into<T>(*A, *B, n, std::span<T>(*C), opts);
+                                 keep(C->data());
+                             }});
+        }
+    }
+    // Input generation: one random_vector of FP64 normals per call.
+    for (auto kind : {core::RngKind::MT19937, core::RngKind::Philox}) {
+        constexpr std::size_t n = std::size_t(1) << 20;
+        cases.push_back({"rng", "normal", "fp64", core::rng_kind_to_string(kind), n, static_cast<double>(n), 0, [=] {
+                             core::Random rng(7, kind);
+                             auto values = core::random_vector(n, rng);
+                             keep(values.data());
+                         }});
+    }
+    return cases;
+}
+
+std::string compiler_string() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+void write_csv(const std::filesystem::path& path,
+               const std::vector<BenchCase>& cases,
+               const std::vector<BenchResult>& results) {
+    core::CsvWriter writer(path, false);
+    writer.write_header({"benchmark", "group", "name", "format", "backend", "size", "elements", "flops", "reps",
+                         "samples", "median_ns_per_elem", "p99_ns_per_elem", "min_ns_per_elem", "gflops"});
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const auto& r = results[i];
+        writer.write_fields({c.label(), c.group, c.name, c.format, c.backend, static_cast<int64_t>(c.size),
+                             c.elements, c.flops, static_cast<int64_t>(r.reps), static_cast<int64_t>(r.samples),
+                             r.median_ns, r.p99_ns, r.min_ns, r.gflops});
+    }
+}
+
+void write_json(const std::filesystem::path& path,
+                const std::vector<BenchCase>& cases,
+                const std::vector<BenchResult>& results,
+                const BenchSettings& settings) {
+    json::Array rows;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const auto& r = results[i];
+        json::Object row;
+        row.emplace("benchmark", json::Value(c.label()));
+        row.emplace("group", json::Value(c.group));
+        row.emplace("name", json::Value(c.name));
+        row.emplace("format", json::Value(c.format));
+        row.emplace("backend", json::Value(c.backend));
+        row.emplace("size", json::Value(static_cast<double>(c.size)));
+        row.emplace("elements", json::Value(c.elements));
+        row.emplace("flops", json::Value(c.flops));
+        row.emplace("reps", json::Value(static_cast<double>(r.reps)));
+        row.emplace("median_ns_per_elem", json::Value(r.median_ns));
+        row.emplace("p99_ns_per_elem", json::Value(r.p99_ns));
+        row.emplace("min_ns_per_elem", json::Value(r.min_ns));
+        row.emplace("gflops", json::Value(r.gflops));
+        rows.emplace_back(std::move(row));
+    }
+    json::Object doc;
+    doc.emplace("schema", json::Value(1));
+    doc.emplace("fpstudy_version", json::Value(FPSTUDY_VERSION));
+    doc.emplace("compiler", json::Value(compiler_string()));
+    doc.emplace("samples", json::Value(static_cast<double>(settings.samples)));
+    doc.emplace("min_sample_ms", json::Value(settings.min_sample_ms));
+    doc.emplace("results", json::Value(std::move(rows)));
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open benchmark output: " + path.string());
+    }
+    out << json::serialize_compact(json::Value(std::move(doc))) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchSettings settings;
+    std::vector<std::string> filters;
+    std::optional<std::filesystem::path> out_path;
+    bool list_only = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filters.emplace_back(argv[++i]);
+        } else if (arg == "--samples" && i + 1 < argc) {
+            settings.samples = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--min-sample-ms" && i + 1 < argc) {
+            settings.min_sample_ms = std::stod(argv[++i]);
+        } else if (arg == "--quick") {
+            settings.samples = 3;
+            settings.warmup = 1;
+            settings.min_sample_ms = 0.2;
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--list") {
+            list_only = true;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: fpstudy_bench [--filter TEXT]... [--samples N] [--min-sample-ms MS] [--quick]"
+                         " [--out results.csv|results.json] [--list]\n"
+                      << "  --filter TEXT       run cases whose name contains TEXT (repeatable)\n"
+                      << "  --samples N         timed samples per case (default 15, after 2 warm-up samples)\n"
+                      << "  --min-sample-ms MS  minimum duration of one sample (default 5)\n"
+                      << "  --quick             3 short samples per case, for smoke tests\n"
+                      << "  --out PATH          write results as CSV, or JSON if PATH ends in .json\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (settings.samples == 0) {
+        std::cerr << "--samples must be positive\n";
+        return 1;
+    }
+
+    std::vector<BenchCase> cases;
+    for (auto& bench : all_cases()) {
+        const auto label = bench.label();
+        bool selected = filters.empty() || std::any_of(filters.begin(), filters.end(), [&](const std::string& f) {
+                            return label.find(f) != std::string::npos;
+                        });
+        if (selected) {
+            cases.push_back(std::move(bench));
+        }
+    }
+    if (list_only) {
+        for (const auto& bench : cases) {
+            std::cout << bench.label() << "\n";
+        }
+        return 0;
+    }
+    if (cases.empty()) {
+        std::cerr << "No benchmark matches the filters.\n";
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "median ns/el"
+              << std::setw(14) << "p99 ns/el" << std::setw(12) << "GFLOP/s" << "\n";
+    for (const auto& bench : cases) {
+        results.push_back(run_case(bench, settings));
+        const auto& r = results.back();
+        std::cout << std::left << std::setw(40) << bench.label() << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << r.median_ns << std::setw(14) << r.p99_ns << std::setw(12);
+        if (bench.flops > 0) {
+            std::cout << r.gflops;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << "\n" << std::flush;
+    }
+
+    if (out_path) {
+        if (out_path->extension() == ".json") {
+            write_json(*out_path, cases, results, settings);
+        } else {
+            write_csv(*out_path, cases, results);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace fpstudy::algorithms {
+
+// Kernel implementation used by an algorithm. Every backend reproduces the
+// per-element operation order of Reference, so results are bit-identical and
+// only the runtime changes. An algorithm without a dedicated implementation
+// of a backend runs its reference loop instead.
+//
+// Vectorized runs packed FP32 lanes for formats with an Fp32Emulation
+// specialization (FP32, TF32, BF16), provided fp32_emulation_verified<T>()
+// confirms the emulation matches the format's own arithmetic. Otherwise
+// matmul runs its blocked kernel, and fir and gradient descent run their
+// reference loops. Fixed runs the compile-time specialized kernels of
+// fixed.hpp for the sizes they cover.
+enum class Backend {
+    Reference,
+    Blocked,
+    Vectorized,
+    Fixed
+};
+
+inline std::string backend_to_string(Backend backend) {
+    switch (backend) {
+        case Backend::Reference: return "reference";
+        case Backend::Blocked: return "blocked";
+        case Backend::Vectorized: return "vectorized";
+        case Backend::Fixed: return "fixed";
+    }
+    throw std::runtime_error("Unknown backend enum");
+}
+
+inline Backend backend_from_string(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower == "reference" || lower == "naive") return Backend::Reference;
+    if (lower == "blocked" || lower == "tiled") return Backend::Blocked;
+    if (lower == "vectorized" || lower == "simd") return Backend::Vectorized;
+    if (lower == "fixed" || lower == "unrolled") return Backend::Fixed;
+    throw std::runtime_error("Unknown backend string: " + std::string(name));
+}
+
+// Memory for a kernel's temporaries (FP32 images, packed panels, running
+// sums), taken from the caller's resource when the options carry one.
+// Results never depend on where the temporaries live.
+inline std::pmr::memory_resource* scratch_resource(std::pmr::memory_resource* scratch) {
+    return scratch ? scratch : std::pmr::get_default_resource();
+}
+
+} // namespace fpstudy::algorithms
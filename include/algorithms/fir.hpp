@@ -2,22 +2,37 @@
 
 #include <vector>
 #include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 
+#include "algorithms/backend.hpp"
+#include "algorithms/fixed.hpp"
+#include "algorithms/vectorized.hpp"
+
 namespace fpstudy::algorithms {
 
 struct FIROptions {
     bool use_kahan = false;
     bool accumulate_in_fp32 = false;
+    Backend backend = Backend::Reference;
+    // Resource for the kernel's temporaries; null uses the default heap.
+    std::pmr::memory_resource* scratch = nullptr;
 };
 
+// Writes the filtered signal into the caller's buffer y, one sample per
+// input sample.
 template <typename T>
-std::vector<T> fir_filter(const std::vector<T>& h,
-                          const std::vector<T>& x,
-                          FIROptions opts = {}) {
+void fir_filter_reference_into(std::span<const T> h,
+                               std::span<const T> x,
+                               std::span<T> y,
+                               FIROptions opts = {}) {
     const std::size_t M = h.size();  // Number of filter taps
     const std::size_t N = x.size();  // Number of input samples
-    std::vector<T> y(N, T{});        // Output signal
+    if (y.size() != N) {
+        throw std::runtime_error("fir_filter: output must hold one sample per input sample");
+    }
 
     for (std::size_t n = 0; n < N; ++n) {
         if (opts.accumulate_in_fp32) {
@@ -60,8 +75,93 @@ std::vector<T> fir_filter(const std::vector<T>& h,
             y[n] = sum;
         }
     }
+}
+
+template <typename T>
+std::vector<T> fir_filter_reference(std::span<const T> h,
+                                    std::span<const T> x,
+                                    FIROptions opts = {}) {
+    std::vector<T> y(x.size(), T{});
+    fir_filter_reference_into(h, x, std::span<T>(y), opts);
     return y;
 }
 
+namespace detail {
+
+// Emulated-lane FIR on FP32 images of h (M taps) and x (N samples); writes
+// the N FP32 outputs to y.
+template <typename T>
+void fir_filter_emulated(const float* h, std::size_t M,
+                         const float* x, std::size_t N,
+                         float* y, FIROptions opts) {
+    constexpr int F = formats::Fp32Emulation<T>::fraction_bits;
+    std::fill(y, y + N, 0.0f);
+    if (opts.accumulate_in_fp32) {
+        if (opts.use_kahan) {
+            emulated_fir_kernel<23, true>(h, M, x, N, y);
+        } else {
+            emulated_fir_kernel<23, false>(h, M, x, N, y);
+        }
+    } else if (opts.use_kahan) {
+        emulated_fir_kernel<F, true>(h, M, x, N, y);
+    } else {
+        emulated_fir_kernel<F, false>(h, M, x, N, y);
+    }
+}
+
+template <typename T>
+void fir_filter_vectorized_into(std::span<const T> h,
+                                std::span<const T> x,
+                                std::span<T> y,
+                                FIROptions opts) {
+    auto* scratch = scratch_resource(opts.scratch);
+    auto hf = to_float_buffer(h, scratch);
+    auto xf = to_float_buffer(x, scratch);
+    std::pmr::vector<float> yf(xf.size(), scratch);
+    fir_filter_emulated<T>(hf.data(), hf.size(), xf.data(), xf.size(), yf.data(), opts);
+    from_float_buffer<T>(yf, y);
+}
+
+} // namespace detail
+
+// Writes the filtered signal into the caller's buffer y (x.size() samples).
+template <typename T>
+void fir_filter_into(std::span<const T> h,
+                     std::span<const T> x,
+                     std::span<T> y,
+                     FIROptions opts = {}) {
+    if constexpr (formats::Fp32Emulation<T>::enabled) {
+        if (opts.backend == Backend::Vectorized && formats::fp32_emulation_verified<T>()) {
+            if (y.size() != x.size()) {
+                throw std::runtime_error("fir_filter: output must hold one sample per input sample");
+            }
+            detail::fir_filter_vectorized_into(h, x, y, opts);
+            return;
+        }
+    }
+    if (opts.backend == Backend::Fixed && y.size() == x.size() &&
+        fir_filter_fixed_dispatch(h.data(), h.size(), x.data(), x.size(), y.data(), opts.use_kahan,
+                                  opts.accumulate_in_fp32)) {
+        return;
+    }
+    fir_filter_reference_into(h, x, y, opts);
+}
+
+template <typename T>
+std::vector<T> fir_filter(std::span<const T> h,
+                          std::span<const T> x,
+                          FIROptions opts = {}) {
+    std::vector<T> y(x.size(), T{});
+    fir_filter_into(h, x, std::span<T>(y), opts);
+    return y;
+}
+
+template <typename T>
+std::vector<T> fir_filter(const std::vector<T>& h,
+                          const std::vector<T>& x,
+                          FIROptions opts = {}) {
+    return fir_filter(std::span<const T>(h), std::span<const T>(x), opts);
+}
+
 } // namespace fpstudy::algorithms
 
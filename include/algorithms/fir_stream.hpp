@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "algorithms/fir.hpp"
+
+namespace fpstudy::algorithms {
+
+// Stateful FIR filter that consumes a signal block by block.
+//
+// The last M input samples live in a mirrored ring of 2M slots: each sample
+// is written at `pos` and `pos + M`, so x[n], x[n-1], ..., x[n-M+1] are always
+// the contiguous run delay[pos .. pos + M). Every output is then a straight
+// dot product over k ascending with the statements of fir_filter_reference.
+// The first M - 1 outputs of the stream, which see fewer taps, are handled
+// before the steady-state loop, so the tap loop itself never tests bounds.
+// Concatenated outputs are bitwise equal to fir_filter on the whole signal
+// for the same FIROptions; the backend field is ignored because all FIR
+// backends agree bit for bit.
+template <typename T>
+class FirStream {
+public:
+    static constexpr std::size_t default_block_size = 4096;
+
+    explicit FirStream(std::span<const T> h, FIROptions opts = {})
+        : opts_(opts), taps_(h.size()) {
+        if (opts_.accumulate_in_fp32) {
+            taps_f_.reserve(taps_);
+            for (const T& coeff : h) {
+                taps_f_.push_back(static_cast<float>(coeff));
+            }
+            delay_f_.assign(2 * taps_, 0.0f);
+        } else {
+            taps_t_.assign(h.begin(), h.end());
+            delay_t_.assign(2 * taps_, T{});
+        }
+    }
+
+    explicit FirStream(const std::vector<T>& h, FIROptions opts = {})
+        : FirStream(std::span<const T>(h), opts) {}
+
+    // Filters the next in.size() samples of the signal into out.
+    void process(std::span<const T> in, std::span<T> out) {
+        if (in.size() != out.size()) {
+            throw std::runtime_error("FirStream::process: input and output sizes differ");
+        }
+        if (taps_ == 0) {
+            std::fill(out.begin(), out.end(), T{});
+            samples_ += in.size();
+            return;
+        }
+        if (opts_.accumulate_in_fp32) {
+            run(in, out, taps_f_, delay_f_);
+        } else {
+            run(in, out, taps_t_, delay_t_);
+        }
+    }
+
+    std::vector<T> process(std::span<const T> in) {
+        std::vector<T> out(in.size(), T{});
+        process(in, std::span<T>(out));
+        return out;
+    }
+
+    // Pulls blocks from `read(std::span<T>) -> std::size_t` until it returns
+    // 0 and hands each filtered block to `write(std::span<const T>)`. Memory
+    // use is two blocks plus the delay line, whatever the signal length.
+    template <typename Reader, typename Writer>
+    std::uint64_t filter(Reader&& read, Writer&& write, std::size_t block_size = default_block_size) {
+        if (block_size == 0) {
+            throw std::runtime_error("FirStream::filter: block size must be positive");
+        }
+        std::vector<T> in(block_size, T{});
+        std::vector<T> out(block_size, T{});
+        std::uint64_t total = 0;
+        for (;;) {
+            std::size_t count = read(std::span<T>(in));
+            if (count == 0) {
+                break;
+            }
+            if (count > block_size) {
+                throw std::runtime_error("FirStream::filter: reader returned more samples than requested");
+            }
+            process(std::span<const T>(in.data(), count), std::span<T>(out.data(), count));
+            write(std::span<const T>(out.data(), count));
+            total += count;
+        }
+        return total;
+    }
+
+    // Clears the delay line so the next sample starts a new signal.
+    void reset() {
+        std::fill(delay_f_.begin(), delay_f_.end(), 0.0f);
+        std::fill(delay_t_.begin(), delay_t_.end(), T{});
+        pos_ = 0;
+        samples_ = 0;
+    }
+
+    std::size_t taps() const { return taps_; }
+    std::uint64_t samples_processed() const { return samples_; }
+
+private:
+    template <typename Elem, bool Kahan>
+    static Elem dot(const Elem* h, const Elem* d, std::size_t count) {
+        Elem sum{};
+        Elem compensation{};
+        for (std::size_t k = 0; k < count; ++k) {
+            Elem prod = h[k] * d[k];
+            if constexpr (Kahan) {
+                Elem y_val = prod - compensation;
+                Elem t = sum + y_val;
+                compensation = (t - sum) - y_val;
+                sum = t;
+            } else {
+                sum = sum + prod;
+            }
+        }
+        return sum;
+    }
+
+    template <typename Elem>
+    void push(Elem sample, std::vector<Elem>& delay) {
+        pos_ = (pos_ == 0 ? taps_ : pos_) - 1;
+        delay[pos_] = sample;
+        delay[pos_ + taps_] = sample;
+    }
+
+    template <typename Elem>
+    void run(std::span<const T> in, std::span<T> out,
+             const std::vector<Elem>& h, std::vector<Elem>& delay) {
+        if (opts_.use_kahan) {
+            run_impl<Elem, true>(in, out, h, delay);
+        } else {
+            run_impl<Elem, false>(in, out, h, delay);
+        }
+    }
+
+    template <typename Elem, bool Kahan>
+    void run_impl(std::span<const T> in, std::span<T> out,
+                  const std::vector<Elem>& h, std::vector<Elem>& delay) {
+        std::size_t i = 0;
+        // Prologue: output n only has taps 0..n.
+        for (; i < in.size() && samples_ + 1 < taps_; ++i) {
+            push(static_cast<Elem>(in[i]), delay);
+            out[i] = T(dot<Elem, Kahan>(h.data(), delay.data() + pos_, static_cast<std::size_t>(samples_) + 1));
+            ++samples_;
+        }
+        const std::size_t steady = i;
+        for (; i < in.size(); ++i) {
+            push(static_cast<Elem>(in[i]), delay);
+            out[i] = T(dot<Elem, Kahan>(h.data(), delay.data() + pos_, taps_));
+        }
+        samples_ += in.size() - steady;
+    }
+
+    FIROptions opts_;
+    std::size_t taps_ = 0;
+    std::vector<float> taps_f_;
+    std::vector<float> delay_f_;
+    std::vector<T> taps_t_;
+    std::vector<T> delay_t_;
+    std::size_t pos_ = 0;
+    std::uint64_t samples_ = 0;
+};
+
+} // namespace fpstudy::algorithms
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Kernels specialized at compile time for the sizes the sweep configs use.
+// Size and options are template parameters, so the loops have constant trip
+// counts, the use_kahan / accumulate_in_fp32 branches are resolved before
+// the loops run, and the FIR tap loop is fully unrolled. Each output still
+// sees the reference's sequence of operations, so results are bit-identical
+// to matmul_square_reference / fir_filter_reference.
+//
+// The *_fixed_dispatch functions map a runtime size onto a specialization
+// and return false when there is none; Backend::Fixed then runs the
+// reference loop.
+
+namespace fpstudy::algorithms {
+
+inline constexpr std::array<std::size_t, 3> kFixedMatMulSizes = {16, 32, 64};
+inline constexpr std::array<std::size_t, 3> kFixedFirTaps = {8, 16, 32};
+
+namespace detail {
+
+template <typename Acc>
+inline void fixed_accumulate(Acc& sum, Acc& compensation, const Acc& prod, std::bool_constant<true>) {
+    Acc y = prod - compensation;
+    Acc t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+}
+
+template <typename Acc>
+inline void fixed_accumulate(Acc& sum, Acc&, const Acc& prod, std::bool_constant<false>) {
+    sum = sum + prod;
+}
+
+// Calls fn(flags...) with the two options as std::bool_constant.
+template <typename Fn>
+decltype(auto) dispatch_fixed_flags(bool use_kahan, bool accumulate_in_fp32, Fn&& fn) {
+    auto with_fp32 = [&](auto kahan) -> decltype(auto) {
+        return accumulate_in_fp32 ? fn(kahan, std::true_type{}) : fn(kahan, std::false_type{});
+    };
+    return use_kahan ? with_fp32(std::true_type{}) : with_fp32(std::false_type{});
+}
+
+} // namespace detail
+
+// C = A B for N x N row-major operands. Rows are produced in i-k-j order
+// with one running sum per output column, which keeps every C[i, j] on the
+// reference's ascending-k chain while the j loop vectorizes.
+template <typename T, std::size_t N, bool Kahan, bool Fp32>
+void matmul_square_fixed(const T* A, const T* B, T* C) {
+    using Acc = std::conditional_t<Fp32, float, T>;
+    constexpr std::bool_constant<Kahan> kahan{};
+    for (std::size_t i = 0; i < N; ++i) {
+        std::array<Acc, N> sums{};
+        std::array<Acc, N> comps{};
+        for (std::size_t k = 0; k < N; ++k) {
+            const Acc a = static_cast<Acc>(A[i * N + k]);
+            const T* b = B + k * N;
+            for (std::size_t j = 0; j < N; ++j) {
+                const Acc prod = a * static_cast<Acc>(b[j]);
+                detail::fixed_accumulate(sums[j], comps[j], prod, kahan);
+            }
+        }
+        for (std::size_t j = 0; j < N; ++j) {
+            C[i * N + j] = T(sums[j]);
+        }
+    }
+}
+
+// y[n] = sum over k of h[k] x[n - k] for M taps and `length` samples. The
+// first M - 1 outputs stop at k = n; every later one runs all M taps through
+// an unrolled sequence.
+template <typename T, std::size_t M, bool Kahan, bool Fp32>
+void fir_filter_fixed(const T* h, const T* x, std::size_t length, T* y) {
+    using Acc = std::conditional_t<Fp32, float, T>;
+    constexpr std::bool_constant<Kahan> kahan{};
+    std::array<Acc, M> taps;
+    for (std::size_t k = 0; k < M; ++k) {
+        taps[k] = static_cast<Acc>(h[k]);
+    }
+    const std::size_t head = length < M - 1 ? length : M - 1;
+    for (std::size_t n = 0; n < head; ++n) {
+        Acc sum{};
+        Acc compensation{};
+        for (std::size_t k = 0; k <= n; ++k) {
+            detail::fixed_accumulate(sum, compensation, Acc(taps[k] * static_cast<Acc>(x[n - k])), kahan);
+        }
+        y[n] = T(sum);
+    }
+    for (std::size_t n = head; n < length; ++n) {
+        Acc sum{};
+        Acc compensation{};
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            (detail::fixed_accumulate(sum, compensation, Acc(taps[K] * static_cast<Acc>(x[n - K])), kahan), ...);
+        }(std::make_index_sequence<M>{});
+        y[n] = T(sum);
+    }
+}
+
+// Runs matmul_square_fixed when n is in kFixedMatMulSizes.
+template <typename T>
+bool matmul_square_fixed_dispatch(const T* A, const T* B, std::size_t n, T* C, bool use_kahan,
+                                  bool accumulate_in_fp32) {
+    return detail::dispatch_fixed_flags(use_kahan, accumulate_in_fp32, [&](auto kahan, auto fp32) {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return ((n == kFixedMatMulSizes[I] &&
+                     (matmul_square_fixed<T, kFixedMatMulSizes[I], decltype(kahan)::value, decltype(fp32)::value>(A, B, C),
+                      true)) ||
+                    ...);
+        }(std::make_index_sequence<kFixedMatMulSizes.size()>{});
+    });
+}
+
+// Runs fir_filter_fixed when the tap count is in kFixedFirTaps.
+template <typename T>
+bool fir_filter_fixed_dispatch(const T* h, std::size_t taps, const T* x, std::size_t length, T* y, bool use_kahan,
+                               bool accumulate_in_fp32) {
+    return detail::dispatch_fixed_flags(use_kahan, accumulate_in_fp32, [&](auto kahan, auto fp32) {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return ((taps == kFixedFirTaps[I] &&
+                     (fir_filter_fixed<T, kFixedFirTaps[I], decltype(kahan)::value, decltype(fp32)::value>(h, x, length, y),
+                      true)) ||
+                    ...);
+        }(std::make_index_sequence<kFixedFirTaps.size()>{});
+    });
+}
+
+} // namespace fpstudy::algorithms
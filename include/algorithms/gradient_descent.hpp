@@ -1,15 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <barrier>
 #include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <thread>
+#include <utility>
+#include <stdexcept>
 #include <vector>
 #include <cmath>
 
+#include "algorithms/backend.hpp"
+#include "algorithms/vectorized.hpp"
+
 namespace fpstudy::algorithms {
 
 struct GradientDescentOptions {
     double step_size = 1e-2;
     std::size_t max_iters = 1000;
     double tol = 1e-6;
+    Backend backend = Backend::Reference;
+    // Threads sharing the gradient rows of each iteration, including the
+    // caller; 0 means one per hardware thread. Results do not depend on it.
+    std::size_t threads = 1;
+    // Resource for the kernel's temporaries; null uses the default heap.
+    std::pmr::memory_resource* scratch = nullptr;
 };
 
 template <typename T>
@@ -19,36 +35,225 @@ struct GradientDescentResult {
     bool converged = false;
 };
 
-template <typename T>
-GradientDescentResult<T> gradient_descent_quadratic(const std::vector<T>& Q,
-                                                    const std::vector<T>& b,
-                                                    const std::vector<T>& initial,
-                                                    std::size_t dim,
-                                                    const GradientDescentOptions& opts) {
-    std::vector<T> x = initial;
-    std::vector<T> gradient(dim, T{});
-    for (std::size_t iter = 0; iter < opts.max_iters; ++iter) {
-        for (std::size_t i = 0; i < dim; ++i) {
-            T acc{};
-            for (std::size_t j = 0; j < dim; ++j) {
-                acc = acc + Q[i * dim + j] * x[j];
+// Outcome of a run whose iterate went to a caller-provided buffer.
+struct GradientDescentStatus {
+    std::size_t iterations = 0;
+    bool converged = false;
+};
+
+namespace detail {
+
+// Rows below which another gradient descent thread costs more than it saves.
+inline constexpr std::size_t kRowsPerThread = 128;
+
+inline std::size_t gradient_descent_threads(std::size_t requested, std::size_t dim) {
+    std::size_t threads = requested == 0 ? std::max(1u, std::thread::hardware_concurrency()) : requested;
+    return std::max<std::size_t>(1, std::min(threads, dim / kRowsPerThread));
+}
+
+// Drives the iteration for a row kernel `rows(lo, hi, x, x_next, gradient,
+// norm)` that writes gradient[i] and the stepped x_next[i] for rows [lo, hi)
+// and, when norm is non-null, adds the squared gradient entries to *norm in
+// row order. Computing x_next in the same pass as the gradient means the next
+// iteration's rows start right after the convergence test, and the two
+// buffers swap roles instead of running a separate update loop. x holds the
+// initial point on entry and the final iterate on return.
+//
+// With one thread the norm is fused into the row pass. With several, each
+// thread owns a contiguous row block and a std::barrier ends the iteration;
+// its completion step sums the norm over the whole gradient in row order.
+// Either way every value, the norm and the iteration count match the
+// reference loop exactly.
+template <typename V, typename Rows>
+std::size_t run_gradient_rows(std::span<V> x,
+                              std::size_t dim,
+                              const GradientDescentOptions& opts,
+                              bool& converged,
+                              Rows rows) {
+    auto* scratch = scratch_resource(opts.scratch);
+    std::pmr::vector<V> x_next(x.begin(), x.end(), scratch);
+    std::pmr::vector<V> gradient(dim, V{}, scratch);
+    converged = false;
+    V* current = x.data();
+    V* next = x_next.data();
+    // The final iterate ends up in whichever buffer the last swap left current.
+    auto finish = [&](std::size_t iterations) {
+        if (current != x.data()) {
+            std::copy(current, current + dim, x.data());
+        }
+        return iterations;
+    };
+    const std::size_t threads = gradient_descent_threads(opts.threads, dim);
+    if (threads == 1) {
+        for (std::size_t iter = 0; iter < opts.max_iters; ++iter) {
+            double grad_norm = 0.0;
+            rows(0, dim, current, next, gradient.data(), &grad_norm);
+            if (std::sqrt(grad_norm) < opts.tol) {
+                converged = true;
+                return finish(iter);
             }
-            gradient[i] = acc + b[i];
+            std::swap(current, next);
         }
+        return finish(opts.max_iters);
+    }
+
+    std::size_t iter = 0;
+    bool done = opts.max_iters == 0;
+    auto end_iteration = [&]() noexcept {
         double grad_norm = 0.0;
-        for (const T& g : gradient) {
+        for (const V& g : gradient) {
             double gd = static_cast<double>(g);
             grad_norm += gd * gd;
         }
-        grad_norm = std::sqrt(grad_norm);
-        if (grad_norm < opts.tol) {
-            return {x, iter, true};
+        if (std::sqrt(grad_norm) < opts.tol) {
+            converged = true;
+            done = true;
+            return;
         }
-        for (std::size_t i = 0; i < dim; ++i) {
-            x[i] = x[i] - T(opts.step_size) * gradient[i];
+        std::swap(current, next);
+        done = ++iter == opts.max_iters;
+    };
+    std::barrier sync(static_cast<std::ptrdiff_t>(threads), end_iteration);
+    auto work = [&](std::size_t t) {
+        const std::size_t lo = dim * t / threads;
+        const std::size_t hi = dim * (t + 1) / threads;
+        while (!done) {
+            rows(lo, hi, current, next, gradient.data(), nullptr);
+            sync.arrive_and_wait();
         }
+    };
+    {
+        std::vector<std::jthread> helpers;
+        for (std::size_t t = 1; t < threads; ++t) {
+            helpers.emplace_back(work, t);
+        }
+        work(0);
     }
-    return {x, opts.max_iters, false};
+    return finish(converged ? iter : opts.max_iters);
+}
+
+} // namespace detail
+
+// Runs from `initial` and leaves the final iterate in the caller's buffer x.
+template <typename T>
+GradientDescentStatus gradient_descent_quadratic_reference_into(std::span<const T> Q,
+                                                                std::span<const T> b,
+                                                                std::span<const T> initial,
+                                                                std::size_t dim,
+                                                                std::span<T> x,
+                                                                const GradientDescentOptions& opts) {
+    std::copy(initial.begin(), initial.end(), x.begin());
+    const T step(opts.step_size);
+    bool converged = false;
+    std::size_t iterations = detail::run_gradient_rows(
+        x, dim, opts, converged,
+        [&](std::size_t lo, std::size_t hi, const T* x_in, T* x_out, T* gradient, double* grad_norm) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                T acc{};
+                for (std::size_t j = 0; j < dim; ++j) {
+                    acc = acc + Q[i * dim + j] * x_in[j];
+                }
+                gradient[i] = acc + b[i];
+                x_out[i] = x_in[i] - step * gradient[i];
+                if (grad_norm) {
+                    double gd = static_cast<double>(gradient[i]);
+                    *grad_norm += gd * gd;
+                }
+            }
+        });
+    return {iterations, converged};
+}
+
+template <typename T>
+GradientDescentResult<T> gradient_descent_quadratic_reference(std::span<const T> Q,
+                                                              std::span<const T> b,
+                                                              std::span<const T> initial,
+                                                              std::size_t dim,
+                                                              const GradientDescentOptions& opts) {
+    GradientDescentResult<T> result;
+    result.x.resize(initial.size());
+    auto status = gradient_descent_quadratic_reference_into(Q, b, initial, dim, std::span<T>(result.x), opts);
+    result.iterations = status.iterations;
+    result.converged = status.converged;
+    return result;
+}
+
+namespace detail {
+
+template <typename T>
+GradientDescentStatus gradient_descent_quadratic_vectorized_into(std::span<const T> Q,
+                                                                 std::span<const T> b,
+                                                                 std::span<const T> initial,
+                                                                 std::size_t dim,
+                                                                 std::span<T> x_out,
+                                                                 const GradientDescentOptions& opts) {
+    constexpr int F = formats::Fp32Emulation<T>::fraction_bits;
+    auto* scratch = scratch_resource(opts.scratch);
+    // Q is fixed for the whole run, so transpose it once for unit-stride lanes.
+    std::pmr::vector<float> Qt(dim * dim, scratch);
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < dim; ++j) {
+            Qt[j * dim + i] = static_cast<float>(Q[i * dim + j]);
+        }
+    }
+    auto bf = to_float_buffer(b, scratch);
+    auto x = to_float_buffer(initial, scratch);
+    // The reference multiplies by T(step_size) each update; convert it the same way.
+    const float step = static_cast<float>(T(opts.step_size));
+    bool converged = false;
+    std::size_t iterations = run_gradient_rows(
+        std::span<float>(x), dim, opts, converged,
+        [&](std::size_t lo, std::size_t hi, const float* x_in, float* x_out, float* gradient, double* grad_norm) {
+            emulated_gradient_rows<F>(Qt.data(), bf.data(), x_in, x_out, gradient, dim, lo, hi, step, grad_norm);
+        });
+    from_float_buffer<T>(x, x_out);
+    return {iterations, converged};
+}
+
+} // namespace detail
+
+// Runs from `initial` and writes the final iterate to the caller's buffer x
+// (dim entries).
+template <typename T>
+GradientDescentStatus gradient_descent_quadratic_into(std::span<const T> Q,
+                                                      std::span<const T> b,
+                                                      std::span<const T> initial,
+                                                      std::size_t dim,
+                                                      std::span<T> x,
+                                                      const GradientDescentOptions& opts) {
+    if (initial.size() != dim || x.size() != dim) {
+        throw std::runtime_error("gradient_descent_quadratic: initial point and output must hold dim entries");
+    }
+    if constexpr (formats::Fp32Emulation<T>::enabled) {
+        if (opts.backend == Backend::Vectorized && formats::fp32_emulation_verified<T>()) {
+            return detail::gradient_descent_quadratic_vectorized_into(Q, b, initial, dim, x, opts);
+        }
+    }
+    return gradient_descent_quadratic_reference_into(Q, b, initial, dim, x, opts);
+}
+
+template <typename T>
+GradientDescentResult<T> gradient_descent_quadratic(std::span<const T> Q,
+                                                    std::span<const T> b,
+                                                    std::span<const T> initial,
+                                                    std::size_t dim,
+                                                    const GradientDescentOptions& opts) {
+    GradientDescentResult<T> result;
+    result.x.resize(dim);
+    auto status = gradient_descent_quadratic_into(Q, b, initial, dim, std::span<T>(result.x), opts);
+    result.iterations = status.iterations;
+    result.converged = status.converged;
+    return result;
+}
+
+template <typename T>
+GradientDescentResult<T> gradient_descent_quadratic(const std::vector<T>& Q,
+                                                    const std::vector<T>& b,
+                                                    const std::vector<T>& initial,
+                                                    std::size_t dim,
+                                                    const GradientDescentOptions& opts) {
+    return gradient_descent_quadratic(std::span<const T>(Q), std::span<const T>(b),
+                                      std::span<const T>(initial), dim, opts);
 }
 
 } // namespace fpstudy::algorithms
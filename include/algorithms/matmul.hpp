@@ -1,22 +1,42 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <thread>
 #include <type_traits>
 
+#include "algorithms/backend.hpp"
+#include "algorithms/fixed.hpp"
+#include "algorithms/vectorized.hpp"
+
 namespace fpstudy::algorithms {
 
 struct MatMulOptions {
     bool use_kahan = false;
     bool accumulate_in_fp32 = false;
+    Backend backend = Backend::Reference;
+    // Resource for the kernel's temporaries; null uses the default heap.
+    std::pmr::memory_resource* scratch = nullptr;
+    // Split-K: above 1, k is cut into this many contiguous slices whose
+    // partial sums are combined by a pairwise tree (see
+    // matmul_square_split_k_into). This changes the summation order, and so
+    // the result, identically for every backend.
+    std::size_t split_k = 1;
+    // Threads for the split-K slices (0 = all cores). Results do not depend
+    // on it.
+    std::size_t threads = 1;
 };
 
 template <typename T>
-std::vector<T> matmul_square(const std::vector<T>& A,
-                             const std::vector<T>& B,
-                             std::size_t n,
-                             MatMulOptions opts = {}) {
-    std::vector<T> C(n * n, T{});
+void matmul_square_reference_into(std::span<const T> A,
+                                  std::span<const T> B,
+                                  std::size_t n,
+                                  std::span<T> C,
+                                  MatMulOptions opts = {}) {
     for (std::size_t i = 0; i < n; ++i) {
         for (std::size_t j = 0; j < n; ++j) {
             if (opts.accumulate_in_fp32) {
@@ -52,8 +72,414 @@ std::vector<T> matmul_square(const std::vector<T>& A,
             }
         }
     }
+}
+
+template <typename T>
+std::vector<T> matmul_square_reference(std::span<const T> A,
+                                       std::span<const T> B,
+                                       std::size_t n,
+                                       MatMulOptions opts = {}) {
+    std::vector<T> C(n * n, T{});
+    matmul_square_reference_into(A, B, n, std::span<T>(C), opts);
     return C;
 }
 
-} // namespace fpstudy::algorithms
+namespace detail {
+
+// Blocking parameters for the packed-panel engine. A kc x nc panel of B and
+// an mc x kc panel of A are copied into contiguous slivers of NR columns / MR
+// rows, and the micro-kernel keeps an MR x NR tile of accumulators local.
+struct MatMulBlocking {
+    static constexpr std::size_t mr = 4;
+    static constexpr std::size_t nr = 8;
+    static constexpr std::size_t mc = 64;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 512;
+};
+
+// Packs rows [row0, row0 + rows) x cols [col0, col0 + depth) of A into MR-row
+// slivers laid out k-major. Rows past the edge are padded with zeros; they
+// only feed accumulator lanes that are never stored.
+template <typename Elem, typename T>
+void pack_a_panel(std::span<const T> A, std::size_t n,
+                  std::size_t row0, std::size_t rows,
+                  std::size_t col0, std::size_t depth,
+                  std::pmr::vector<Elem>& packed) {
+    constexpr std::size_t MR = MatMulBlocking::mr;
+    const std::size_t slivers = (rows + MR - 1) / MR;
+    packed.assign(slivers * depth * MR, Elem{});
+    for (std::size_t s = 0; s < slivers; ++s) {
+        Elem* dst = packed.data() + s * depth * MR;
+        const std::size_t height = std::min(MR, rows - s * MR);
+        for (std::size_t k = 0; k < depth; ++k) {
+            for (std::size_t ii = 0; ii < height; ++ii) {
+                dst[k * MR + ii] = static_cast<Elem>(A[(row0 + s * MR + ii) * n + col0 + k]);
+            }
+        }
+    }
+}
+
+// Packs rows [row0, row0 + depth) x cols [col0, col0 + cols) of B into
+// NR-column slivers laid out k-major, turning the stride-n walk down a column
+// into unit-stride reads.
+template <typename Elem, typename T>
+void pack_b_panel(std::span<const T> B, std::size_t n,
+                  std::size_t row0, std::size_t depth,
+                  std::size_t col0, std::size_t cols,
+                  std::pmr::vector<Elem>& packed) {
+    constexpr std::size_t NR = MatMulBlocking::nr;
+    const std::size_t slivers = (cols + NR - 1) / NR;
+    packed.assign(slivers * depth * NR, Elem{});
+    for (std::size_t s = 0; s < slivers; ++s) {
+        Elem* dst = packed.data() + s * depth * NR;
+        const std::size_t width = std::min(NR, cols - s * NR);
+        for (std::size_t k = 0; k < depth; ++k) {
+            const T* src = B.data() + (row0 + k) * n + col0 + s * NR;
+            for (std::size_t jj = 0; jj < width; ++jj) {
+                dst[k * NR + jj] = static_cast<Elem>(src[jj]);
+            }
+        }
+    }
+}
+
+// Updates an MR x NR tile of running sums with `depth` more products, in
+// ascending k, using exactly the statements of the reference loop.
+template <typename Elem, bool Kahan>
+void matmul_micro_kernel(std::size_t depth,
+                         const Elem* a, const Elem* b,
+                         Elem* sums, Elem* comps, std::size_t ld,
+                         std::size_t height, std::size_t width) {
+    constexpr std::size_t MR = MatMulBlocking::mr;
+    constexpr std::size_t NR = MatMulBlocking::nr;
+    Elem sum[MR][NR];
+    Elem compensation[MR][NR];
+    for (std::size_t ii = 0; ii < MR; ++ii) {
+        for (std::size_t jj = 0; jj < NR; ++jj) {
+            const bool live = ii < height && jj < width;
+            sum[ii][jj] = live ? sums[ii * ld + jj] : Elem{};
+            if constexpr (Kahan) {
+                compensation[ii][jj] = live ? comps[ii * ld + jj] : Elem{};
+            }
+        }
+    }
+    for (std::size_t k = 0; k < depth; ++k) {
+        const Elem* ak = a + k * MR;
+        const Elem* bk = b + k * NR;
+        for (std::size_t ii = 0; ii < MR; ++ii) {
+            for (std::size_t jj = 0; jj < NR; ++jj) {
+                Elem prod = ak[ii] * bk[jj];
+                if constexpr (Kahan) {
+                    Elem y = prod - compensation[ii][jj];
+                    Elem t = sum[ii][jj] + y;
+                    compensation[ii][jj] = (t - sum[ii][jj]) - y;
+                    sum[ii][jj] = t;
+                } else {
+                    sum[ii][jj] = sum[ii][jj] + prod;
+                }
+            }
+        }
+    }
+    for (std::size_t ii = 0; ii < height; ++ii) {
+        for (std::size_t jj = 0; jj < width; ++jj) {
+            sums[ii * ld + jj] = sum[ii][jj];
+            if constexpr (Kahan) {
+                comps[ii * ld + jj] = compensation[ii][jj];
+            }
+        }
+    }
+}
+
+// Packed-panel GEMM over running-sum buffers of type Elem, adding the
+// products of k in [k_begin, k_end). The k panels are visited in ascending
+// order for every output, so each C[i, j] sees the same sequence of
+// operations as the reference i-j-k loop over that range.
+template <typename Elem, bool Kahan, typename T>
+void matmul_blocked_accumulate(std::span<const T> A,
+                               std::span<const T> B,
+                               std::size_t n,
+                               std::size_t k_begin,
+                               std::size_t k_end,
+                               Elem* sums,
+                               Elem* comps,
+                               std::pmr::memory_resource* scratch) {
+    using Blk = MatMulBlocking;
+    std::pmr::vector<Elem> a_panel(scratch);
+    std::pmr::vector<Elem> b_panel(scratch);
+    for (std::size_t jc = 0; jc < n; jc += Blk::nc) {
+        const std::size_t cols = std::min(Blk::nc, n - jc);
+        for (std::size_t pc = k_begin; pc < k_end; pc += Blk::kc) {
+            const std::size_t depth = std::min(Blk::kc, k_end - pc);
+            pack_b_panel<Elem>(B, n, pc, depth, jc, cols, b_panel);
+            for (std::size_t ic = 0; ic < n; ic += Blk::mc) {
+                const std::size_t rows = std::min(Blk::mc, n - ic);
+                pack_a_panel<Elem>(A, n, ic, rows, pc, depth, a_panel);
+                for (std::size_t jr = 0; jr < cols; jr += Blk::nr) {
+                    const Elem* b = b_panel.data() + (jr / Blk::nr) * depth * Blk::nr;
+                    for (std::size_t ir = 0; ir < rows; ir += Blk::mr) {
+                        const Elem* a = a_panel.data() + (ir / Blk::mr) * depth * Blk::mr;
+                        const std::size_t offset = (ic + ir) * n + jc + jr;
+                        matmul_micro_kernel<Elem, Kahan>(
+                            depth, a, b,
+                            sums + offset,
+                            Kahan ? comps + offset : nullptr,
+                            n,
+                            std::min(Blk::mr, rows - ir),
+                            std::min(Blk::nr, cols - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void matmul_square_blocked_into(std::span<const T> A,
+                                std::span<const T> B,
+                                std::size_t n,
+                                std::span<T> C,
+                                MatMulOptions opts) {
+    auto* scratch = scratch_resource(opts.scratch);
+    if (opts.accumulate_in_fp32) {
+        // Panels hold the float conversions, so each element is converted
+        // once per panel instead of once per multiply.
+        std::pmr::vector<float> sums(n * n, 0.0f, scratch);
+        std::pmr::vector<float> comps(opts.use_kahan ? n * n : 0, 0.0f, scratch);
+        if (opts.use_kahan) {
+            matmul_blocked_accumulate<float, true>(A, B, n, 0, n, sums.data(), comps.data(), scratch);
+        } else {
+            matmul_blocked_accumulate<float, false>(A, B, n, 0, n, sums.data(), comps.data(), scratch);
+        }
+        for (std::size_t i = 0; i < n * n; ++i) {
+            C[i] = T(sums[i]);
+        }
+        return;
+    }
+    std::fill(C.begin(), C.end(), T{});
+    std::pmr::vector<T> comps(opts.use_kahan ? n * n : 0, T{}, scratch);
+    if (opts.use_kahan) {
+        matmul_blocked_accumulate<T, true>(A, B, n, 0, n, C.data(), comps.data(), scratch);
+    } else {
+        matmul_blocked_accumulate<T, false>(A, B, n, 0, n, C.data(), comps.data(), scratch);
+    }
+}
+
+inline std::size_t split_k_slices(std::size_t requested, std::size_t n) {
+    return std::max<std::size_t>(1, std::min(requested, n));
+}
+
+// Partial sums of every split-K slice, each from the blocked engine over its
+// k range with its own Kahan compensation, then reduced in place by a
+// pairwise tree: at stride 1, 2, 4, ... partial s absorbs partial s + stride.
+// The result, in slice 0 of `partials`, is
+// ((P0 + P1) + (P2 + P3)) + ... for every thread count. Helper threads take
+// their panels from the default heap, since scratch need not be thread-safe.
+template <typename Elem, bool Kahan, typename T>
+void matmul_split_k_accumulate(std::span<const T> A,
+                               std::span<const T> B,
+                               std::size_t n,
+                               std::size_t slices,
+                               std::size_t threads,
+                               std::span<Elem> partials,
+                               std::pmr::memory_resource* scratch) {
+    const std::size_t nn = n * n;
+    std::pmr::vector<Elem> comps(Kahan ? slices * nn : 0, Elem{}, scratch);
+    auto work = [&](std::size_t t, std::pmr::memory_resource* resource) {
+        for (std::size_t s = t; s < slices; s += threads) {
+            matmul_blocked_accumulate<Elem, Kahan>(A, B, n, n * s / slices, n * (s + 1) / slices,
+                                                   partials.data() + s * nn,
+                                                   Kahan ? comps.data() + s * nn : nullptr, resource);
+        }
+    };
+    {
+        std::vector<std::jthread> helpers;
+        for (std::size_t t = 1; t < threads; ++t) {
+            helpers.emplace_back(work, t, std::pmr::new_delete_resource());
+        }
+        work(0, scratch);
+    }
+    for (std::size_t stride = 1; stride < slices; stride *= 2) {
+        for (std::size_t s = 0; s + stride < slices; s += 2 * stride) {
+            Elem* lhs = partials.data() + s * nn;
+            const Elem* rhs = partials.data() + (s + stride) * nn;
+            for (std::size_t i = 0; i < nn; ++i) {
+                lhs[i] = lhs[i] + rhs[i];
+            }
+        }
+    }
+}
+
+// Emulated-lane GEMM on FP32 images of the operands; writes the FP32
+// accumulators, before the final conversion to T, into c.
+template <typename T>
+void matmul_square_emulated(const float* a,
+                            const float* b,
+                            std::size_t n,
+                            float* c,
+                            MatMulOptions opts) {
+    constexpr int F = formats::Fp32Emulation<T>::fraction_bits;
+    if (opts.accumulate_in_fp32) {
+        if (opts.use_kahan) {
+            emulated_matmul_kernel<23, true>(a, b, n, c);
+        } else {
+            emulated_matmul_kernel<23, false>(a, b, n, c);
+        }
+    } else if (opts.use_kahan) {
+        emulated_matmul_kernel<F, true>(a, b, n, c);
+    } else {
+        emulated_matmul_kernel<F, false>(a, b, n, c);
+    }
+}
+
+template <typename T>
+void matmul_square_vectorized_into(std::span<const T> A,
+                                   std::span<const T> B,
+                                   std::size_t n,
+                                   std::span<T> C,
+                                   MatMulOptions opts) {
+    auto* scratch = scratch_resource(opts.scratch);
+    auto a = to_float_buffer(A, scratch);
+    auto b = to_float_buffer(B, scratch);
+    std::pmr::vector<float> c(n * n, 0.0f, scratch);
+    matmul_square_emulated<T>(a.data(), b.data(), n, c.data(), opts);
+    for (std::size_t i = 0; i < n * n; ++i) {
+        C[i] = T(c[i]);
+    }
+}
+
+} // namespace detail
+
+// Split-K GEMM, the reduction order of tensor-core style hardware: k is cut
+// into opts.split_k contiguous slices of near-equal length, slice s covering
+// [n s / split_k, n (s + 1) / split_k). Each slice runs the blocked engine
+// with its own running sums, in FP32 under accumulate_in_fp32 (as tensor
+// cores keep TF32/BF16 partials) and in T otherwise, and the slice partials
+// are combined by a pairwise tree before the single conversion to T. Slices
+// run on up to opts.threads threads, so the dependency chain per output is
+// about n / split_k + log2(split_k) long. Every backend gives this result.
+template <typename T>
+void matmul_square_split_k_into(std::span<const T> A,
+                                std::span<const T> B,
+                                std::size_t n,
+                                std::span<T> C,
+                                MatMulOptions opts = {}) {
+    const std::size_t slices = detail::split_k_slices(opts.split_k, n);
+    std::size_t threads = opts.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : opts.threads;
+    threads = std::min(threads, slices);
+    auto* scratch = scratch_resource(opts.scratch);
+    auto run = [&]<typename Elem>(std::pmr::vector<Elem>& partials) {
+        if (opts.use_kahan) {
+            detail::matmul_split_k_accumulate<Elem, true>(A, B, n, slices, threads, std::span<Elem>(partials), scratch);
+        } else {
+            detail::matmul_split_k_accumulate<Elem, false>(A, B, n, slices, threads, std::span<Elem>(partials), scratch);
+        }
+    };
+    if (opts.accumulate_in_fp32) {
+        std::pmr::vector<float> partials(slices * n * n, 0.0f, scratch);
+        run(partials);
+        for (std::size_t i = 0; i < n * n; ++i) {
+            C[i] = T(partials[i]);
+        }
+    } else {
+        std::pmr::vector<T> partials(slices * n * n, T{}, scratch);
+        run(partials);
+        std::copy(partials.begin(), partials.begin() + static_cast<std::ptrdiff_t>(n * n), C.begin());
+    }
+}
+
+// Writes A * B into the caller's n x n buffer C.
+template <typename T>
+void matmul_square_into(std::span<const T> A,
+                        std::span<const T> B,
+                        std::size_t n,
+                        std::span<T> C,
+                        MatMulOptions opts = {}) {
+    if (opts.split_k > 1) {
+        matmul_square_split_k_into(A, B, n, C, opts);
+        return;
+    }
+    switch (opts.backend) {
+        case Backend::Vectorized:
+            if constexpr (formats::Fp32Emulation<T>::enabled) {
+                if (formats::fp32_emulation_verified<T>()) {
+                    detail::matmul_square_vectorized_into(A, B, n, C, opts);
+                    return;
+                }
+            }
+            detail::matmul_square_blocked_into(A, B, n, C, opts);
+            return;
+        case Backend::Blocked:
+            detail::matmul_square_blocked_into(A, B, n, C, opts);
+            return;
+        case Backend::Fixed:
+            if (matmul_square_fixed_dispatch(A.data(), B.data(), n, C.data(), opts.use_kahan,
+                                             opts.accumulate_in_fp32)) {
+                return;
+            }
+            break;
+        case Backend::Reference:
+            break;
+    }
+    matmul_square_reference_into(A, B, n, C, opts);
+}
 
+template <typename T>
+std::vector<T> matmul_square(std::span<const T> A,
+                             std::span<const T> B,
+                             std::size_t n,
+                             MatMulOptions opts = {}) {
+    std::vector<T> C(n * n, T{});
+    matmul_square_into(A, B, n, std::span<T>(C), opts);
+    return C;
+}
+
+template <typename T>
+std::vector<T> matmul_square(const std::vector<T>& A,
+                             const std::vector<T>& B,
+                             std::size_t n,
+                             MatMulOptions opts = {}) {
+    return matmul_square(std::span<const T>(A), std::span<const T>(B), n, opts);
+}
+
+// `batch` independent products over stacked operands: element e of A, B and
+// the result occupies [e * n * n, (e + 1) * n * n). All elements run back to
+// back in one call into one output buffer, which for small n keeps the
+// working set in cache and removes per-trial setup. Each element is
+// bit-identical to matmul_square on that element alone.
+template <typename T>
+void matmul_batched_into(std::span<const T> A,
+                         std::span<const T> B,
+                         std::size_t n,
+                         std::size_t batch,
+                         std::span<T> C,
+                         MatMulOptions opts = {}) {
+    const std::size_t stride = n * n;
+    if (A.size() != batch * stride || B.size() != batch * stride || C.size() != batch * stride) {
+        throw std::runtime_error("matmul_batched: operands must hold batch * n * n elements");
+    }
+    for (std::size_t e = 0; e < batch; ++e) {
+        matmul_square_into(A.subspan(e * stride, stride), B.subspan(e * stride, stride), n,
+                           C.subspan(e * stride, stride), opts);
+    }
+}
+
+template <typename T>
+std::vector<T> matmul_batched(std::span<const T> A,
+                              std::span<const T> B,
+                              std::size_t n,
+                              std::size_t batch,
+                              MatMulOptions opts = {}) {
+    std::vector<T> C(batch * n * n, T{});
+    matmul_batched_into(A, B, n, batch, std::span<T>(C), opts);
+    return C;
+}
+
+template <typename T>
+std::vector<T> matmul_batched(const std::vector<T>& A,
+                              const std::vector<T>& B,
+                              std::size_t n,
+                              std::size_t batch,
+                              MatMulOptions opts = {}) {
+    return matmul_batched(std::span<const T>(A), std::span<const T>(B), n, batch, opts);
+}
+
+} // namespace fpstudy::algorithms
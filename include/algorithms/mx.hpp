@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "algorithms/fir.hpp"
+#include "algorithms/matmul.hpp"
+#include "formats/mx.hpp"
+
+// Kernels on block-scaled MX operands (formats/mx.hpp). Element codes are
+// decoded once to unscaled FP32 values; each pair of overlapping blocks is
+// reduced in FP32 without its scales, and the result is multiplied by the
+// two block scales once, exactly, before joining an FP32 running sum (with
+// Kahan compensation when opts.use_kahan). This is the dot-product model of
+// MX hardware, and it needs one ldexp per block pair instead of one scale
+// multiply per element. Outputs are FP32. accumulate_in_fp32 and backend do
+// not apply: MX always accumulates in FP32 on its own loop.
+//
+// The _into forms write to a caller buffer of the result's length and take
+// their temporaries from opts.scratch.
+
+namespace fpstudy::algorithms {
+
+namespace detail {
+
+// Sum of a[k] * b[k] over one block pair in eight lanes, combined pairwise,
+// so the order is fixed and the loop vectorizes.
+inline float mx_block_dot(const float* a, const float* b, std::size_t len) {
+    float lane[8] = {};
+    std::size_t k = 0;
+    for (; k + 8 <= len; k += 8) {
+        for (std::size_t l = 0; l < 8; ++l) {
+            lane[l] += a[k + l] * b[k + l];
+        }
+    }
+    for (std::size_t l = 0; k + l < len; ++l) {
+        lane[l] += a[k + l] * b[k + l];
+    }
+    return ((lane[0] + lane[4]) + (lane[1] + lane[5])) + ((lane[2] + lane[6]) + (lane[3] + lane[7]));
+}
+
+inline void mx_accumulate(float& sum, float& compensation, float term, bool use_kahan) {
+    if (use_kahan) {
+        float y = term - compensation;
+        float t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    } else {
+        sum += term;
+    }
+}
+
+// C = A B for the n x n matrices stored in rows [first_row, first_row + n)
+// of A and of Bt (B transposed), with unscaled element images a and b.
+inline void matmul_mx_rows(const formats::MxVector& A, const float* a,
+                           const formats::MxVector& Bt, const float* b,
+                           std::size_t n, std::size_t first_row, float* C, bool use_kahan) {
+    const std::size_t blocks = A.blocks_per_row();
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t row_a = first_row + i;
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::size_t row_b = first_row + j;
+            float sum = 0.0f;
+            float compensation = 0.0f;
+            for (std::size_t kb = 0; kb < blocks; ++kb) {
+                const std::size_t begin = kb * formats::kMxBlockSize;
+                const std::size_t len = std::min(formats::kMxBlockSize, n - begin);
+                const float dot = mx_block_dot(a + row_a * n + begin, b + row_b * n + begin, len);
+                const int exponent = A.scale_exponent(row_a * blocks + kb) + Bt.scale_exponent(row_b * blocks + kb);
+                mx_accumulate(sum, compensation, std::ldexp(dot, exponent), use_kahan);
+            }
+            C[i * n + j] = sum;
+        }
+    }
+}
+
+inline void check_mx_matmul_operands(const formats::MxVector& A, const formats::MxVector& Bt, std::size_t n,
+                                     std::size_t batch, std::size_t c_size) {
+    const std::size_t elements = batch * n * n;
+    if (A.size() != elements || Bt.size() != elements || c_size != elements || A.row_length() != n ||
+        Bt.row_length() != n) {
+        throw std::runtime_error("matmul_mx: operands must hold batch * n * n elements in rows of n");
+    }
+}
+
+} // namespace detail
+
+// C = A B where A holds the n x n matrix in MX rows of n and Bt holds B
+// transposed the same way, so both operands are blocked along k. The
+// element layouts of A and Bt may differ.
+inline void matmul_square_mx_into(const formats::MxVector& A,
+                                  const formats::MxVector& Bt,
+                                  std::size_t n,
+                                  std::span<float> C,
+                                  MatMulOptions opts = {}) {
+    detail::check_mx_matmul_operands(A, Bt, n, 1, C.size());
+    auto* scratch = scratch_resource(opts.scratch);
+    std::pmr::vector<float> a(A.size(), scratch);
+    std::pmr::vector<float> b(Bt.size(), scratch);
+    A.decode_elements(a);
+    Bt.decode_elements(b);
+    detail::matmul_mx_rows(A, a.data(), Bt, b.data(), n, 0, C.data(), opts.use_kahan);
+}
+
+inline std::vector<float> matmul_square_mx(const formats::MxVector& A,
+                                           const formats::MxVector& Bt,
+                                           std::size_t n,
+                                           MatMulOptions opts = {}) {
+    std::vector<float> C(n * n);
+    matmul_square_mx_into(A, Bt, n, C, opts);
+    return C;
+}
+
+// `batch` independent products: element e is rows [e n, (e + 1) n) of A and
+// of Bt, written to C + e n n.
+inline void matmul_batched_mx_into(const formats::MxVector& A,
+                                   const formats::MxVector& Bt,
+                                   std::size_t n,
+                                   std::size_t batch,
+                                   std::span<float> C,
+                                   MatMulOptions opts = {}) {
+    detail::check_mx_matmul_operands(A, Bt, n, batch, C.size());
+    auto* scratch = scratch_resource(opts.scratch);
+    std::pmr::vector<float> a(A.size(), scratch);
+    std::pmr::vector<float> b(Bt.size(), scratch);
+    A.decode_elements(a);
+    Bt.decode_elements(b);
+    for (std::size_t e = 0; e < batch; ++e) {
+        detail::matmul_mx_rows(A, a.data(), Bt, b.data(), n, e * n, C.data() + e * n * n, opts.use_kahan);
+    }
+}
+
+// y[n] = sum over k of h[k] x[n - k] (zero before the first sample) for taps
+// h and signal x each stored as one MX row. The window of every output is
+// split where a tap block or a signal block ends, so each segment has one
+// pair of scales.
+inline void fir_filter_mx_into(const formats::MxVector& h,
+                               const formats::MxVector& x,
+                               std::span<float> y,
+                               FIROptions opts = {}) {
+    const std::size_t M = h.size();
+    const std::size_t N = x.size();
+    if (y.size() != N) {
+        throw std::runtime_error("fir_filter: output must hold one sample per input sample");
+    }
+    if ((M != 0 && h.rows() != 1) || (N != 0 && x.rows() != 1)) {
+        throw std::runtime_error("fir_filter_mx: taps and signal must each be a single MX row");
+    }
+    constexpr std::size_t B = formats::kMxBlockSize;
+    auto* scratch = scratch_resource(opts.scratch);
+    // Taps reversed, so both operands of a segment run forward.
+    std::pmr::vector<float> hr(M, scratch);
+    std::pmr::vector<float> xf(N, scratch);
+    h.decode_elements(hr);
+    std::reverse(hr.begin(), hr.end());
+    x.decode_elements(xf);
+    for (std::size_t n = 0; n < N; ++n) {
+        float sum = 0.0f;
+        float compensation = 0.0f;
+        // Reversed tap j is h[M - 1 - j] and meets x[n - M + 1 + j].
+        std::size_t j = n + 1 >= M ? 0 : M - 1 - n;
+        while (j < M) {
+            const std::size_t k = M - 1 - j;
+            const std::size_t xi = n - k;
+            const std::size_t tap_block = k / B;
+            const std::size_t signal_block = xi / B;
+            const std::size_t end = std::min({M, M - tap_block * B, j + (signal_block + 1) * B - xi});
+            const float dot = detail::mx_block_dot(hr.data() + j, xf.data() + xi, end - j);
+            const int exponent = h.scale_exponent(tap_block) + x.scale_exponent(signal_block);
+            detail::mx_accumulate(sum, compensation, std::ldexp(dot, exponent), opts.use_kahan);
+            j = end;
+        }
+        y[n] = sum;
+    }
+}
+
+inline std::vector<float> fir_filter_mx(const formats::MxVector& h,
+                                        const formats::MxVector& x,
+                                        FIROptions opts = {}) {
+    std::vector<float> y(x.size());
+    fir_filter_mx_into(h, x, y, opts);
+    return y;
+}
+
+} // namespace fpstudy::algorithms
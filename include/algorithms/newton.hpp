@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 namespace fpstudy::algorithms {
 
@@ -38,5 +43,96 @@ NewtonResult<T> newton_raphson(T initial,
     return {x, opts.max_iters, false};
 }
 
+template <typename T>
+struct NewtonBatchResult {
+    std::vector<T> roots;
+    std::vector<std::size_t> iterations;
+    std::vector<uint8_t> converged;
+};
+
+// Lanes iterated together by newton_raphson_batch.
+inline constexpr std::size_t kNewtonLanes = 64;
+
+// Runs newton_raphson from every initial point. Points are processed in
+// blocks of kNewtonLanes; each iteration evaluates f and df across the whole
+// block and applies the update under a per-lane activity mask, with selects
+// instead of branches, so the loop vectorizes for float and double. A lane
+// retires at the iteration where the scalar loop would return (|f| < tol
+// converges, a zero derivative stops) and keeps its root and iteration count
+// from then on. Every lane performs the scalar operation sequence, so roots,
+// iteration counts and convergence flags match newton_raphson exactly.
+//
+// The _into form writes lane i's results to roots[i], iterations[i] and
+// converged[i] of the caller's buffers, each holding initials.size() entries.
+template <typename T, typename Func, typename Deriv>
+void newton_raphson_batch_into(std::span<const T> initials,
+                               Func f,
+                               Deriv df,
+                               std::span<T> roots,
+                               std::span<std::size_t> iteration_counts,
+                               std::span<uint8_t> converged_flags,
+                               const NewtonOptions& opts) {
+    const std::size_t count = initials.size();
+    if (roots.size() != count || iteration_counts.size() != count || converged_flags.size() != count) {
+        throw std::runtime_error("newton_raphson_batch: outputs must hold one entry per initial point");
+    }
+    std::copy(initials.begin(), initials.end(), roots.begin());
+    std::fill(iteration_counts.begin(), iteration_counts.end(), opts.max_iters);
+    std::fill(converged_flags.begin(), converged_flags.end(), uint8_t{0});
+    T fx[kNewtonLanes];
+    T dfx[kNewtonLanes];
+    uint8_t active[kNewtonLanes];
+    for (std::size_t base = 0; base < count; base += kNewtonLanes) {
+        const std::size_t lanes = std::min(kNewtonLanes, count - base);
+        T* x = roots.data() + base;
+        std::size_t* iterations = iteration_counts.data() + base;
+        uint8_t* converged = converged_flags.data() + base;
+        std::fill(active, active + lanes, uint8_t{1});
+        std::size_t remaining = lanes;
+        for (std::size_t iter = 0; iter < opts.max_iters && remaining > 0; ++iter) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                fx[l] = f(x[l]);
+                dfx[l] = df(x[l]);
+            }
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const bool small = std::fabs(static_cast<double>(fx[l])) < opts.tol;
+                const bool flat = static_cast<double>(dfx[l]) == 0.0;
+                const bool stop = active[l] && (small || flat);
+                const bool step = active[l] && !stop;
+                converged[l] = static_cast<uint8_t>(converged[l] | (stop && small));
+                iterations[l] = stop ? iter : iterations[l];
+                // Retired lanes divide by one and keep x.
+                const T update = x[l] - fx[l] / (step ? dfx[l] : T(1));
+                x[l] = step ? update : x[l];
+                active[l] = static_cast<uint8_t>(step);
+                remaining -= stop;
+            }
+        }
+    }
+}
+
+template <typename T, typename Func, typename Deriv>
+NewtonBatchResult<T> newton_raphson_batch(std::span<const T> initials,
+                                          Func f,
+                                          Deriv df,
+                                          const NewtonOptions& opts) {
+    const std::size_t count = initials.size();
+    NewtonBatchResult<T> result;
+    result.roots.resize(count);
+    result.iterations.resize(count);
+    result.converged.resize(count);
+    newton_raphson_batch_into(initials, f, df, std::span<T>(result.roots),
+                              std::span<std::size_t>(result.iterations), std::span<uint8_t>(result.converged), opts);
+    return result;
+}
+
+template <typename T, typename Func, typename Deriv>
+NewtonBatchResult<T> newton_raphson_batch(const std::vector<T>& initials,
+                                          Func f,
+                                          Deriv df,
+                                          const NewtonOptions& opts) {
+    return newton_raphson_batch(std::span<const T>(initials), f, df, opts);
+}
+
 } // namespace fpstudy::algorithms
 
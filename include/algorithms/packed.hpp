@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "algorithms/fir.hpp"
+#include "algorithms/matmul.hpp"
+#include "formats/packed.hpp"
+
+// Entry points on PackedVector operands. Formats whose code is the value type
+// (FP64, FP32, P3109_8) run the span kernels on the packed storage directly.
+// TF32/BF16 decode their codes to FP32 with a shift for the vectorized
+// backend and repack the FP32 results, so no cfloat objects are built; the
+// other backends materialize T values first. Results are bit-identical to
+// the std::vector overloads.
+//
+// The _into forms write result codes to a caller buffer of the result's
+// length and take their temporaries from opts.scratch. Split-K products
+// (opts.split_k > 1) always go through the T kernels.
+
+namespace fpstudy::algorithms {
+
+template <formats::Precision P>
+void matmul_square_into(const formats::PackedVector<P>& A,
+                        const formats::PackedVector<P>& B,
+                        std::size_t n,
+                        std::span<typename formats::PackedVector<P>::code_type> C,
+                        MatMulOptions opts = {}) {
+    using T = typename formats::PackedVector<P>::value_type;
+    if constexpr (formats::PackedVector<P>::has_value_view) {
+        matmul_square_into<T>(A.values(), B.values(), n, C, opts);
+    } else {
+        auto* scratch = scratch_resource(opts.scratch);
+        if (opts.backend == Backend::Vectorized && opts.split_k <= 1 && formats::fp32_emulation_verified<T>()) {
+            std::pmr::vector<float> a(A.size(), scratch);
+            std::pmr::vector<float> b(B.size(), scratch);
+            A.decode_float(a);
+            B.decode_float(b);
+            std::pmr::vector<float> c(n * n, 0.0f, scratch);
+            detail::matmul_square_emulated<T>(a.data(), b.data(), n, c.data(), opts);
+            formats::pack_floats<P>(c, C);
+        } else {
+            std::pmr::vector<T> a(A.size(), scratch);
+            std::pmr::vector<T> b(B.size(), scratch);
+            std::pmr::vector<T> c(n * n, T{}, scratch);
+            formats::decode_codes_values<P>(A.codes(), a);
+            formats::decode_codes_values<P>(B.codes(), b);
+            matmul_square_into<T>(a, b, n, c, opts);
+            formats::pack_values<P>(c, C);
+        }
+    }
+}
+
+template <formats::Precision P>
+formats::PackedVector<P> matmul_square(const formats::PackedVector<P>& A,
+                                       const formats::PackedVector<P>& B,
+                                       std::size_t n,
+                                       MatMulOptions opts = {}) {
+    formats::PackedVector<P> C(n * n);
+    matmul_square_into(A, B, n, C.codes(), opts);
+    return C;
+}
+
+template <formats::Precision P>
+void matmul_batched_into(const formats::PackedVector<P>& A,
+                         const formats::PackedVector<P>& B,
+                         std::size_t n,
+                         std::size_t batch,
+                         std::span<typename formats::PackedVector<P>::code_type> C,
+                         MatMulOptions opts = {}) {
+    using T = typename formats::PackedVector<P>::value_type;
+    if constexpr (formats::PackedVector<P>::has_value_view) {
+        matmul_batched_into<T>(A.values(), B.values(), n, batch, C, opts);
+    } else {
+        const std::size_t stride = n * n;
+        if (A.size() != batch * stride || B.size() != batch * stride || C.size() != batch * stride) {
+            throw std::runtime_error("matmul_batched: operands must hold batch * n * n elements");
+        }
+        auto* scratch = scratch_resource(opts.scratch);
+        if (opts.backend == Backend::Vectorized && opts.split_k <= 1 && formats::fp32_emulation_verified<T>()) {
+            std::pmr::vector<float> a(A.size(), scratch);
+            std::pmr::vector<float> b(B.size(), scratch);
+            std::pmr::vector<float> c(batch * stride, 0.0f, scratch);
+            A.decode_float(a);
+            B.decode_float(b);
+            for (std::size_t e = 0; e < batch; ++e) {
+                detail::matmul_square_emulated<T>(a.data() + e * stride, b.data() + e * stride, n,
+                                                  c.data() + e * stride, opts);
+            }
+            formats::pack_floats<P>(c, C);
+        } else {
+            std::pmr::vector<T> a(A.size(), scratch);
+            std::pmr::vector<T> b(B.size(), scratch);
+            std::pmr::vector<T> c(batch * stride, T{}, scratch);
+            formats::decode_codes_values<P>(A.codes(), a);
+            formats::decode_codes_values<P>(B.codes(), b);
+            matmul_batched_into<T>(a, b, n, batch, c, opts);
+            formats::pack_values<P>(c, C);
+        }
+    }
+}
+
+template <formats::Precision P>
+formats::PackedVector<P> matmul_batched(const formats::PackedVector<P>& A,
+                                        const formats::PackedVector<P>& B,
+                                        std::size_t n,
+                                        std::size_t batch,
+                                        MatMulOptions opts = {}) {
+    formats::PackedVector<P> C(batch * n * n);
+    matmul_batched_into(A, B, n, batch, C.codes(), opts);
+    return C;
+}
+
+template <formats::Precision P>
+void fir_filter_into(const formats::PackedVector<P>& h,
+                     const formats::PackedVector<P>& x,
+                     std::span<typename formats::PackedVector<P>::code_type> y,
+                     FIROptions opts = {}) {
+    using T = typename formats::PackedVector<P>::value_type;
+    if constexpr (formats::PackedVector<P>::has_value_view) {
+        fir_filter_into<T>(h.values(), x.values(), y, opts);
+    } else {
+        if (y.size() != x.size()) {
+            throw std::runtime_error("fir_filter: output must hold one sample per input sample");
+        }
+        auto* scratch = scratch_resource(opts.scratch);
+        if (opts.backend == Backend::Vectorized && formats::fp32_emulation_verified<T>()) {
+            std::pmr::vector<float> hf(h.size(), scratch);
+            std::pmr::vector<float> xf(x.size(), scratch);
+            std::pmr::vector<float> yf(x.size(), scratch);
+            h.decode_float(hf);
+            x.decode_float(xf);
+            detail::fir_filter_emulated<T>(hf.data(), hf.size(), xf.data(), xf.size(), yf.data(), opts);
+            formats::pack_floats<P>(yf, y);
+        } else {
+            std::pmr::vector<T> hv(h.size(), scratch);
+            std::pmr::vector<T> xv(x.size(), scratch);
+            std::pmr::vector<T> yv(x.size(), T{}, scratch);
+            formats::decode_codes_values<P>(h.codes(), hv);
+            formats::decode_codes_values<P>(x.codes(), xv);
+            fir_filter_into<T>(hv, xv, yv, opts);
+            formats::pack_values<P>(yv, y);
+        }
+    }
+}
+
+template <formats::Precision P>
+formats::PackedVector<P> fir_filter(const formats::PackedVector<P>& h,
+                                    const formats::PackedVector<P>& x,
+                                    FIROptions opts = {}) {
+    formats::PackedVector<P> y(x.size());
+    fir_filter_into(h, x, y.codes(), opts);
+    return y;
+}
+
+} // namespace fpstudy::algorithms
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "formats/emulation.hpp"
+
+// Packed-lane kernels behind Backend::Vectorized. Operands are held as FP32
+// values that are exactly representable in the target format, and every
+// operation the reference performs in T is replaced by the same FP32
+// operation followed by round_fraction<F>. Lanes run across independent
+// outputs (columns of C, output samples, gradient rows), so each output still
+// sees the reference's operation sequence and results are bit-identical.
+// F = 23 disables rounding, which covers FP32 accumulation and plain float.
+
+namespace fpstudy::algorithms::detail {
+
+namespace simd = fpstudy::formats::simd;
+
+template <typename T>
+std::pmr::vector<float> to_float_buffer(std::span<const T> values,
+                                        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    std::pmr::vector<float> out(resource);
+    out.reserve(values.size());
+    for (const auto& v : values) {
+        out.push_back(static_cast<float>(v));
+    }
+    return out;
+}
+
+template <typename T>
+void from_float_buffer(std::span<const float> values, std::span<T> out) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        out[i] = T(values[i]);
+    }
+}
+
+// sum = sum + prod, or one Kahan step, with rounding after every operation.
+template <typename Ops, int F, bool Kahan>
+inline void emulated_accumulate(typename Ops::V& sum, typename Ops::V& comp, typename Ops::V prod) {
+    if constexpr (Kahan) {
+        auto y = Ops::template round<F>(Ops::sub(prod, comp));
+        auto t = Ops::template round<F>(Ops::add(sum, y));
+        comp = Ops::template round<F>(Ops::sub(Ops::template round<F>(Ops::sub(t, sum)), y));
+        sum = t;
+    } else {
+        sum = Ops::template round<F>(Ops::add(sum, prod));
+    }
+}
+
+template <typename Ops, int F, bool Kahan>
+inline void emulated_mac(typename Ops::V a, const float* b, float* sums, float* comps) {
+    auto prod = Ops::template round<F>(Ops::mul(a, Ops::load(b)));
+    auto sum = Ops::load(sums);
+    auto comp = Kahan ? Ops::load(comps) : Ops::set1(0.0f);
+    emulated_accumulate<Ops, F, Kahan>(sum, comp, prod);
+    Ops::store(sums, sum);
+    if constexpr (Kahan) {
+        Ops::store(comps, comp);
+    }
+}
+
+// sums[j] (+)= round(a * b[j]) for j in [0, count).
+template <int F, bool Kahan>
+inline void emulated_mac_row(float a, const float* b, float* sums, float* comps, std::size_t count) {
+    using Vec = simd::VecOps;
+    // A bounded remainder, so GCC can see the scalar loop runs fewer than
+    // Vec::width times once this is inlined over a fixed-size tile.
+    const std::size_t vec_end = count - count % Vec::width;
+    const auto av = Vec::set1(a);
+    for (std::size_t j = 0; j < vec_end; j += Vec::width) {
+        emulated_mac<Vec, F, Kahan>(av, b + j, sums + j, comps + j);
+    }
+    for (std::size_t j = vec_end; j < count; ++j) {
+        emulated_mac<simd::ScalarOps, F, Kahan>(a, b + j, sums + j, comps + j);
+    }
+}
+
+// Row-major C = A * B with lanes across a tile of output columns. For each
+// row i the tile's running sums stay in L1 while k advances in order.
+template <int F, bool Kahan>
+void emulated_matmul_kernel(const float* A, const float* B, std::size_t n, float* C) {
+    constexpr std::size_t tile = 256;
+    alignas(64) float sums[tile];
+    alignas(64) float comps[tile];
+    for (std::size_t jc = 0; jc < n; jc += tile) {
+        const std::size_t width = std::min(tile, n - jc);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::fill(sums, sums + width, 0.0f);
+            std::fill(comps, comps + width, 0.0f);
+            for (std::size_t k = 0; k < n; ++k) {
+                emulated_mac_row<F, Kahan>(A[i * n + k], B + k * n + jc, sums, comps, width);
+            }
+            std::copy(sums, sums + width, C + i * n + jc);
+        }
+    }
+}
+
+template <typename Ops, int F, bool Kahan>
+inline void emulated_fir_outputs(const float* h, std::size_t taps, const float* x, float* y) {
+    auto sum = Ops::set1(0.0f);
+    auto comp = Ops::set1(0.0f);
+    for (std::size_t k = 0; k < taps; ++k) {
+        auto prod = Ops::template round<F>(Ops::mul(Ops::set1(h[k]), Ops::load(x - k)));
+        emulated_accumulate<Ops, F, Kahan>(sum, comp, prod);
+    }
+    Ops::store(y, sum);
+}
+
+// y[n] = sum_k h[k] * x[n - k]. The first M - 1 outputs see fewer taps and
+// are computed one at a time; the steady state runs full-width lanes over
+// consecutive outputs with no bounds test inside the tap loop.
+template <int F, bool Kahan>
+void emulated_fir_kernel(const float* h, std::size_t M, const float* x, std::size_t N, float* y) {
+    using Vec = simd::VecOps;
+    const std::size_t prologue = std::min(N, M > 0 ? M - 1 : 0);
+    std::size_t n = 0;
+    for (; n < prologue; ++n) {
+        emulated_fir_outputs<simd::ScalarOps, F, Kahan>(h, n + 1, x + n, y + n);
+    }
+    for (; n + Vec::width <= N; n += Vec::width) {
+        emulated_fir_outputs<Vec, F, Kahan>(h, M, x + n, y + n);
+    }
+    for (; n < N; ++n) {
+        emulated_fir_outputs<simd::ScalarOps, F, Kahan>(h, M, x + n, y + n);
+    }
+}
+
+// One gradient descent step for rows [lo, hi) of 0.5 x^T Q x + b^T x with Q
+// supplied transposed, so a tile of gradient rows is updated with unit-stride
+// lanes for each x[j]. Writes gradient[i] and the stepped x_next[i]; when
+// norm is non-null, adds the squared gradient entries to *norm in row order.
+template <int F>
+void emulated_gradient_rows(const float* Qt,
+                            const float* b,
+                            const float* x,
+                            float* x_next,
+                            float* gradient,
+                            std::size_t dim,
+                            std::size_t lo,
+                            std::size_t hi,
+                            float step,
+                            double* norm) {
+    constexpr std::size_t tile = 256;
+    alignas(64) float acc[tile];
+    for (std::size_t i0 = lo; i0 < hi; i0 += tile) {
+        const std::size_t width = std::min(tile, hi - i0);
+        std::fill(acc, acc + width, 0.0f);
+        for (std::size_t j = 0; j < dim; ++j) {
+            emulated_mac_row<F, false>(x[j], Qt + j * dim + i0, acc, acc, width);
+        }
+        for (std::size_t i = 0; i < width; ++i) {
+            const std::size_t row = i0 + i;
+            const float g = formats::round_fraction<F>(acc[i] + b[row]);
+            gradient[row] = g;
+            x_next[row] = formats::round_fraction<F>(x[row] - formats::round_fraction<F>(step * g));
+            if (norm) {
+                const double gd = static_cast<double>(g);
+                *norm += gd * gd;
+            }
+        }
+    }
+}
+
+} // namespace fpstudy::algorithms::detail
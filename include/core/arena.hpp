@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace fpstudy::core {
+
+// Monotonic arena for the short-lived buffers of one sweep cell: FP32 and
+// format images of the operands, kernel outputs and their FP64 decodings.
+//
+// Allocation bumps a pointer through one block that the arena keeps for its
+// whole life, and deallocation is a no-op; reset() drops everything at once.
+// When a cell needs more than the block, the excess comes from the heap and
+// the next reset() regrows the block to that high-water mark, so after the
+// first few cells of a sweep a worker no longer calls malloc for them.
+class Arena {
+public:
+    static constexpr std::size_t kInitialBytes = std::size_t(1) << 20;
+
+    explicit Arena(std::size_t initial_bytes = kInitialBytes);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*resource_; }
+    void reset();
+
+    std::size_t block_bytes() const { return block_bytes_; }
+
+private:
+    friend class ArenaScope;
+
+    // Heap fallback past the end of the block; remembers how much it handed
+    // out so reset() knows how far the block fell short.
+    class Overflow : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes = 0;
+
+    private:
+        void* do_allocate(std::size_t size, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t size, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    std::unique_ptr<std::byte[]> block_;
+    std::size_t block_bytes_ = 0;
+    Overflow overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    std::size_t depth_ = 0;
+};
+
+// The calling thread's arena.
+Arena& worker_arena();
+
+// Scope of one unit of work on the calling thread's arena. Buffers taken from
+// resource() live until the outermost scope on the thread ends, which resets
+// the arena. Scopes nest because `--jobs 1` runs cell tasks inline inside the
+// trial task that submitted them.
+class ArenaScope {
+public:
+    ArenaScope() : arena_(worker_arena()) { ++arena_.depth_; }
+    ~ArenaScope() {
+        if (--arena_.depth_ == 0) {
+            arena_.reset();
+        }
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    std::pmr::memory_resource* resource() const { return arena_.resource(); }
+
+private:
+    Arena& arena_;
+};
+
+} // namespace fpstudy::core
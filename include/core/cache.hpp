@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fpstudy::core {
+
+// Canonical description of one cached computation. Fields are appended in a
+// fixed order as `name=value;` text, and the file name is the 64-bit FNV-1a
+// hash of that text. The full text is stored in the file and compared on
+// load, so a hash collision is a miss rather than wrong data.
+class CacheKey {
+public:
+    explicit CacheKey(std::string_view kind);
+
+    CacheKey& add_string(std::string_view name, std::string_view value);
+    CacheKey& add_int(std::string_view name, int64_t value);
+    CacheKey& add_number(std::string_view name, double value);
+    CacheKey& add_bool(std::string_view name, bool value);
+
+    const std::string& canonical() const { return canonical_; }
+    uint64_t hash() const;
+    std::string file_name() const;
+
+private:
+    std::string canonical_;
+};
+
+uint64_t fnv1a_64(std::string_view bytes);
+
+// Maps (or, without mmap, reads) a whole file read-only. The buffer is at
+// least 8-byte aligned so arrays can be viewed in place; returns null if the
+// file cannot be read or is empty.
+std::shared_ptr<const void> map_file(const std::filesystem::path& path, std::size_t& size);
+
+// Named FP64 arrays. Records built with put() own their data; records
+// returned by TruthCache::load() view the mapped file directly.
+class CacheRecord {
+public:
+    void put(std::string name, std::span<const double> values);
+    void put_scalar(std::string name, double value);
+
+    std::optional<std::span<const double>> get(std::string_view name) const;
+    // Copies an array out; throws std::runtime_error if it is missing.
+    std::vector<double> vector(std::string_view name) const;
+    double scalar(std::string_view name) const;
+
+    const std::vector<std::pair<std::string, std::span<const double>>>& arrays() const { return arrays_; }
+
+private:
+    friend class TruthCache;
+
+    std::shared_ptr<const void> storage_;
+    std::deque<std::vector<double>> owned_;
+    std::vector<std::pair<std::string, std::span<const double>>> arrays_;
+};
+
+// Content-addressed on-disk cache of FP64 inputs and truths.
+//
+// Each entry is one file, `<hash>.fpc`, laid out so the arrays can be used in
+// place from a read-only memory map:
+//
+//   char[8]  magic "FPSCACHE"
+//   uint32   format version, uint32 array count
+//   uint64   key length, key text, zero padding to 8 bytes
+//   per array: uint64 name length, name, padding to 8, uint64 count, doubles
+//
+// Values are native-endian. Writes go to a temporary file that is renamed
+// into place, so concurrent workers and interrupted runs never leave a
+// partial entry. A default-constructed cache is disabled and misses always.
+class TruthCache {
+public:
+    TruthCache() = default;
+    explicit TruthCache(std::filesystem::path directory);
+
+    bool enabled() const { return !directory_.empty(); }
+    const std::filesystem::path& directory() const { return directory_; }
+    std::filesystem::path path_for(const CacheKey& key) const;
+
+    std::optional<CacheRecord> load(const CacheKey& key) const;
+    // Returns false if the entry could not be written; the run continues.
+    bool store(const CacheKey& key, const CacheRecord& record) const;
+
+private:
+    std::filesystem::path directory_;
+};
+
+} // namespace fpstudy::core
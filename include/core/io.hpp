@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -11,14 +14,41 @@
 
 namespace fpstudy::core {
 
+// One cell of an output row. Numbers stay numbers until a writer formats
+// them, so binary outputs keep full precision: doubles are written to CSV the
+// way std::to_string formats them and integers in decimal.
+using Field = std::variant<std::string, double, int64_t>;
+using Row = std::vector<Field>;
+
+// Appends rows to an in-memory buffer and writes it out in large blocks
+// (every kFlushBytes, on flush(), and on destruction).
 class CsvWriter {
 public:
+    static constexpr std::size_t kFlushBytes = std::size_t(1) << 20;
+
     explicit CsvWriter(const std::filesystem::path& path, bool append = false);
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
     void write_header(const std::vector<std::string>& columns);
     void write_row(const std::vector<std::string>& values);
+    void write_fields(const Row& values);
+    void flush();
+
+    // Size of the file once everything written so far has been flushed.
+    uint64_t bytes_written() const { return bytes_flushed_ + buffer_.size(); }
+    // Bytes actually on disk (as of the last flush).
+    uint64_t bytes_flushed() const { return bytes_flushed_; }
 
 private:
+    void append_field(std::string_view value);
+    void end_row();
+
     std::ofstream stream_;
+    std::string buffer_;
+    uint64_t bytes_flushed_ = 0;
     bool header_written_ = false;
 };
 
@@ -62,8 +92,19 @@ struct Value {
 };
 
 Value parse(const std::string& text);
+// Reads the file through a fixed-size buffer rather than whole.
 Value load_file(const std::filesystem::path& path);
 
+// Parses a file whose top-level value is an object without building the
+// array under `array_key`, which is returned as an empty array if present.
+// With on_element, each element of that array is parsed and passed to it in
+// file order, one at a time, so memory is bounded by the largest element;
+// without, the array is skipped unparsed. Throws std::runtime_error if the
+// member is not an array.
+Object load_object_streaming(const std::filesystem::path& path,
+                             std::string_view array_key,
+                             const std::function<void(Value)>& on_element = {});
+
 std::string serialize_compact(const Value& value);
 
 } // namespace json
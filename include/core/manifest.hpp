@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+#include <vector>
+
+namespace fpstudy::core {
+
+// Completed-cell manifest for resumable sweeps (`--resume`).
+//
+// A text file next to the CSV, one entry per line:
+//
+//   cell <16 hex digits>     hash of a row that has been written
+//   commit <bytes>           the CSV holds every cell above in its first
+//                            <bytes> bytes
+//
+// Cells count only once a complete commit line follows them, so a run killed
+// between a CSV flush and the manifest write simply recomputes those cells. On resume
+// the CSV is truncated back to the last committed length first, which also
+// drops any partially written row.
+class SweepManifest {
+public:
+    SweepManifest() = default;
+
+    // A missing file is an empty manifest.
+    static SweepManifest load(const std::filesystem::path& path);
+
+    bool contains(uint64_t cell) const { return cells_.count(cell) != 0; }
+    const std::unordered_set<uint64_t>& cells() const { return cells_; }
+    std::size_t size() const { return cells_.size(); }
+    uint64_t committed_bytes() const { return committed_bytes_; }
+
+private:
+    std::unordered_set<uint64_t> cells_;
+    uint64_t committed_bytes_ = 0;
+};
+
+// Appends cells and commit lines to a manifest. Cells added since the last
+// commit are held in memory and written together with the next commit.
+class ManifestWriter {
+public:
+    ManifestWriter(const std::filesystem::path& path, bool append);
+
+    void add(uint64_t cell) { pending_.push_back(cell); }
+    // Call only after the CSV has been flushed to `csv_bytes`.
+    void commit(uint64_t csv_bytes);
+
+private:
+    std::ofstream stream_;
+    std::vector<uint64_t> pending_;
+};
+
+// Replaces `path` with exactly the committed state of `manifest`, dropping
+// cells that were never committed; written to a temporary file and renamed.
+void rewrite_manifest(const std::filesystem::path& path, const SweepManifest& manifest);
+
+// Manifest file used for a results CSV: "<out_csv>.manifest".
+std::filesystem::path manifest_path_for(const std::filesystem::path& csv_path);
+
+} // namespace fpstudy::core
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <limits>
 #include <vector>
@@ -9,6 +13,55 @@
 
 namespace fpstudy::core {
 
+// Hardware event counts of one timed region, in user space on the timing
+// thread. A count is -1 when it was not recorded: counters are off, the kernel
+// refused the events, or the region never got a turn on the PMU.
+struct PerfCounts {
+    int64_t cycles = -1;
+    int64_t instructions = -1;
+    int64_t cache_misses = -1;
+    int64_t branch_misses = -1;
+
+    bool valid() const { return cycles >= 0; }
+    // The counts divided evenly over n items, for rows that report their
+    // share of a batched region. Unrecorded counts stay -1.
+    PerfCounts share(std::size_t n) const {
+        auto part = [n](int64_t count) { return count < 0 ? count : count / static_cast<int64_t>(n); };
+        return {part(cycles), part(instructions), part(cache_misses), part(branch_misses)};
+    }
+};
+
+// Wall time and, when enabled, hardware counts of one timed region.
+struct TimedRegion {
+    double elapsed_ms = 0.0;
+    PerfCounts counters;
+
+    TimedRegion share(std::size_t n) const { return {elapsed_ms / static_cast<double>(n), counters.share(n)}; }
+};
+
+// Process-wide switch for perf_event counting in ScopedTimer; set it before
+// the first timer starts. Each thread opens its own event group on its first
+// timed region. When perf_event is unavailable (not Linux, or refused by
+// perf_event_paranoid or a container) a warning is printed once and the
+// counts stay -1.
+void set_perf_counters_enabled(bool enabled);
+bool perf_counters_enabled();
+
+namespace detail {
+
+// Raw running totals of the calling thread's event group, with the times
+// the group was enabled and actually on the PMU for multiplexing.
+struct PerfSnapshot {
+    std::array<uint64_t, 4> values{};
+    uint64_t time_enabled = 0;
+    uint64_t time_running = 0;
+};
+
+bool read_perf_snapshot(PerfSnapshot& snapshot);
+PerfCounts perf_counts_between(const PerfSnapshot& start, const PerfSnapshot& end);
+
+} // namespace detail
+
 struct RunMetrics {
     double relative_error = 0.0;
     int iterations = 0;
@@ -16,6 +69,7 @@ struct RunMetrics {
     int nan_count = 0;
     int inf_count = 0;
     double elapsed_ms = 0.0;
+    PerfCounts counters;
 };
 
 inline double vector_norm(const std::vector<double>& v) {
@@ -26,19 +80,49 @@ inline double vector_norm(const std::vector<double>& v) {
     return std::sqrt(accum);
 }
 
+// Error and special-value counts of one result against its FP64 truth.
+struct ErrorMetrics {
+    double relative_error = 0.0;
+    int nan_count = 0;
+    int inf_count = 0;
+};
+
+// One pass over truth and approx with no allocation: ||truth - approx||_2 /
+// max(||truth||_2, eps) plus NaN/Inf counts of approx. Both norms accumulate
+// in index order, exactly as vector_norm does, so the error is bit-identical
+// to relative_error on a materialized double vector.
+template <typename T>
+ErrorMetrics compute_metrics(std::span<const double> truth, std::span<const T> approx, double eps = 1e-12) {
+    if (truth.size() != approx.size()) {
+        throw std::runtime_error("Vector size mismatch in compute_metrics");
+    }
+    double truth_sq = 0.0;
+    double diff_sq = 0.0;
+    int nan_count = 0;
+    int inf_count = 0;
+    for (std::size_t i = 0; i < truth.size(); ++i) {
+        const double v = static_cast<double>(approx[i]);
+        const double d = truth[i] - v;
+        truth_sq += truth[i] * truth[i];
+        diff_sq += d * d;
+        nan_count += std::isnan(v) ? 1 : 0;
+        inf_count += std::isinf(v) ? 1 : 0;
+    }
+    return {std::sqrt(diff_sq) / std::max(std::sqrt(truth_sq), eps), nan_count, inf_count};
+}
+
+template <typename T>
+ErrorMetrics compute_metrics(const std::vector<double>& truth, const std::vector<T>& approx, double eps = 1e-12) {
+    return compute_metrics(std::span<const double>(truth), std::span<const T>(approx), eps);
+}
+
 inline double relative_error(const std::vector<double>& truth,
                              const std::vector<double>& approx,
                              double eps = 1e-12) {
     if (truth.size() != approx.size()) {
         throw std::runtime_error("Vector size mismatch in relative_error");
     }
-    std::vector<double> diff(truth.size());
-    for (size_t i = 0; i < truth.size(); ++i) {
-        diff[i] = truth[i] - approx[i];
-    }
-    double norm_truth = vector_norm(truth);
-    double norm_diff = vector_norm(diff);
-    return norm_diff / std::max(norm_truth, eps);
+    return compute_metrics(truth, approx, eps).relative_error;
 }
 
 template <typename T>
@@ -56,16 +140,34 @@ inline int count_inf(const std::vector<T>& data) {
     }));
 }
 
+// Times the region from construction to elapsed_ms() or region(). With
+// perf counters enabled it also snapshots the thread's hardware counters, so
+// a timer must be read on the thread that started it.
 class ScopedTimer {
 public:
-    ScopedTimer() : start_(Clock::now()) {}
+    ScopedTimer()
+        : counting_(perf_counters_enabled() && detail::read_perf_snapshot(start_counts_)), start_(Clock::now()) {}
     double elapsed_ms() const {
         auto delta = Clock::now() - start_;
         return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(delta).count();
     }
+    // Counts since construction; all -1 unless counting started.
+    PerfCounts counters() const {
+        detail::PerfSnapshot end;
+        if (!counting_ || !detail::read_perf_snapshot(end)) {
+            return {};
+        }
+        return detail::perf_counts_between(start_counts_, end);
+    }
+    TimedRegion region() const {
+        double elapsed = elapsed_ms();
+        return {elapsed, counters()};
+    }
 
 private:
     using Clock = std::chrono::steady_clock;
+    detail::PerfSnapshot start_counts_;
+    bool counting_;
     Clock::time_point start_;
 };
 
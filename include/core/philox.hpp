@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace fpstudy::core {
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+// 3", SC'11): a keyed bijection on 128-bit counters. Block c of a stream is
+// philox4x32(c, key), so any block can be produced without its predecessors
+// and a range of output can be split across threads without changing it.
+using PhiloxCounter = std::array<uint32_t, 4>;
+using PhiloxKey = std::array<uint32_t, 2>;
+
+namespace detail {
+
+inline constexpr uint32_t kPhiloxM0 = 0xD2511F53u;
+inline constexpr uint32_t kPhiloxM1 = 0xCD9E8D57u;
+inline constexpr uint32_t kPhiloxW0 = 0x9E3779B9u;
+inline constexpr uint32_t kPhiloxW1 = 0xBB67AE85u;
+
+constexpr PhiloxCounter philox_round(const PhiloxCounter& x, const PhiloxKey& key) {
+    const uint64_t p0 = uint64_t(kPhiloxM0) * x[0];
+    const uint64_t p1 = uint64_t(kPhiloxM1) * x[2];
+    return {static_cast<uint32_t>(p1 >> 32) ^ x[1] ^ key[0], static_cast<uint32_t>(p1),
+            static_cast<uint32_t>(p0 >> 32) ^ x[3] ^ key[1], static_cast<uint32_t>(p0)};
+}
+
+} // namespace detail
+
+constexpr PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key) {
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            key[0] += detail::kPhiloxW0;
+            key[1] += detail::kPhiloxW1;
+        }
+        counter = detail::philox_round(counter, key);
+    }
+    return counter;
+}
+
+} // namespace fpstudy::core
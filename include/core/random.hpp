@@ -1,17 +1,57 @@
 #pragma once
 
 #include <random>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 namespace fpstudy::core {
 
+// Generator behind random_vector / random_matrix (config key "rng").
+//
+//   MT19937  std::mt19937 with std::normal_distribution, drawn serially; the
+//            default, and what every earlier result was generated with.
+//   Philox   counter-based Philox4x32-10 with a Box-Muller transform. Each
+//            random_vector / random_matrix call reads its own stream, and
+//            element i of a stream depends only on (seed, stream, i), so
+//            large fills are split across threads with identical output.
+enum class RngKind {
+    MT19937,
+    Philox
+};
+
+std::string rng_kind_to_string(RngKind kind);
+RngKind rng_kind_from_string(std::string_view name);
+
+// Writes elements [first, first + out.size()) of Philox normal stream
+// `stream` under `seed`, times `scale`. Element 2k and 2k + 1 are the cosine
+// and sine halves of one Box-Muller pair built from counter block k. The
+// logarithm and sincos are evaluated with fixed polynomials rather than
+// libm, so values are the same on every IEEE platform.
+void philox_normal_fill(uint32_t seed, uint64_t stream, uint64_t first, std::span<double> out, double scale = 1.0);
+
+// philox_normal_fill from element 0, using up to hardware_concurrency threads
+// once out is large enough to pay for them. On a ThreadPool worker (a
+// `--jobs N` sweep) it runs serially, so it does not oversubscribe the
+// cores. Output does not depend on the thread count.
+void philox_normal_fill_parallel(uint32_t seed, uint64_t stream, std::span<double> out, double scale = 1.0);
+
 class Random {
 public:
-    explicit Random(uint32_t seed) : engine_(seed) {}
+    explicit Random(uint32_t seed, RngKind kind = RngKind::MT19937) : engine_(seed), seed_(seed), kind_(kind) {}
 
+    // uniform() and engine() always draw from the mt19937 engine.
     std::mt19937& engine() { return engine_; }
 
+    RngKind kind() const { return kind_; }
+    uint32_t seed() const { return seed_; }
+
+    // Philox stream for the next fill; streams are handed out in call order.
+    uint64_t next_stream() { return stream_++; }
+
     template <typename T>
     T uniform(T min, T max) {
         std::uniform_real_distribution<double> dist(static_cast<double>(min), static_cast<double>(max));
@@ -20,11 +60,18 @@ public:
 
 private:
     std::mt19937 engine_;
+    uint32_t seed_;
+    RngKind kind_;
+    uint64_t stream_ = 0;
 };
 
 inline std::vector<double> random_vector(size_t n, Random& rng, double scale = 1.0) {
-    std::normal_distribution<double> dist(0.0, scale);
     std::vector<double> data(n);
+    if (rng.kind() == RngKind::Philox) {
+        philox_normal_fill_parallel(rng.seed(), rng.next_stream(), data, scale);
+        return data;
+    }
+    std::normal_distribution<double> dist(0.0, scale);
     for (double& v : data) {
         v = dist(rng.engine());
     }
@@ -32,10 +79,14 @@ inline std::vector<double> random_vector(size_t n, Random& rng, double scale = 1
 }
 
 inline std::vector<double> random_matrix(size_t rows, size_t cols, Random& rng, bool ill_conditioned = false) {
-    std::normal_distribution<double> dist(0.0, 1.0);
     std::vector<double> mat(rows * cols);
-    for (double& v : mat) {
-        v = dist(rng.engine());
+    if (rng.kind() == RngKind::Philox) {
+        philox_normal_fill_parallel(rng.seed(), rng.next_stream(), mat);
+    } else {
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for (double& v : mat) {
+            v = dist(rng.engine());
+        }
     }
     if (ill_conditioned && cols > 0) {
         for (size_t r = 0; r < rows; ++r) {
@@ -46,4 +97,3 @@ inline std::vector<double> random_matrix(size_t rows, size_t cols, Random& rng,
 }
 
 } // namespace fpstudy::core
-
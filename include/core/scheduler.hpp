@@ -0,0 +1,148 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/io.hpp"
+#include "core/manifest.hpp"
+#include "core/shard.hpp"
+#include "core/table.hpp"
+
+namespace fpstudy::core {
+
+// Fixed-size worker pool for the sweep driver.
+//
+// With zero workers every submitted task runs inline on the calling thread,
+// which keeps `--jobs 1` identical to the historical serial loop. Tasks
+// submitted from inside a worker go to the front of the queue, so the cells
+// spawned by a trial are drained before the next trial starts. With
+// max_queued, a submit() from outside the pool blocks while that many tasks
+// are queued, so a scheduler expanding a large sweep stays only a few trial
+// units ahead of the workers and memory use stays proportional to their
+// number. Nested submissions never block.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t workers, std::size_t max_queued = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task (including nested submissions) has
+    // finished, then rethrows the first exception raised by a task, if any.
+    void wait();
+
+    std::size_t workers() const { return threads_.size(); }
+
+    // Whether the calling thread is a worker of some ThreadPool. Code that
+    // would start threads of its own stays serial there, since the pool
+    // already occupies the cores.
+    static bool on_worker_thread();
+
+private:
+    void worker_loop();
+    void run_task(std::function<void()>& task);
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable space_available_;
+    std::condition_variable idle_;
+    std::size_t max_queued_;
+    std::size_t in_flight_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr first_error_;
+};
+
+// Number of workers to use for a `--jobs` value: 0 means one per hardware
+// thread, 1 means run inline.
+std::size_t resolve_job_count(std::size_t requested);
+
+// Accepts rows tagged with their position in the serial sweep order and
+// writes them to the CsvWriter (and the columnar output, if any) strictly in
+// that order, regardless of the order in which worker threads finish them.
+//
+// With a manifest, each row carries the hash of its cell. Every
+// kCommitRows rows, and on commit(), the CSV is flushed and the written cells
+// are committed to the manifest. Rows of cells completed by an earlier run
+// are released with skip() so later rows are not held back. With a row
+// index (`--shard`), the serial position of every written row is recorded so
+// shards can be merged back into the unsharded order.
+//
+// By default the thread that pushes a row formats and writes it. After
+// start_writer(), push() and skip() only hand rows to a dedicated writer
+// thread through a queue of at most `capacity` rows, blocking while it is
+// full, so CSV formatting and file I/O leave the compute threads. commit()
+// then waits for the queue to drain, and an error raised while writing is
+// rethrown by the next push(), skip() or commit().
+class OrderedRowSink {
+public:
+    static constexpr std::size_t kCommitRows = 64;
+
+    explicit OrderedRowSink(CsvWriter& writer, ColumnarWriter* columnar = nullptr,
+                            ManifestWriter* manifest = nullptr, RowIndexWriter* row_index = nullptr)
+        : writer_(writer), columnar_(columnar), manifest_(manifest), row_index_(row_index) {}
+    ~OrderedRowSink();
+
+    OrderedRowSink(const OrderedRowSink&) = delete;
+    OrderedRowSink& operator=(const OrderedRowSink&) = delete;
+
+    void start_writer(std::size_t capacity);
+
+    void push(std::size_t index, Row row, uint64_t cell = 0);
+    void skip(std::size_t index);
+    void commit();
+
+    bool tracks_cells() const { return manifest_ != nullptr; }
+    std::size_t rows_written() const;
+    std::size_t rows_pending() const;
+
+private:
+    struct Entry {
+        Row row;
+        uint64_t cell = 0;
+        bool skipped = false;
+    };
+
+    void accept(std::size_t index, Entry entry);
+    void accept_locked(std::size_t index, Entry entry);
+    void write(std::size_t index, const Entry& entry);
+    void commit_locked();
+    void writer_loop();
+    void drain_inbox();
+
+    CsvWriter& writer_;
+    ColumnarWriter* columnar_;
+    ManifestWriter* manifest_;
+    RowIndexWriter* row_index_;
+    mutable std::mutex mutex_;
+    std::map<std::size_t, Entry> pending_;
+    std::size_t next_ = 0;
+    std::size_t uncommitted_ = 0;
+
+    // Writer thread handoff, guarded by inbox_mutex_.
+    std::thread writer_thread_;
+    std::mutex inbox_mutex_;
+    std::condition_variable inbox_ready_;
+    std::condition_variable inbox_space_;
+    std::condition_variable inbox_drained_;
+    std::deque<std::pair<std::size_t, Entry>> inbox_;
+    std::size_t inbox_capacity_ = 0;
+    bool writer_busy_ = false;
+    bool stopping_ = false;
+    std::exception_ptr writer_error_;
+};
+
+} // namespace fpstudy::core
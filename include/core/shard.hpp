@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fpstudy::core {
+
+// `--shard i/N`: this process runs trial units i, i + N, i + 2N, ... of the
+// sweep, counting units in the serial scheduling order. A trial unit is one
+// trial's data generation plus all of its cells, so every shard generates
+// only the inputs it needs. Round-robin assignment spreads the expensive
+// large-size trials over all shards.
+struct ShardSpec {
+    std::size_t index = 0;
+    std::size_t count = 1;
+
+    // Parses "i/N" with 0 <= i < N; throws std::runtime_error otherwise.
+    static ShardSpec parse(std::string_view text);
+
+    bool enabled() const { return count > 1; }
+    bool owns(std::size_t unit) const { return unit % count == index; }
+    std::string to_string() const;
+};
+
+// Sidecar `<out_csv>.rows` of a shard: a "fpstudy-shard i/N" line, then the
+// global (unsharded) row index of every CSV row, one per line, in CSV order.
+class RowIndexWriter {
+public:
+    // Starts a new index. With `keep_rows` > 0 (--resume), the first
+    // `keep_rows` entries of the existing index are kept; throws if it belongs
+    // to a different shard or holds fewer entries.
+    RowIndexWriter(const std::filesystem::path& path, const ShardSpec& shard, std::size_t keep_rows = 0);
+
+    void add(std::size_t row);
+    void flush();
+
+private:
+    std::ofstream stream_;
+};
+
+std::filesystem::path row_index_path_for(const std::filesystem::path& csv_path);
+
+// Output CSV of one shard, so shards sharing a config never collide:
+// "results/sweep.csv" becomes "results/sweep.shard-2-of-4.csv".
+std::filesystem::path shard_csv_path(const std::filesystem::path& csv_path, const ShardSpec& shard);
+
+// Every existing shard CSV for `csv_path`, as named by shard_csv_path().
+std::vector<std::filesystem::path> find_shard_csvs(const std::filesystem::path& csv_path);
+
+// Merges the CSVs of all N shards of one sweep into `output` in the order an
+// unsharded run writes them. Throws std::runtime_error if a shard is missing
+// or duplicated, headers differ, or the row indices have gaps or repeats.
+// Returns the number of rows written.
+std::size_t merge_shards(const std::vector<std::filesystem::path>& shard_csvs,
+                         const std::filesystem::path& output);
+
+} // namespace fpstudy::core
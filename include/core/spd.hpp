@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/random.hpp"
+
+namespace fpstudy::core {
+
+// Symmetric positive definite test matrices for gd_quadratic (config key
+// "spd"). All results are dense, row-major and exactly symmetric.
+//
+//   Gram      Q = M^T M + 0.1 dim I for a dim x dim Gaussian M; O(dim^3).
+//   Spectral  Q = U diag(lambda) U^T with lambda log-spaced from 1 down to
+//             1 / condition and U a product of random Householder
+//             reflections; O(dim^2), so the condition number is exact.
+//   LowRank   Q = V^T V + 0.1 dim I for a rank x dim Gaussian V; O(dim^2 rank).
+enum class SpdKind {
+    Gram,
+    Spectral,
+    LowRank
+};
+
+std::string spd_kind_to_string(SpdKind kind);
+SpdKind spd_kind_from_string(std::string_view name);
+
+struct SpdOptions {
+    SpdKind kind = SpdKind::Gram;
+    double condition = 1e3;   // Spectral: lambda_max / lambda_min
+    std::size_t rank = 8;     // LowRank: rows of V
+};
+
+// Q = M^T M + shift * I for a row-major `rows` x `dim` matrix M.
+//
+// Blocked SYRK: only tiles on or above the diagonal are computed, each as a
+// sequence of rank-1 updates over the rows of M so both operands are
+// unit-stride, and the lower half is mirrored. Every entry still sums its
+// products in row order starting from 0.0, then adds the shift on the
+// diagonal, so Q is bit-identical to the textbook triple loop.
+std::vector<double> gram_spd(std::span<const double> M, std::size_t rows, std::size_t dim, double shift);
+
+// Q = H_r ... H_1 diag(lambda) H_1 ... H_r. Each reflection is a rank-2
+// update of the current matrix.
+std::vector<double> spectral_spd(std::size_t dim, double condition, Random& rng, std::size_t reflections = 4);
+
+// Draws one dim x dim SPD matrix of the requested kind. `ill_conditioned`
+// scales the first column of M (Gram) or V (LowRank) by 1e-6, as before.
+// Spectral matrices are conditioned by opts.condition alone, and throw
+// std::runtime_error if ill_conditioned is also set.
+std::vector<double> make_spd(std::size_t dim, Random& rng, bool ill_conditioned, const SpdOptions& opts);
+
+} // namespace fpstudy::core
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/io.hpp"
+
+namespace fpstudy::core {
+
+enum class ColumnType : uint64_t {
+    String = 0,
+    Float64 = 1,
+    Int64 = 2
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+};
+
+// Columnar binary results file, laid out so every column can be used in
+// place from a read-only memory map:
+//
+//   char[8]  magic "FPSTABLE"
+//   uint32   format version, uint32 column count
+//   per column: uint64 type, uint64 name length, name, padding to 8
+//   per batch:  uint64 row count, then per column
+//                 Float64/Int64: row count values
+//                 String: row count + 1 uint64 offsets, bytes, padding to 8
+//   uint64   file offset of each batch, uint64 batch count
+//   char[8]  magic "FPSTABLE"
+//
+// Values are native-endian. Readers locate the batches through the footer,
+// so a file is only valid once finish() has run.
+class ColumnarWriter {
+public:
+    static constexpr std::size_t kBatchRows = 65536;
+
+    ColumnarWriter(const std::filesystem::path& path, std::vector<ColumnSpec> schema,
+                   std::size_t batch_rows = kBatchRows);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // Throws std::runtime_error if the row does not match the schema.
+    void write_row(const Row& row);
+    // Writes the pending batch and the footer; later calls do nothing.
+    void finish();
+
+    std::size_t rows_written() const { return rows_written_; }
+
+private:
+    struct ColumnBuffer {
+        std::vector<double> floats;
+        std::vector<int64_t> ints;
+        std::vector<uint64_t> offsets;
+        std::string bytes;
+    };
+
+    void write_batch();
+    void write_bytes(const void* data, std::size_t size);
+    void pad();
+
+    std::ofstream stream_;
+    std::vector<ColumnSpec> schema_;
+    std::vector<ColumnBuffer> buffers_;
+    std::vector<uint64_t> batch_offsets_;
+    std::size_t batch_rows_;
+    std::size_t pending_rows_ = 0;
+    std::size_t rows_written_ = 0;
+    uint64_t position_ = 0;
+    bool finished_ = false;
+};
+
+// Read-only view of a file written by ColumnarWriter. Throws
+// std::runtime_error if the file is missing, truncated or malformed.
+class ColumnarTable {
+public:
+    explicit ColumnarTable(const std::filesystem::path& path);
+
+    const std::vector<ColumnSpec>& columns() const { return columns_; }
+    std::size_t column_index(std::string_view name) const;
+
+    std::size_t batch_count() const { return batches_.size(); }
+    std::size_t batch_rows(std::size_t batch) const { return batches_.at(batch).rows; }
+    std::size_t rows() const;
+
+    std::span<const double> float64(std::size_t batch, std::size_t column) const;
+    std::span<const int64_t> int64(std::size_t batch, std::size_t column) const;
+    std::string_view string(std::size_t batch, std::size_t column, std::size_t row) const;
+
+private:
+    struct Batch {
+        std::size_t rows = 0;
+        std::vector<const std::byte*> columns;
+    };
+
+    const std::byte* column_data(std::size_t batch, std::size_t column, ColumnType type) const;
+
+    std::shared_ptr<const void> storage_;
+    std::vector<ColumnSpec> columns_;
+    std::vector<Batch> batches_;
+};
+
+} // namespace fpstudy::core
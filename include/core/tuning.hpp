@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fpstudy::core {
+
+// Backend profile written by `fpstudy tune`: for each kernel cell, keyed by
+// (algo, precision name, size), the time of every backend that was measured
+// and the fastest one whose output matched the reference bit for bit. Size
+// is n for matmul, the tap count for fir and dim for gd_quadratic. Backends
+// are stored by name (backend_to_string), so this file knows nothing of the
+// algorithm headers.
+//
+// The file is JSON, one kernel per line:
+//
+//   {"host": "<host name>", "kernels": [
+//   {"algo":"matmul","precision":"bf16","size":64,"backend":"vectorized",
+//    "timings":[{"backend":"reference","ms":1.9,"exact":true}, ...]},
+//   ...
+//   ]}
+struct BackendTiming {
+    std::string backend;
+    double ms = 0.0;
+    bool exact = true;
+};
+
+struct TunedKernel {
+    std::string algo;
+    std::string precision;
+    std::size_t size = 0;
+    // Fastest exact entry of `timings`.
+    std::string backend;
+    std::vector<BackendTiming> timings;
+};
+
+class BackendProfile {
+public:
+    BackendProfile() = default;
+    explicit BackendProfile(std::string host) : host_(std::move(host)) {}
+
+    // Throws std::runtime_error if the file is missing or malformed.
+    static BackendProfile load(const std::filesystem::path& path);
+    // Written to a temporary file and renamed over `path`.
+    void save(const std::filesystem::path& path) const;
+
+    // Adds a kernel, replacing any earlier entry for the same cell. Sets
+    // kernel.backend from the timings; throws if none of them is exact.
+    void record(TunedKernel kernel);
+
+    // Backend name for a cell, or nullptr when the profile has no entry.
+    const std::string* backend_for(std::string_view algo, std::string_view precision, std::size_t size) const;
+
+    const std::string& host() const { return host_; }
+    std::size_t size() const { return kernels_.size(); }
+    // In (algo, precision, size) order.
+    std::vector<const TunedKernel*> kernels() const;
+
+private:
+    using Key = std::tuple<std::string, std::string, std::size_t>;
+
+    std::string host_;
+    std::map<Key, TunedKernel, std::less<>> kernels_;
+};
+
+// gethostname() where available, otherwise "unknown".
+std::string host_name();
+
+// "fpstudy-profile-<host>.json" in the working directory, the file `fpstudy
+// tune` writes and the sweep reads when neither names another.
+std::filesystem::path default_profile_path();
+
+} // namespace fpstudy::core
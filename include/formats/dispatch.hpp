@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "formats/packed.hpp"
+#include "formats/precision.hpp"
+
+namespace fpstudy::formats {
+
+template <Precision P>
+using PrecisionTag = std::integral_constant<Precision, P>;
+
+template <Precision... Ps>
+struct PrecisionList {
+    static constexpr std::size_t size = sizeof...(Ps);
+};
+
+// Every format the sweep driver can run. Adding a format means adding its
+// PrecisionTraits/PackedStorage specializations and listing it here.
+// Minifloat layouts listed here run on compiled codecs; any other valid
+// layout goes through the MiniFloatRuntime instantiation.
+using AllPrecisions = PrecisionList<Precision::FP64,
+                                    Precision::FP32,
+                                    Precision::TF32,
+                                    Precision::BF16,
+                                    Precision::P3109_8,
+                                    kMiniFloatE5M2,
+                                    kMiniFloatE4M3,
+                                    kMiniFloatE3M4,
+                                    kMiniFloatE3M2,
+                                    kMiniFloatE2M3,
+                                    Precision::MiniFloatRuntime>;
+
+namespace detail {
+
+template <typename Fn, Precision P>
+decltype(auto) invoke_with_tag(Fn& fn) {
+    return fn(PrecisionTag<P>{});
+}
+
+template <typename Fn, Precision First, Precision... Rest>
+decltype(auto) dispatch_precision_impl(Precision p, Fn& fn, PrecisionList<First, Rest...>) {
+    using Result = decltype(invoke_with_tag<Fn, First>(fn));
+    using Thunk = Result (*)(Fn&);
+    static constexpr std::array<Precision, 1 + sizeof...(Rest)> keys = {First, Rest...};
+    static constexpr std::array<Thunk, 1 + sizeof...(Rest)> thunks = {
+        &invoke_with_tag<Fn, First>, &invoke_with_tag<Fn, Rest>...};
+    static_assert((std::is_same_v<Result, decltype(invoke_with_tag<Fn, Rest>(fn))> && ...),
+                  "dispatch_precision: every instantiation must return the same type");
+    if (p == Precision::MiniFloatRuntime) {
+        throw std::runtime_error("dispatch_precision: MiniFloatRuntime is a dispatch tag, not a precision");
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == p) {
+            return thunks[i](fn);
+        }
+    }
+    if (is_minifloat_precision(p)) {
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == Precision::MiniFloatRuntime) {
+                MiniFloatScope scope(MiniFloatFormat::get(minifloat_layout(p)));
+                return thunks[i](fn);
+            }
+        }
+    }
+    throw std::runtime_error("Precision not in dispatch list: " + precision_to_string(p));
+}
+
+} // namespace detail
+
+// Calls fn(PrecisionTag<P>{}) for the runtime precision p through a table of
+// per-format instantiations, so a generic lambda or templated runner is
+// written once instead of once per switch case. A minifloat layout missing
+// from the list runs as PrecisionTag<MiniFloatRuntime> with its format active
+// on the calling thread for the duration of fn; work fn hands to other
+// threads must open its own MiniFloatScope.
+template <typename List = AllPrecisions, typename Fn>
+decltype(auto) dispatch_precision(Precision p, Fn&& fn) {
+    return detail::dispatch_precision_impl(p, fn, List{});
+}
+
+// Per-format conversion buffers that keep their allocations between runs.
+// Slot i of format P holds one operand; encoding into it reuses the existing
+// capacity, so a worker converts every trial into the same memory.
+template <std::size_t Slots, typename List = AllPrecisions>
+class ConversionBuffers;
+
+template <std::size_t Slots, Precision... Ps>
+class ConversionBuffers<Slots, PrecisionList<Ps...>> {
+public:
+    template <Precision P>
+    PackedVector<P>& packed(std::size_t slot) {
+        return std::get<Entry<P>>(entries_).packed.at(slot);
+    }
+
+    template <Precision P>
+    const PackedVector<P>& encode(std::size_t slot, std::span<const double> input) {
+        auto& target = packed<P>(slot);
+        target.assign(input);
+        return target;
+    }
+
+    // Encodes `input` and returns it as format values. Formats without a
+    // value view (TF32/BF16) materialize into a reusable vector of T.
+    template <Precision P>
+    std::span<const typename PrecisionTraits<P>::type> values(std::size_t slot, std::span<const double> input) {
+        const auto& encoded = encode<P>(slot, input);
+        if constexpr (PackedVector<P>::has_value_view) {
+            return encoded.values();
+        } else {
+            auto& materialized = std::get<Entry<P>>(entries_).values.at(slot);
+            materialized.clear();
+            materialized.reserve(encoded.size());
+            for (std::size_t i = 0; i < encoded.size(); ++i) {
+                materialized.push_back(encoded[i]);
+            }
+            return materialized;
+        }
+    }
+
+private:
+    template <Precision P>
+    struct Entry {
+        std::array<PackedVector<P>, Slots> packed;
+        std::array<std::vector<typename PrecisionTraits<P>::type>, Slots> values;
+    };
+
+    std::tuple<Entry<Ps>...> entries_;
+};
+
+} // namespace fpstudy::formats
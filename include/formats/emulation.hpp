@@ -0,0 +1,269 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace fpstudy::formats {
+
+// Describes a format whose arithmetic can be emulated exactly with FP32
+// operations followed by round-to-nearest-even on the fraction. BF16 (7
+// fraction bits) and TF32 (10 fraction bits) qualify: with p <= 11 significand
+// bits, an FP32 add, subtract or multiply rounded once more to p bits equals
+// the correctly rounded result, so no double-rounding error can appear.
+// Specializations live next to the format definitions; float itself is the
+// degenerate case with nothing to round.
+template <typename T>
+struct Fp32Emulation {
+    static constexpr bool enabled = false;
+};
+
+template <>
+struct Fp32Emulation<float> {
+    static constexpr bool enabled = true;
+    static constexpr int fraction_bits = 23;
+};
+
+// Rounds an FP32 value to `FractionBits` fraction bits (round to nearest,
+// ties to even). Results below the FP32 normal range flush to signed zero,
+// matching cfloat without subnormals. Inf and NaN pass through.
+template <int FractionBits>
+inline float round_fraction(float value) {
+    static_assert(FractionBits >= 1 && FractionBits <= 23, "FractionBits out of range");
+    if constexpr (FractionBits == 23) {
+        return value;
+    } else {
+        constexpr uint32_t drop = 23 - FractionBits;
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        if ((bits & 0x7F800000u) == 0x7F800000u) {
+            return value;
+        }
+        bits += ((1u << (drop - 1)) - 1u) + ((bits >> drop) & 1u);
+        bits &= ~((1u << drop) - 1u);
+        if ((bits & 0x7F800000u) == 0) {
+            bits &= 0x80000000u;
+        }
+        return std::bit_cast<float>(bits);
+    }
+}
+
+namespace simd {
+
+// One-lane fallback used for loop tails and on targets without SIMD.
+struct ScalarOps {
+    using V = float;
+    static constexpr std::size_t width = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set1(float v) { return v; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    template <int FractionBits>
+    static V round(V v) { return round_fraction<FractionBits>(v); }
+};
+
+#if defined(__AVX512F__)
+
+struct VecOps {
+    using V = __m512;
+    static constexpr std::size_t width = 16;
+    static constexpr const char* name = "avx512";
+    static V load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    static V set1(float v) { return _mm512_set1_ps(v); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    template <int FractionBits>
+    static V round(V v) {
+        if constexpr (FractionBits == 23) {
+            return v;
+        } else {
+            constexpr int drop = 23 - FractionBits;
+            const __m512i exp_mask = _mm512_set1_epi32(0x7F800000);
+            __m512i bits = _mm512_castps_si512(v);
+            __m512i exp = _mm512_and_si512(bits, exp_mask);
+            __mmask16 special = _mm512_cmpeq_epi32_mask(exp, exp_mask);
+            __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(bits, drop), _mm512_set1_epi32(1));
+            __m512i rounded = _mm512_add_epi32(bits, _mm512_add_epi32(_mm512_set1_epi32((1 << (drop - 1)) - 1), lsb));
+            rounded = _mm512_and_si512(rounded, _mm512_set1_epi32(~((1 << drop) - 1)));
+            __mmask16 tiny = _mm512_cmpeq_epi32_mask(_mm512_and_si512(rounded, exp_mask), _mm512_setzero_si512());
+            rounded = _mm512_mask_and_epi32(rounded, tiny, rounded, _mm512_set1_epi32(static_cast<int>(0x80000000u)));
+            return _mm512_castsi512_ps(_mm512_mask_blend_epi32(special, rounded, bits));
+        }
+    }
+};
+
+#elif defined(__AVX2__)
+
+struct VecOps {
+    using V = __m256;
+    static constexpr std::size_t width = 8;
+    static constexpr const char* name = "avx2";
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float v) { return _mm256_set1_ps(v); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    template <int FractionBits>
+    static V round(V v) {
+        if constexpr (FractionBits == 23) {
+            return v;
+        } else {
+            constexpr int drop = 23 - FractionBits;
+            const __m256i exp_mask = _mm256_set1_epi32(0x7F800000);
+            __m256i bits = _mm256_castps_si256(v);
+            __m256i special = _mm256_cmpeq_epi32(_mm256_and_si256(bits, exp_mask), exp_mask);
+            __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, drop), _mm256_set1_epi32(1));
+            __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(_mm256_set1_epi32((1 << (drop - 1)) - 1), lsb));
+            rounded = _mm256_and_si256(rounded, _mm256_set1_epi32(~((1 << drop) - 1)));
+            __m256i tiny = _mm256_cmpeq_epi32(_mm256_and_si256(rounded, exp_mask), _mm256_setzero_si256());
+            __m256i flushed = _mm256_and_si256(rounded, _mm256_set1_epi32(static_cast<int>(0x80000000u)));
+            rounded = _mm256_blendv_epi8(rounded, flushed, tiny);
+            return _mm256_castsi256_ps(_mm256_blendv_epi8(rounded, bits, special));
+        }
+    }
+};
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+struct VecOps {
+    using V = __m128;
+    static constexpr std::size_t width = 4;
+    static constexpr const char* name = "sse2";
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float v) { return _mm_set1_ps(v); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static __m128i select(__m128i mask, __m128i if_set, __m128i if_clear) {
+        return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+    }
+    template <int FractionBits>
+    static V round(V v) {
+        if constexpr (FractionBits == 23) {
+            return v;
+        } else {
+            constexpr int drop = 23 - FractionBits;
+            const __m128i exp_mask = _mm_set1_epi32(0x7F800000);
+            __m128i bits = _mm_castps_si128(v);
+            __m128i special = _mm_cmpeq_epi32(_mm_and_si128(bits, exp_mask), exp_mask);
+            __m128i lsb = _mm_and_si128(_mm_srli_epi32(bits, drop), _mm_set1_epi32(1));
+            __m128i rounded = _mm_add_epi32(bits, _mm_add_epi32(_mm_set1_epi32((1 << (drop - 1)) - 1), lsb));
+            rounded = _mm_and_si128(rounded, _mm_set1_epi32(~((1 << drop) - 1)));
+            __m128i tiny = _mm_cmpeq_epi32(_mm_and_si128(rounded, exp_mask), _mm_setzero_si128());
+            __m128i flushed = _mm_and_si128(rounded, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+            rounded = select(tiny, flushed, rounded);
+            return _mm_castsi128_ps(select(special, bits, rounded));
+        }
+    }
+};
+
+#elif defined(__ARM_NEON)
+
+struct VecOps {
+    using V = float32x4_t;
+    static constexpr std::size_t width = 4;
+    static constexpr const char* name = "neon";
+    static V load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, V v) { vst1q_f32(p, v); }
+    static V set1(float v) { return vdupq_n_f32(v); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V sub(V a, V b) { return vsubq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+    template <int FractionBits>
+    static V round(V v) {
+        if constexpr (FractionBits == 23) {
+            return v;
+        } else {
+            constexpr int drop = 23 - FractionBits;
+            const uint32x4_t exp_mask = vdupq_n_u32(0x7F800000u);
+            uint32x4_t bits = vreinterpretq_u32_f32(v);
+            uint32x4_t special = vceqq_u32(vandq_u32(bits, exp_mask), exp_mask);
+            uint32x4_t lsb = vandq_u32(vshrq_n_u32(bits, drop), vdupq_n_u32(1u));
+            uint32x4_t rounded = vaddq_u32(bits, vaddq_u32(vdupq_n_u32((1u << (drop - 1)) - 1u), lsb));
+            rounded = vandq_u32(rounded, vdupq_n_u32(~((1u << drop) - 1u)));
+            uint32x4_t tiny = vceqq_u32(vandq_u32(rounded, exp_mask), vdupq_n_u32(0u));
+            rounded = vbslq_u32(tiny, vandq_u32(rounded, vdupq_n_u32(0x80000000u)), rounded);
+            return vreinterpretq_f32_u32(vbslq_u32(special, bits, rounded));
+        }
+    }
+};
+
+#else
+
+struct VecOps : ScalarOps {
+    static constexpr const char* name = "scalar";
+};
+
+#endif
+
+} // namespace simd
+
+// Name of the instruction set the packed kernels were compiled for.
+inline const char* simd_backend_name() { return simd::VecOps::name; }
+
+// Checks that FP32-compute-then-round reproduces T's own arithmetic and
+// conversion bit for bit on a deterministic sample of operands (ordinary
+// values across the exponent range plus under/overflow edges). The
+// vectorized backends only run when this holds; the result is cached.
+template <typename T>
+bool fp32_emulation_verified() {
+    static const bool verified = [] {
+        if constexpr (!Fp32Emulation<T>::enabled) {
+            return false;
+        } else {
+            constexpr int F = Fp32Emulation<T>::fraction_bits;
+            auto same = [](float a, float b) {
+                return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b) ||
+                       (std::isnan(a) && std::isnan(b));
+            };
+            std::vector<float> samples = {
+                0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 3.0f, 1e-3f, -7.25f,
+                std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                std::numeric_limits<float>::min() * 1.5f, std::numeric_limits<float>::min() * 0.75f,
+            };
+            uint32_t state = 0x12345678u;
+            for (int i = 0; i < 2048; ++i) {
+                state = state * 1664525u + 1013904223u;
+                int exponent = static_cast<int>((state >> 8) % 61) - 30;
+                float mantissa = 1.0f + static_cast<float>(state & 0xFFFFu) / 65536.0f;
+                float v = std::ldexp(mantissa, exponent);
+                samples.push_back((state >> 31) ? -v : v);
+            }
+            for (float s : samples) {
+                if (!same(round_fraction<F>(s), static_cast<float>(T(s)))) {
+                    return false;
+                }
+            }
+            for (std::size_t i = 0; i + 1 < samples.size(); ++i) {
+                T ta(samples[i]);
+                T tb(samples[i + 1]);
+                float a = static_cast<float>(ta);
+                float b = static_cast<float>(tb);
+                if (!same(round_fraction<F>(a * b), static_cast<float>(ta * tb)) ||
+                    !same(round_fraction<F>(a + b), static_cast<float>(ta + tb)) ||
+                    !same(round_fraction<F>(a - b), static_cast<float>(ta - tb))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }();
+    return verified;
+}
+
+} // namespace fpstudy::formats
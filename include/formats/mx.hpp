@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "formats/precision.hpp"
+
+namespace fpstudy::formats {
+
+// Block-scaled storage after the OCP Microscaling (MX) v1.0 layout: each
+// block of kMxBlockSize consecutive elements shares one E8M0 scale byte s,
+// worth 2^(s - 127), and each element is a minifloat code of its value
+// divided by the block scale. The shared exponent is
+// floor(log2(max |x|)) - emax of the element layout, clamped to the E8M0
+// range, so the block maximum lands in the element format's top binade and
+// larger values saturate. Infinities and NaN keep their element codes and do
+// not take part in choosing the scale.
+//
+// Elements use the P3109-style minifloat semantics of this project (see
+// quantize.hpp), not the OCP element encodings. Codes are stored one per
+// byte whatever the element width.
+inline constexpr std::size_t kMxBlockSize = 32;
+inline constexpr int kMxScaleBias = 127;
+
+class MxVector {
+public:
+    MxVector() = default;
+
+    // Blocks restart at every row of `row_length` elements, so each row of a
+    // row-major matrix is a whole number of blocks (the last may be short).
+    // row_length 0 treats the input as a single row.
+    static MxVector encode(const P3109Layout& layout, std::span<const double> input, std::size_t row_length = 0);
+
+    // Re-encodes from doubles, reusing the existing allocation. Throws
+    // std::runtime_error unless minifloat_layout_valid(layout) and
+    // row_length divides the input.
+    void assign(const P3109Layout& layout, std::span<const double> input, std::size_t row_length = 0);
+
+    void decode(std::span<double> out) const;
+    std::vector<double> to_doubles() const;
+
+    // Element values without their block scale, as the block kernels consume
+    // them; element i is scaled by 2^scale_exponent(block_of(i)).
+    void decode_elements(std::span<float> out) const;
+
+    int scale_exponent(std::size_t block) const { return static_cast<int>(scales_[block]) - kMxScaleBias; }
+    std::size_t block_of(std::size_t i) const {
+        return (i / row_length_) * blocks_per_row() + (i % row_length_) / kMxBlockSize;
+    }
+
+    const P3109Layout& layout() const { return format_->layout; }
+    std::size_t size() const { return codes_.size(); }
+    bool empty() const { return codes_.empty(); }
+    std::size_t row_length() const { return row_length_; }
+    std::size_t rows() const { return row_length_ == 0 ? 0 : codes_.size() / row_length_; }
+    std::size_t blocks_per_row() const { return (row_length_ + kMxBlockSize - 1) / kMxBlockSize; }
+    std::size_t blocks() const { return scales_.size(); }
+    // Packed footprint: element bits rounded up to bytes, plus one scale byte
+    // per block.
+    std::size_t bytes() const { return empty() ? 0 : (codes_.size() * layout().width() + 7) / 8 + scales_.size(); }
+
+    std::span<const uint8_t> codes() const { return codes_; }
+    std::span<const uint8_t> scales() const { return scales_; }
+
+private:
+    void check_size(std::size_t n) const;
+
+    const MiniFloatFormat* format_ = nullptr;
+    std::size_t row_length_ = 0;
+    std::vector<uint8_t> codes_;
+    std::vector<uint8_t> scales_;
+};
+
+} // namespace fpstudy::formats
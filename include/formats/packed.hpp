@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "formats/precision.hpp"
+
+namespace fpstudy::formats {
+
+// Storage element of a PackedVector. FP64/FP32 store the IEEE value itself,
+// BF16/TF32 store the top 16/19 bits of the FP32 pattern, and P3109_8 and
+// the minifloat layouts store their P3109Number, which is exactly one code
+// byte.
+template <Precision P>
+struct PackedStorage;
+
+template <>
+struct PackedStorage<Precision::FP64> {
+    using type = double;
+};
+
+template <>
+struct PackedStorage<Precision::FP32> {
+    using type = float;
+};
+
+template <>
+struct PackedStorage<Precision::TF32> {
+    using type = uint32_t;
+    static constexpr int fraction_bits = 10;
+};
+
+template <>
+struct PackedStorage<Precision::BF16> {
+    using type = uint16_t;
+    static constexpr int fraction_bits = 7;
+};
+
+template <>
+struct PackedStorage<Precision::P3109_8> {
+    using type = P3109Number<>;
+};
+
+template <Precision P>
+    requires(is_minifloat_precision(P) || P == Precision::MiniFloatRuntime)
+struct PackedStorage<P> {
+    using type = typename PrecisionTraits<P>::type;
+};
+
+static_assert(sizeof(P3109Number<>) == 1 && std::is_trivially_copyable_v<P3109Number<>>,
+              "P3109Number must be a bare code byte for packed storage");
+
+namespace detail {
+
+// Rounds a double straight to an FP32 value with `F` fraction bits (ties to
+// even), the way TF32/BF16 convert from double: one rounding, overflow to
+// infinity, results below the normal range flushed to signed zero.
+template <int F>
+inline float round_double_to_fraction(double value) {
+    constexpr int drop = 52 - F;
+    uint64_t bits = std::bit_cast<uint64_t>(value);
+    const bool special = (bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull;
+    uint64_t rounded = bits + ((uint64_t(1) << (drop - 1)) - 1) + ((bits >> drop) & 1u);
+    rounded &= ~((uint64_t(1) << drop) - 1);
+    float result = static_cast<float>(std::bit_cast<double>(special ? bits : rounded));
+    const uint32_t out = std::bit_cast<uint32_t>(result);
+    const bool tiny = (out & 0x7F800000u) == 0;
+    return std::bit_cast<float>(tiny ? (out & 0x80000000u) : out);
+}
+
+template <Precision P>
+inline typename PackedStorage<P>::type encode_fast(double v) {
+    if constexpr (P == Precision::FP64) {
+        return v;
+    } else if constexpr (P == Precision::FP32) {
+        return static_cast<float>(v);
+    } else if constexpr (is_p3109_number_v<typename PackedStorage<P>::type>) {
+        return typename PackedStorage<P>::type(v);
+    } else {
+        using Code = typename PackedStorage<P>::type;
+        constexpr int F = PackedStorage<P>::fraction_bits;
+        return static_cast<Code>(std::bit_cast<uint32_t>(round_double_to_fraction<F>(v)) >> (23 - F));
+    }
+}
+
+template <Precision P>
+inline typename PackedStorage<P>::type encode_via_format(double v) {
+    if constexpr (P == Precision::TF32 || P == Precision::BF16) {
+        using T = typename PrecisionTraits<P>::type;
+        using Code = typename PackedStorage<P>::type;
+        constexpr int F = PackedStorage<P>::fraction_bits;
+        return static_cast<Code>(std::bit_cast<uint32_t>(static_cast<float>(T(v))) >> (23 - F));
+    } else {
+        return encode_fast<P>(v);
+    }
+}
+
+template <Precision P>
+inline float decode_code_float(typename PackedStorage<P>::type code) {
+    if constexpr (P == Precision::TF32 || P == Precision::BF16) {
+        return std::bit_cast<float>(static_cast<uint32_t>(code) << (23 - PackedStorage<P>::fraction_bits));
+    } else {
+        return static_cast<float>(code);
+    }
+}
+
+} // namespace detail
+
+// Checks the bit-level double -> code conversion against the format's own
+// conversion on a deterministic sample; encode() uses the bit path only when
+// this holds. Always true for formats that do not need it.
+template <Precision P>
+bool packed_encoding_verified() {
+    if constexpr (P == Precision::TF32 || P == Precision::BF16) {
+        static const bool verified = [] {
+            std::vector<double> samples = {0.0, -0.0, 1.0, -1.0, 1.0 / 3.0, 1e-30, -1e30, 1e39, 1e-40,
+                                           std::numeric_limits<double>::infinity()};
+            uint64_t state = 0x9E3779B97F4A7C15ull;
+            for (int i = 0; i < 4096; ++i) {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                int exponent = static_cast<int>((state >> 40) % 81) - 40;
+                double mantissa = 1.0 + static_cast<double>(state & 0xFFFFFFFFFFull) / 1099511627776.0;
+                double v = std::ldexp(mantissa, exponent);
+                samples.push_back((state >> 63) ? -v : v);
+            }
+            for (double v : samples) {
+                if (detail::encode_fast<P>(v) != detail::encode_via_format<P>(v)) {
+                    return false;
+                }
+            }
+            return true;
+        }();
+        return verified;
+    } else {
+        return true;
+    }
+}
+
+// Bulk conversions between format codes and other representations, on
+// caller-provided buffers of equal length. PackedVector uses the same
+// routines on its own storage.
+
+// Packs values that are already in the format.
+template <Precision P>
+void pack_values(std::span<const typename PrecisionTraits<P>::type> input,
+                 std::span<typename PackedStorage<P>::type> codes) {
+    using Code = typename PackedStorage<P>::type;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        if constexpr (std::is_same_v<typename PrecisionTraits<P>::type, Code>) {
+            codes[i] = input[i];
+        } else {
+            codes[i] = static_cast<Code>(
+                std::bit_cast<uint32_t>(static_cast<float>(input[i])) >> (23 - PackedStorage<P>::fraction_bits));
+        }
+    }
+}
+
+// Packs FP32 values, rounding each the way T(float) does. Emulated kernels
+// use this to store their float results without building T.
+template <Precision P>
+void pack_floats(std::span<const float> input, std::span<typename PackedStorage<P>::type> codes) {
+    using T = typename PrecisionTraits<P>::type;
+    using Code = typename PackedStorage<P>::type;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        if constexpr (P == Precision::TF32 || P == Precision::BF16) {
+            constexpr int F = PackedStorage<P>::fraction_bits;
+            if (fp32_emulation_verified<T>()) {
+                codes[i] = static_cast<Code>(std::bit_cast<uint32_t>(round_fraction<F>(input[i])) >> (23 - F));
+            } else {
+                codes[i] = static_cast<Code>(std::bit_cast<uint32_t>(static_cast<float>(T(input[i]))) >> (23 - F));
+            }
+        } else {
+            codes[i] = Code(input[i]);
+        }
+    }
+}
+
+template <Precision P>
+void decode_codes(std::span<const typename PackedStorage<P>::type> codes, std::span<double> out) {
+    if constexpr (P == Precision::FP64) {
+        std::copy(codes.begin(), codes.end(), out.begin());
+    } else {
+        for (std::size_t i = 0; i < codes.size(); ++i) {
+            out[i] = static_cast<double>(detail::decode_code_float<P>(codes[i]));
+        }
+    }
+}
+
+template <Precision P>
+void decode_codes_float(std::span<const typename PackedStorage<P>::type> codes, std::span<float> out) {
+    for (std::size_t i = 0; i < codes.size(); ++i) {
+        out[i] = detail::decode_code_float<P>(codes[i]);
+    }
+}
+
+// Materializes format objects for kernels that need them.
+template <Precision P>
+void decode_codes_values(std::span<const typename PackedStorage<P>::type> codes,
+                         std::span<typename PrecisionTraits<P>::type> out) {
+    using T = typename PrecisionTraits<P>::type;
+    for (std::size_t i = 0; i < codes.size(); ++i) {
+        if constexpr (std::is_same_v<T, typename PackedStorage<P>::type>) {
+            out[i] = codes[i];
+        } else {
+            out[i] = T(detail::decode_code_float<P>(codes[i]));
+        }
+    }
+}
+
+// Contiguous vector of raw format codes.
+//
+// Holding codes instead of double or cfloat objects keeps working sets small
+// (1 byte per P3109_8 element against 8 for the FP64 inputs) and lets bulk
+// conversions run as plain integer loops. `values()` exposes the storage as
+// std::span<const T> where the code already is the value type (FP64, FP32,
+// P3109_8); TF32/BF16 decode to FP32 with a shift via `decode_float()`.
+template <Precision P>
+class PackedVector {
+public:
+    using value_type = typename PrecisionTraits<P>::type;
+    using code_type = typename PackedStorage<P>::type;
+    static constexpr bool has_value_view = std::is_same_v<value_type, code_type>;
+
+    PackedVector() = default;
+    explicit PackedVector(std::size_t n) : codes_(n, code_type{}) {}
+
+    static PackedVector encode(std::span<const double> input) {
+        PackedVector out;
+        out.assign(input);
+        return out;
+    }
+
+    // Re-encodes from doubles, reusing the existing allocation.
+    void assign(std::span<const double> input) {
+        codes_.resize(input.size());
+        code_type* dst = codes_.data();
+        if (packed_encoding_verified<P>()) {
+            for (std::size_t i = 0; i < input.size(); ++i) {
+                dst[i] = detail::encode_fast<P>(input[i]);
+            }
+        } else {
+            for (std::size_t i = 0; i < input.size(); ++i) {
+                dst[i] = detail::encode_via_format<P>(input[i]);
+            }
+        }
+    }
+
+    // Packs values that are already in the format.
+    void assign_values(std::span<const value_type> input) {
+        codes_.resize(input.size());
+        pack_values<P>(input, codes());
+    }
+
+    // Packs FP32 values, rounding each the way T(float) does.
+    void assign_floats(std::span<const float> input) {
+        codes_.resize(input.size());
+        pack_floats<P>(input, codes());
+    }
+
+    void decode(std::span<double> out) const {
+        check_size(out.size());
+        decode_codes<P>(codes(), out);
+    }
+
+    void decode_float(std::span<float> out) const {
+        check_size(out.size());
+        decode_codes_float<P>(codes(), out);
+    }
+
+    std::vector<double> to_doubles() const {
+        std::vector<double> out(codes_.size());
+        decode(out);
+        return out;
+    }
+
+    // Materializes format objects for kernels that need them.
+    std::vector<value_type> to_values() const {
+        std::vector<value_type> out;
+        out.reserve(codes_.size());
+        for (const auto& code : codes_) {
+            if constexpr (has_value_view) {
+                out.push_back(code);
+            } else {
+                out.push_back(value_type(detail::decode_code_float<P>(code)));
+            }
+        }
+        return out;
+    }
+
+    std::span<const value_type> values() const requires has_value_view {
+        return {codes_.data(), codes_.size()};
+    }
+
+    std::span<const code_type> codes() const { return {codes_.data(), codes_.size()}; }
+    std::span<code_type> codes() { return {codes_.data(), codes_.size()}; }
+
+    value_type operator[](std::size_t i) const {
+        if constexpr (has_value_view) {
+            return codes_[i];
+        } else {
+            return value_type(detail::decode_code_float<P>(codes_[i]));
+        }
+    }
+
+    std::size_t size() const { return codes_.size(); }
+    bool empty() const { return codes_.empty(); }
+    std::size_t bytes() const { return codes_.size() * sizeof(code_type); }
+    void resize(std::size_t n) { codes_.resize(n, code_type{}); }
+    void clear() { codes_.clear(); }
+
+private:
+    void check_size(std::size_t n) const {
+        if (n != codes_.size()) {
+            throw std::runtime_error("PackedVector decode: output size mismatch");
+        }
+    }
+
+    std::vector<code_type> codes_;
+};
+
+} // namespace fpstudy::formats
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -9,105 +12,398 @@
 
 #include <universal/number/cfloat/cfloat.hpp>
 
+#include "formats/emulation.hpp"
 #include "formats/quantize.hpp"
 
 namespace fpstudy::formats {
 
-enum class Precision {
+// Named formats are the enumerators. A minifloat layout is the value
+// minifloat_precision(layout), which keeps its exponent bits, mantissa bits
+// and bias in the low bits, so "minifloat:e4m3:bias7" round-trips through a
+// Precision without a registry. MiniFloatRuntime is never parsed: it is the
+// dispatch tag for layouts without a compiled instantiation.
+enum class Precision : uint32_t {
     FP64,
     FP32,
     TF32,
     BF16,
-    P3109_8
+    P3109_8,
+    MiniFloatRuntime = 0xFF
 };
 
+inline constexpr uint32_t kMiniFloatPrecisionTag = 0x10000;
+
+constexpr Precision minifloat_precision(const P3109Layout& layout) {
+    return static_cast<Precision>(kMiniFloatPrecisionTag | (uint32_t(layout.exponent_bits) << 12) |
+                                  (uint32_t(layout.mantissa_bits) << 8) | uint8_t(layout.exponent_bias));
+}
+
+constexpr bool is_minifloat_precision(Precision p) {
+    return (static_cast<uint32_t>(p) & ~uint32_t(0xFFFF)) == kMiniFloatPrecisionTag;
+}
+
+constexpr P3109Layout minifloat_layout(Precision p) {
+    const uint32_t bits = static_cast<uint32_t>(p);
+    return {static_cast<uint8_t>((bits >> 12) & 0xF), static_cast<uint8_t>((bits >> 8) & 0xF),
+            static_cast<int8_t>(static_cast<uint8_t>(bits & 0xFF))};
+}
+
+// Block-scaled MX storage with a minifloat element layout (formats/mx.hpp),
+// named "mx:e<E>m<M>[:bias<B>]". Only the block kernels run these, so they
+// have no PrecisionTraits and are never dispatched.
+inline constexpr uint32_t kMxPrecisionTag = 0x20000;
+
+constexpr Precision mx_precision(const P3109Layout& element) {
+    return static_cast<Precision>((static_cast<uint32_t>(minifloat_precision(element)) & 0xFFFF) | kMxPrecisionTag);
+}
+
+constexpr bool is_mx_precision(Precision p) {
+    return (static_cast<uint32_t>(p) & ~uint32_t(0xFFFF)) == kMxPrecisionTag;
+}
+
+constexpr P3109Layout mx_element_layout(Precision p) {
+    return minifloat_layout(p);
+}
+
+// Layouts compiled into the dispatch table (see AllPrecisions): the OCP FP8
+// and FP6 shapes plus E3M4, which is the P3109_8 layout under its family name.
+inline constexpr Precision kMiniFloatE5M2 = minifloat_precision({5, 2, 15});
+inline constexpr Precision kMiniFloatE4M3 = minifloat_precision({4, 3, 7});
+inline constexpr Precision kMiniFloatE3M4 = minifloat_precision({3, 4, 3});
+inline constexpr Precision kMiniFloatE3M2 = minifloat_precision({3, 2, 3});
+inline constexpr Precision kMiniFloatE2M3 = minifloat_precision({2, 3, 1});
+
+// Names are fp64, fp32, tf32, bf16, p3109_8, minifloat:e<E>m<M>[:bias<B>]
+// and mx:e<E>m<M>[:bias<B>] (bias defaults to 2^(E-1) - 1); the layout must
+// satisfy minifloat_layout_valid.
 std::string precision_to_string(Precision p);
 Precision precision_from_string(std::string_view name);
 
 using TF32 = sw::universal::cfloat<19, 8, uint32_t>;
 using BF16 = sw::universal::cfloat<16, 8, uint16_t>;
 
+template <>
+struct Fp32Emulation<TF32> {
+    static constexpr bool enabled = true;
+    static constexpr int fraction_bits = 10;
+};
+
+template <>
+struct Fp32Emulation<BF16> {
+    static constexpr bool enabled = true;
+    static constexpr int fraction_bits = 7;
+};
+
+// Accumulation policies for P3109Number. The policy is part of the type, so
+// each instantiation compiles to branch-free operators and values with
+// different policies can be used side by side from any thread.
+//
+// AccumulateFp32 keeps the FP32 result of each operation until it is stored;
+// RoundEachOp rounds the FP32 result to the 8-bit grid first.
+struct AccumulateFp32 {
+    static constexpr bool accumulate_in_fp32 = true;
+
+    template <typename Codec>
+    static float finish(const Codec&, float value) {
+        return value;
+    }
+};
+
+struct RoundEachOp {
+    static constexpr bool accumulate_in_fp32 = false;
+
+    template <typename Codec>
+    static float finish(const Codec& codec, float value) {
+        return codec.decode(codec.encode(value));
+    }
+};
+
+// Result codes of the four binary operators for every pair of codes, indexed
+// by (lhs << 8) | rhs. Each operator stores codec.encode of the policy's
+// finished FP32 result, so the result is a function of the two codes alone
+// and one 64 KiB table per operator replaces the decode, float op and encode
+// round trip with identical codes. Layouts narrower than 8 bits use the
+// low corner of each table.
+template <typename AccumPolicy>
+struct MiniFloatOpTables {
+    static constexpr std::size_t index(uint8_t lhs, uint8_t rhs) {
+        return (static_cast<std::size_t>(lhs) << 8) | rhs;
+    }
+
+    template <typename Codec>
+    explicit MiniFloatOpTables(const Codec& codec) {
+        const int codes = 1 << codec.layout.width();
+        for (int lhs = 0; lhs < codes; ++lhs) {
+            const float a = codec.decode(static_cast<uint8_t>(lhs));
+            for (int rhs = 0; rhs < codes; ++rhs) {
+                const float b = codec.decode(static_cast<uint8_t>(rhs));
+                const std::size_t i = index(static_cast<uint8_t>(lhs), static_cast<uint8_t>(rhs));
+                add[i] = codec.encode(AccumPolicy::finish(codec, a + b));
+                sub[i] = codec.encode(AccumPolicy::finish(codec, a - b));
+                mul[i] = codec.encode(AccumPolicy::finish(codec, a * b));
+                div[i] = codec.encode(AccumPolicy::finish(codec, a / b));
+            }
+        }
+    }
+
+    std::array<uint8_t, 65536> add{};
+    std::array<uint8_t, 65536> sub{};
+    std::array<uint8_t, 65536> mul{};
+    std::array<uint8_t, 65536> div{};
+};
+
+// The tables of a compiled layout, built on first use, in about a
+// millisecond, and shared by every thread.
+template <typename AccumPolicy, typename Codec = P3109Codec<>>
+struct P3109OpTables : MiniFloatOpTables<AccumPolicy> {
+    static const P3109OpTables& get() {
+        static const P3109OpTables tables;
+        return tables;
+    }
+
+    P3109OpTables() : MiniFloatOpTables<AccumPolicy>(Codec{}) {}
+};
+
+// Exhaustive check of a policy's tables: all operand pairs of each operator
+// against the frexp/ldexp reference helpers p3109_quantize and
+// p3109_dequantize. Returns the number of differing entries; NaN results
+// share one code, so 0 means every operator is exact.
+template <typename AccumPolicy, P3109Layout Layout = P3109Layout{}>
+std::size_t p3109_op_table_mismatches() {
+    using Tables = P3109OpTables<AccumPolicy, P3109Codec<Layout>>;
+    const auto& tables = Tables::get();
+    auto reference = [](float value) {
+        if constexpr (!AccumPolicy::accumulate_in_fp32) {
+            value = p3109_dequantize(p3109_quantize(value, Layout), Layout);
+        }
+        return p3109_quantize(value, Layout);
+    };
+    const int codes = 1 << Layout.width();
+    std::size_t mismatches = 0;
+    for (int lhs = 0; lhs < codes; ++lhs) {
+        const float a = p3109_dequantize(static_cast<uint8_t>(lhs), Layout);
+        for (int rhs = 0; rhs < codes; ++rhs) {
+            const float b = p3109_dequantize(static_cast<uint8_t>(rhs), Layout);
+            const std::size_t i = Tables::index(static_cast<uint8_t>(lhs), static_cast<uint8_t>(rhs));
+            mismatches += (tables.add[i] != reference(a + b)) + (tables.sub[i] != reference(a - b)) +
+                          (tables.mul[i] != reference(a * b)) + (tables.div[i] != reference(a / b));
+        }
+    }
+    return mismatches;
+}
+
+// Codec and operator tables of a layout chosen at run time. Formats are built
+// once per layout, on first get(), and live for the rest of the process, so
+// references stay valid from any thread.
+class MiniFloatFormat {
+public:
+    // Throws std::runtime_error unless minifloat_layout_valid(layout).
+    static const MiniFloatFormat& get(const P3109Layout& layout);
+
+    MiniFloatFormat(const MiniFloatFormat&) = delete;
+    MiniFloatFormat& operator=(const MiniFloatFormat&) = delete;
+
+    float decode(uint8_t code) const { return decode_table_[code]; }
+    uint8_t encode(float value) const { return detail::minifloat_encode(value, layout); }
+
+    template <typename AccumPolicy>
+    const MiniFloatOpTables<AccumPolicy>& tables() const {
+        if constexpr (AccumPolicy::accumulate_in_fp32) {
+            return accumulate_fp32_;
+        } else {
+            return round_each_op_;
+        }
+    }
+
+    const P3109Layout layout;
+
+private:
+    explicit MiniFloatFormat(const P3109Layout& format_layout);
+
+    std::array<float, 256> decode_table_;
+    MiniFloatOpTables<AccumulateFp32> accumulate_fp32_;
+    MiniFloatOpTables<RoundEachOp> round_each_op_;
+};
+
+namespace detail {
+
+inline thread_local const MiniFloatFormat* active_minifloat = nullptr;
+
+} // namespace detail
+
+// Makes `format` the layout of every MiniFloatRuntime value on the calling
+// thread until the scope ends. dispatch_precision opens one around each call
+// it routes to the runtime instantiation.
+class MiniFloatScope {
+public:
+    explicit MiniFloatScope(const MiniFloatFormat& format) : previous_(detail::active_minifloat) {
+        detail::active_minifloat = &format;
+    }
+    ~MiniFloatScope() { detail::active_minifloat = previous_; }
+
+    MiniFloatScope(const MiniFloatScope&) = delete;
+    MiniFloatScope& operator=(const MiniFloatScope&) = delete;
+
+private:
+    const MiniFloatFormat* previous_;
+};
+
+// Throws std::runtime_error outside a MiniFloatScope.
+const MiniFloatFormat& active_minifloat_format();
+
+// Codec of the calling thread's active runtime layout. Conversions check for
+// a scope; decoding, on the hot path of every kernel, does not.
+struct ActiveMiniFloatCodec {
+    static float decode(uint8_t code) { return detail::active_minifloat->decode(code); }
+    static uint8_t encode(float value) { return active_minifloat_format().encode(value); }
+};
+
+// Layout parameter of P3109Number for the runtime layout of MiniFloatScope.
+inline constexpr P3109Layout kRuntimeMiniFloatLayout{0, 0, 0};
+
+template <typename AccumPolicy = AccumulateFp32, P3109Layout Layout = P3109Layout{}>
 class P3109Number {
 public:
+    static constexpr bool runtime_layout = Layout == kRuntimeMiniFloatLayout;
+    using Codec = std::conditional_t<runtime_layout, ActiveMiniFloatCodec, P3109Codec<Layout>>;
+    using policy = AccumPolicy;
+
+    static const MiniFloatOpTables<AccumPolicy>& tables() {
+        if constexpr (runtime_layout) {
+            return detail::active_minifloat->template tables<AccumPolicy>();
+        } else {
+            return P3109OpTables<AccumPolicy, Codec>::get();
+        }
+    }
+
     P3109Number() = default;
-    P3109Number(float v) { value_ = p3109_quantize(v); }
-    P3109Number(double v) { value_ = p3109_quantize(static_cast<float>(v)); }
-    P3109Number(int v) { value_ = p3109_quantize(static_cast<float>(v)); }
+    P3109Number(float v) { value_ = Codec::encode(v); }
+    P3109Number(double v) { value_ = Codec::encode(static_cast<float>(v)); }
+    P3109Number(int v) { value_ = Codec::encode(static_cast<float>(v)); }
 
     explicit P3109Number(uint8_t raw) : value_(raw) {}
 
-    operator float() const { return p3109_dequantize(value_); }
-    operator double() const { return static_cast<double>(p3109_dequantize(value_)); }
+    // Same code under another policy.
+    template <typename OtherPolicy>
+    explicit P3109Number(const P3109Number<OtherPolicy, Layout>& other) : value_(other.raw()) {}
+
+    operator float() const { return Codec::decode(value_); }
+    operator double() const { return static_cast<double>(Codec::decode(value_)); }
 
     P3109Number& operator+=(const P3109Number& other) {
-        float lhs = p3109_dequantize(value_);
-        float rhs = p3109_dequantize(other.value_);
-        float res = accumulate_in_fp32_ ? lhs + rhs : p3109_dequantize(p3109_quantize(lhs + rhs));
-        value_ = p3109_quantize(res);
+        value_ = tables().add[MiniFloatOpTables<AccumPolicy>::index(value_, other.value_)];
         return *this;
     }
 
     P3109Number& operator-=(const P3109Number& other) {
-        float lhs = p3109_dequantize(value_);
-        float rhs = p3109_dequantize(other.value_);
-        float res = accumulate_in_fp32_ ? lhs - rhs : p3109_dequantize(p3109_quantize(lhs - rhs));
-        value_ = p3109_quantize(res);
+        value_ = tables().sub[MiniFloatOpTables<AccumPolicy>::index(value_, other.value_)];
         return *this;
     }
 
     P3109Number& operator*=(const P3109Number& other) {
-        float lhs = p3109_dequantize(value_);
-        float rhs = p3109_dequantize(other.value_);
-        float res = accumulate_in_fp32_ ? lhs * rhs : p3109_dequantize(p3109_quantize(lhs * rhs));
-        value_ = p3109_quantize(res);
+        value_ = tables().mul[MiniFloatOpTables<AccumPolicy>::index(value_, other.value_)];
         return *this;
     }
 
     P3109Number& operator/=(const P3109Number& other) {
-        float lhs = p3109_dequantize(value_);
-        float rhs = p3109_dequantize(other.value_);
-        float res = accumulate_in_fp32_ ? lhs / rhs : p3109_dequantize(p3109_quantize(lhs / rhs));
-        value_ = p3109_quantize(res);
+        value_ = tables().div[MiniFloatOpTables<AccumPolicy>::index(value_, other.value_)];
         return *this;
     }
 
     P3109Number operator-() const {
         P3109Number tmp(*this);
-        float val = -p3109_dequantize(value_);
-        tmp.value_ = p3109_quantize(val);
+        float val = -Codec::decode(value_);
+        tmp.value_ = Codec::encode(val);
         return tmp;
     }
 
     [[nodiscard]] uint8_t raw() const { return value_; }
 
-    static void set_accumulate_fp32(bool flag) { accumulate_in_fp32_ = flag; }
-    static bool accumulate_fp32() { return accumulate_in_fp32_; }
+    static constexpr bool accumulate_fp32() { return AccumPolicy::accumulate_in_fp32; }
 
 private:
     uint8_t value_ = 0;
-    inline static bool accumulate_in_fp32_ = true;
 };
 
-inline P3109Number operator+(P3109Number lhs, const P3109Number& rhs) {
+template <typename AccumPolicy, P3109Layout Layout>
+inline P3109Number<AccumPolicy, Layout> operator+(P3109Number<AccumPolicy, Layout> lhs,
+                                                  const P3109Number<AccumPolicy, Layout>& rhs) {
     lhs += rhs;
     return lhs;
 }
 
-inline P3109Number operator-(P3109Number lhs, const P3109Number& rhs) {
+template <typename AccumPolicy, P3109Layout Layout>
+inline P3109Number<AccumPolicy, Layout> operator-(P3109Number<AccumPolicy, Layout> lhs,
+                                                  const P3109Number<AccumPolicy, Layout>& rhs) {
     lhs -= rhs;
     return lhs;
 }
 
-inline P3109Number operator*(P3109Number lhs, const P3109Number& rhs) {
+template <typename AccumPolicy, P3109Layout Layout>
+inline P3109Number<AccumPolicy, Layout> operator*(P3109Number<AccumPolicy, Layout> lhs,
+                                                  const P3109Number<AccumPolicy, Layout>& rhs) {
     lhs *= rhs;
     return lhs;
 }
 
-inline P3109Number operator/(P3109Number lhs, const P3109Number& rhs) {
+template <typename AccumPolicy, P3109Layout Layout>
+inline P3109Number<AccumPolicy, Layout> operator/(P3109Number<AccumPolicy, Layout> lhs,
+                                                  const P3109Number<AccumPolicy, Layout>& rhs) {
     lhs /= rhs;
     return lhs;
 }
 
+template <typename T>
+struct is_p3109_number : std::false_type {};
+
+template <typename AccumPolicy, P3109Layout Layout>
+struct is_p3109_number<P3109Number<AccumPolicy, Layout>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_p3109_number_v = is_p3109_number<T>::value;
+
+// The minifloat family: P3109Number on any compiled layout. E4M3 with bias 7
+// is MiniFloat<4, 3, 7>; MiniFloat<3, 4, 3> is P3109Number<> itself.
+template <int E, int M, int Bias, typename AccumPolicy = AccumulateFp32>
+using MiniFloat = P3109Number<AccumPolicy, P3109Layout{E, M, Bias}>;
+
+// P3109Number on the calling thread's MiniFloatScope layout.
+template <typename AccumPolicy = AccumulateFp32>
+using RuntimeMiniFloat = P3109Number<AccumPolicy, kRuntimeMiniFloatLayout>;
+
+// The same layout under another accumulation policy.
+template <typename T, typename Policy>
+struct rebind_policy_type;
+
+template <typename FromPolicy, P3109Layout Layout, typename Policy>
+struct rebind_policy_type<P3109Number<FromPolicy, Layout>, Policy> {
+    using type = P3109Number<Policy, Layout>;
+};
+
+template <typename T, typename Policy>
+using rebind_policy_t = typename rebind_policy_type<T, Policy>::type;
+
+// Calls fn(AccumulateFp32{}) or fn(RoundEachOp{}) for a runtime flag, so a
+// caller picks the P3109Number instantiation once per run.
+template <typename Fn>
+decltype(auto) dispatch_accumulation(bool accumulate_in_fp32, Fn&& fn) {
+    if (accumulate_in_fp32) {
+        return fn(AccumulateFp32{});
+    }
+    return fn(RoundEachOp{});
+}
+
+// Copies P3109 codes into another policy's number type.
+template <typename ToPolicy, typename FromPolicy, P3109Layout Layout>
+std::vector<P3109Number<ToPolicy, Layout>> rebind_policy(std::span<const P3109Number<FromPolicy, Layout>> input) {
+    std::vector<P3109Number<ToPolicy, Layout>> output;
+    output.reserve(input.size());
+    for (const auto& v : input) {
+        output.emplace_back(v);
+    }
+    return output;
+}
+
 template <Precision P>
 struct PrecisionTraits;
 
@@ -133,9 +429,26 @@ struct PrecisionTraits<Precision::BF16> {
 
 template <>
 struct PrecisionTraits<Precision::P3109_8> {
-    using type = P3109Number;
+    using type = P3109Number<>;
+};
+
+template <Precision P>
+    requires(is_minifloat_precision(P))
+struct PrecisionTraits<P> {
+    using type = P3109Number<AccumulateFp32, minifloat_layout(P)>;
 };
 
+template <>
+struct PrecisionTraits<Precision::MiniFloatRuntime> {
+    using type = RuntimeMiniFloat<>;
+};
+
+// The precision a row reports: the active layout for MiniFloatRuntime, p
+// itself otherwise.
+inline Precision resolve_precision(Precision p) {
+    return p == Precision::MiniFloatRuntime ? minifloat_precision(active_minifloat_format().layout) : p;
+}
+
 std::vector<Precision> all_precisions();
 
 template <typename T>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <cmath>
 #include <limits>
@@ -13,21 +15,53 @@ struct P3109Layout {
     uint8_t exponent_bits = 3;
     uint8_t mantissa_bits = 4;
     int8_t exponent_bias = 3;
+
+    constexpr int width() const { return 1 + exponent_bits + mantissa_bits; }
+
+    friend constexpr bool operator==(const P3109Layout&, const P3109Layout&) = default;
+};
+
+// Every layout follows the P3109_8 conventions scaled to its width N: the
+// top code (all ones) is NaN, all ones below the sign bit is +inf and the top
+// code minus one is -inf; the largest exponent field is reserved, finite
+// values saturate, results below the smallest normal flush to signed zero and
+// rounding is half away from zero. For N = 8 the special codes are 0xFF,
+// 0x7F and 0xFE.
+struct MiniFloatCodes {
+    uint8_t sign;
+    uint8_t nan;
+    uint8_t pos_inf;
+    uint8_t neg_inf;
 };
 
+constexpr MiniFloatCodes minifloat_codes(const P3109Layout& layout) {
+    const int width = layout.width();
+    return {static_cast<uint8_t>(1u << (width - 1)), static_cast<uint8_t>((1u << width) - 1),
+            static_cast<uint8_t>((1u << (width - 1)) - 1), static_cast<uint8_t>((1u << width) - 2)};
+}
+
+// Whether the layout fits one code byte and its values map onto normal
+// floats, which every codec below assumes.
+constexpr bool minifloat_layout_valid(const P3109Layout& layout) {
+    return layout.exponent_bits >= 2 && layout.mantissa_bits >= 1 && layout.width() <= 8 &&
+           (1 << layout.exponent_bits) - 1 - layout.exponent_bias + 127 < 255 && 1 - layout.exponent_bias + 127 > 0;
+}
+
 inline uint8_t p3109_quantize(float value,
                               const P3109Layout& layout = P3109Layout{}) {
+    const auto codes = minifloat_codes(layout);
     if (std::isnan(value)) {
-        return 0xFF;
+        return codes.nan;
     }
     if (std::isinf(value)) {
-        return (value > 0.f) ? 0x7F : 0xFE;
+        return (value > 0.f) ? codes.pos_inf : codes.neg_inf;
     }
 
     const float sign = std::signbit(value) ? -1.f : 1.f;
+    const uint8_t sign_bit = sign < 0 ? codes.sign : 0x00;
     float abs_v = std::fabs(value);
     if (abs_v == 0.0f) {
-        return std::signbit(value) ? 0x80 : 0x00;
+        return sign_bit;
     }
 
     int exp;
@@ -39,11 +73,11 @@ inline uint8_t p3109_quantize(float value,
     const int min_exp = 1;
 
     if (exp_val > max_exp) {
-        return (sign < 0 ? 0x80 : 0x00) | ((max_exp + 1) << layout.mantissa_bits) - 1;
+        return sign_bit | (((max_exp + 1) << layout.mantissa_bits) - 1);
     }
     if (exp_val < min_exp) {
         // flush to zero
-        return std::signbit(value) ? 0x80 : 0x00;
+        return sign_bit;
     }
 
     const int mantissa_mask = (1 << layout.mantissa_bits) - 1;
@@ -53,28 +87,28 @@ inline uint8_t p3109_quantize(float value,
         mantissa = 0;
         ++exp_val;
         if (exp_val > max_exp) {
-            return (sign < 0 ? 0x80 : 0x00) | ((max_exp + 1) << layout.mantissa_bits) - 1;
+            return sign_bit | (((max_exp + 1) << layout.mantissa_bits) - 1);
         }
     }
 
-    uint8_t sign_bit = sign < 0 ? 0x80 : 0x00;
     uint8_t exponent_field = static_cast<uint8_t>(exp_val << layout.mantissa_bits);
     return static_cast<uint8_t>(sign_bit | exponent_field | mantissa);
 }
 
 inline float p3109_dequantize(uint8_t code,
                               const P3109Layout& layout = P3109Layout{}) {
-    if (code == 0xFF) { // NaN
+    const auto codes = minifloat_codes(layout);
+    if (code == codes.nan) {
         return std::numeric_limits<float>::quiet_NaN();
     }
-    if (code == 0x7F) {
+    if (code == codes.pos_inf) {
         return std::numeric_limits<float>::infinity();
     }
-    if (code == 0xFE) {
+    if (code == codes.neg_inf) {
         return -std::numeric_limits<float>::infinity();
     }
 
-    const bool negative = (code & 0x80) != 0;
+    const bool negative = (code & codes.sign) != 0;
     const int mantissa_mask = (1 << layout.mantissa_bits) - 1;
     const int exponent_mask = (1 << layout.exponent_bits) - 1;
     int exponent = (code >> layout.mantissa_bits) & exponent_mask;
@@ -90,6 +124,112 @@ inline float p3109_dequantize(uint8_t code,
     return negative ? -value : value;
 }
 
+namespace detail {
+
+// Bit-level decode and encode of one code under `layout`, without frexp,
+// ldexp or round. They give exactly the codes and values of p3109_quantize /
+// p3109_dequantize; with a constant layout they fold to the fixed codec.
+constexpr float minifloat_decode(uint8_t code, const P3109Layout& layout) {
+    const auto codes = minifloat_codes(layout);
+    if (code == codes.nan) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    if (code == codes.pos_inf) {
+        return std::numeric_limits<float>::infinity();
+    }
+    if (code == codes.neg_inf) {
+        return -std::numeric_limits<float>::infinity();
+    }
+    const int mantissa_bits = layout.mantissa_bits;
+    const uint32_t sign = (code & codes.sign) ? 0x80000000u : 0u;
+    const int exponent = (code >> mantissa_bits) & ((1 << layout.exponent_bits) - 1);
+    const uint32_t mantissa = code & ((1u << mantissa_bits) - 1);
+    if (exponent == 0) {
+        return std::bit_cast<float>(sign);
+    }
+    // (1 + m / 2^M) * 2^(e - bias) is exactly representable, so build the bits.
+    const uint32_t biased = static_cast<uint32_t>(exponent - layout.exponent_bias + 127);
+    return std::bit_cast<float>(sign | (biased << 23) | (mantissa << (23 - mantissa_bits)));
+}
+
+constexpr uint8_t minifloat_encode(float value, const P3109Layout& layout) {
+    const auto codes = minifloat_codes(layout);
+    const int mantissa_bits = layout.mantissa_bits;
+    const int drop_bits = 23 - mantissa_bits;
+    const int max_exp = (1 << layout.exponent_bits) - 2; // reserve top for inf/nan
+    const int min_exp = 1;
+    const int mantissa_mask = (1 << mantissa_bits) - 1;
+    const uint8_t saturated = static_cast<uint8_t>(((max_exp + 1) << mantissa_bits) - 1);
+
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint8_t sign_bit = (bits >> 31) ? codes.sign : 0x00;
+    const uint32_t abs_bits = bits & 0x7FFFFFFFu;
+    if (abs_bits > 0x7F800000u) {
+        return codes.nan;
+    }
+    if (abs_bits == 0x7F800000u) {
+        return sign_bit ? codes.neg_inf : codes.pos_inf;
+    }
+
+    // Zeros and float subnormals land below min_exp and flush to signed zero,
+    // as they do through frexp in the reference path.
+    int exp_val = static_cast<int>(abs_bits >> 23) - 127 + layout.exponent_bias;
+    if (exp_val > max_exp) {
+        return static_cast<uint8_t>(sign_bit | saturated);
+    }
+    if (exp_val < min_exp) {
+        return sign_bit;
+    }
+
+    // Round half away from zero on the dropped fraction bits (std::round).
+    const uint32_t fraction = abs_bits & 0x007FFFFFu;
+    int mantissa = static_cast<int>((fraction + (1u << (drop_bits - 1))) >> drop_bits);
+    if (mantissa > mantissa_mask) {
+        mantissa = 0;
+        ++exp_val;
+        if (exp_val > max_exp) {
+            return static_cast<uint8_t>(sign_bit | saturated);
+        }
+    }
+    return static_cast<uint8_t>(sign_bit | (exp_val << mantissa_bits) | mantissa);
+}
+
+} // namespace detail
+
+// Compile-time codec for a fixed layout. Decoding is a lookup into a 256-entry
+// table and encoding works directly on the IEEE-754 bits of the float, so no
+// frexp/ldexp/round calls are made. Both produce exactly the same codes and
+// values as p3109_quantize / p3109_dequantize for the same layout.
+template <P3109Layout Layout = P3109Layout{}>
+struct P3109Codec {
+    static constexpr P3109Layout layout = Layout;
+    static constexpr int exponent_bits = Layout.exponent_bits;
+    static constexpr int mantissa_bits = Layout.mantissa_bits;
+    static constexpr int exponent_bias = Layout.exponent_bias;
+
+    static_assert(Layout.width() <= 8, "P3109 layouts must fit in an 8-bit code");
+    static_assert(exponent_bits >= 2, "Exponent needs a normal range below the reserved field");
+    static_assert(mantissa_bits >= 1 && mantissa_bits < 23, "Mantissa must fit inside a float fraction");
+    static_assert((1 << exponent_bits) - 1 - exponent_bias + 127 < 255 && 1 - exponent_bias + 127 > 0,
+                  "Exponent range must map onto normal floats");
+
+    static constexpr float decode_code(uint8_t code) { return detail::minifloat_decode(code, Layout); }
+
+    static constexpr std::array<float, 256> make_decode_table() {
+        std::array<float, 256> table{};
+        for (int code = 0; code < 256; ++code) {
+            table[code] = decode_code(static_cast<uint8_t>(code));
+        }
+        return table;
+    }
+
+    static constexpr std::array<float, 256> decode_table = make_decode_table();
+
+    static constexpr float decode(uint8_t code) { return decode_table[code]; }
+
+    static constexpr uint8_t encode(float value) { return detail::minifloat_encode(value, Layout); }
+};
+
 template <typename T>
 inline bool is_special(T value) {
     if constexpr (std::is_floating_point_v<T>) {
@@ -0,0 +1,39 @@
+#include "core/arena.hpp"
+
+#include <new>
+
+namespace fpstudy::core {
+
+void* Arena::Overflow::do_allocate(std::size_t size, std::size_t alignment) {
+    bytes += size;
+    return ::operator new(size, std::align_val_t(alignment));
+}
+
+void Arena::Overflow::do_deallocate(void* p, std::size_t size, std::size_t alignment) {
+    ::operator delete(p, size, std::align_val_t(alignment));
+}
+
+Arena::Arena(std::size_t initial_bytes)
+    : block_(std::make_unique_for_overwrite<std::byte[]>(initial_bytes)), block_bytes_(initial_bytes) {
+    resource_.emplace(block_.get(), block_bytes_, &overflow_);
+}
+
+void Arena::reset() {
+    resource_->release();
+    if (overflow_.bytes > 0) {
+        // The monotonic resource grows its chunks geometrically, so the
+        // overflow total bounds what the busiest cell actually needed.
+        block_bytes_ += overflow_.bytes;
+        overflow_.bytes = 0;
+        resource_.reset();
+        block_ = std::make_unique_for_overwrite<std::byte[]>(block_bytes_);
+        resource_.emplace(block_.get(), block_bytes_, &overflow_);
+    }
+}
+
+Arena& worker_arena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+} // namespace fpstudy::core
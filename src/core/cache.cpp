@@ -0,0 +1,305 @@
+#include "core/cache.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FPSTUDY_HAVE_MMAP 1
+#endif
+
+namespace fpstudy::core {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'P', 'S', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kFormatVersion = 1;
+
+// Bumped whenever the data generators change, so stale entries stop matching.
+constexpr std::string_view kKeyPrefix = "fpstudy-cache-v1;";
+
+std::size_t padded(std::size_t n) {
+    return (n + 7) & ~std::size_t(7);
+}
+
+char hex_digit(unsigned v) {
+    return static_cast<char>(v < 10 ? '0' + v : 'a' + (v - 10));
+}
+
+std::string hex64(uint64_t value) {
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        out[static_cast<std::size_t>(i)] = hex_digit(static_cast<unsigned>(value & 0xF));
+        value >>= 4;
+    }
+    return out;
+}
+
+// Bounds-checked reader over a loaded entry.
+class Cursor {
+public:
+    Cursor(const std::byte* data, std::size_t size) : data_(data), size_(size) {}
+
+    bool read(void* out, std::size_t n) {
+        if (n > size_ - offset_) return false;
+        std::memcpy(out, data_ + offset_, n);
+        offset_ += n;
+        return true;
+    }
+
+    bool skip_to_alignment() {
+        std::size_t next = padded(offset_);
+        if (next > size_) return false;
+        offset_ = next;
+        return true;
+    }
+
+    const std::byte* take(std::size_t n) {
+        if (n > size_ - offset_) return nullptr;
+        const std::byte* p = data_ + offset_;
+        offset_ += n;
+        return p;
+    }
+
+private:
+    const std::byte* data_;
+    std::size_t size_;
+    std::size_t offset_ = 0;
+};
+
+template <typename U>
+void append_pod(std::string& out, U value) {
+    char bytes[sizeof(U)];
+    std::memcpy(bytes, &value, sizeof(U));
+    out.append(bytes, sizeof(U));
+}
+
+void append_padded(std::string& out, std::string_view text) {
+    append_pod<uint64_t>(out, text.size());
+    out.append(text);
+    out.append(padded(out.size()) - out.size(), '\0');
+}
+
+} // namespace
+
+std::shared_ptr<const void> map_file(const std::filesystem::path& path, std::size_t& size) {
+#ifdef FPSTUDY_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = static_cast<std::size_t>(st.st_size);
+            void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (addr != MAP_FAILED) {
+                return std::shared_ptr<const void>(addr, [size](const void* p) {
+                    ::munmap(const_cast<void*>(p), size);
+                });
+            }
+        } else {
+            ::close(fd);
+        }
+    }
+#endif
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+    in.seekg(0, std::ios::end);
+    auto length = in.tellg();
+    if (length <= 0) {
+        return nullptr;
+    }
+    size = static_cast<std::size_t>(length);
+    auto buffer = std::make_shared<std::vector<uint64_t>>((size + 7) / 8);
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer->data()), static_cast<std::streamsize>(size));
+    if (!in) {
+        return nullptr;
+    }
+    return std::shared_ptr<const void>(buffer, buffer->data());
+}
+
+uint64_t fnv1a_64(std::string_view bytes) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+CacheKey::CacheKey(std::string_view kind) : canonical_(kKeyPrefix) {
+    add_string("kind", kind);
+}
+
+CacheKey& CacheKey::add_string(std::string_view name, std::string_view value) {
+    canonical_.append(name);
+    canonical_.push_back('=');
+    canonical_.append(value);
+    canonical_.push_back(';');
+    return *this;
+}
+
+CacheKey& CacheKey::add_int(std::string_view name, int64_t value) {
+    return add_string(name, std::to_string(value));
+}
+
+CacheKey& CacheKey::add_number(std::string_view name, double value) {
+    // Exact bit pattern, so keys never depend on decimal formatting.
+    return add_string(name, "0x" + hex64(std::bit_cast<uint64_t>(value)));
+}
+
+CacheKey& CacheKey::add_bool(std::string_view name, bool value) {
+    return add_string(name, value ? "1" : "0");
+}
+
+uint64_t CacheKey::hash() const {
+    return fnv1a_64(canonical_);
+}
+
+std::string CacheKey::file_name() const {
+    return hex64(hash()) + ".fpc";
+}
+
+void CacheRecord::put(std::string name, std::span<const double> values) {
+    auto& copy = owned_.emplace_back(values.begin(), values.end());
+    arrays_.emplace_back(std::move(name), std::span<const double>(copy));
+}
+
+void CacheRecord::put_scalar(std::string name, double value) {
+    put(std::move(name), std::span<const double>(&value, 1));
+}
+
+std::optional<std::span<const double>> CacheRecord::get(std::string_view name) const {
+    for (const auto& [entry_name, values] : arrays_) {
+        if (entry_name == name) {
+            return values;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<double> CacheRecord::vector(std::string_view name) const {
+    auto values = get(name);
+    if (!values) {
+        throw std::runtime_error("Cache record has no array: " + std::string(name));
+    }
+    return {values->begin(), values->end()};
+}
+
+double CacheRecord::scalar(std::string_view name) const {
+    auto values = get(name);
+    if (!values || values->size() != 1) {
+        throw std::runtime_error("Cache record has no scalar: " + std::string(name));
+    }
+    return values->front();
+}
+
+TruthCache::TruthCache(std::filesystem::path directory) : directory_(std::move(directory)) {
+    if (!directory_.empty()) {
+        std::filesystem::create_directories(directory_);
+    }
+}
+
+std::filesystem::path TruthCache::path_for(const CacheKey& key) const {
+    return directory_ / key.file_name();
+}
+
+std::optional<CacheRecord> TruthCache::load(const CacheKey& key) const {
+    if (!enabled()) {
+        return std::nullopt;
+    }
+    std::size_t size = 0;
+    auto storage = map_file(path_for(key), size);
+    if (!storage) {
+        return std::nullopt;
+    }
+    Cursor cursor(static_cast<const std::byte*>(storage.get()), size);
+
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    uint64_t key_length = 0;
+    if (!cursor.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(magic)) != 0 ||
+        !cursor.read(&version, sizeof(version)) || version != kFormatVersion ||
+        !cursor.read(&count, sizeof(count)) || !cursor.read(&key_length, sizeof(key_length))) {
+        return std::nullopt;
+    }
+    const std::byte* key_text = cursor.take(key_length);
+    if (!key_text || key.canonical() != std::string_view(reinterpret_cast<const char*>(key_text), key_length) ||
+        !cursor.skip_to_alignment()) {
+        return std::nullopt;
+    }
+
+    CacheRecord record;
+    record.storage_ = storage;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t name_length = 0;
+        if (!cursor.read(&name_length, sizeof(name_length))) return std::nullopt;
+        const std::byte* name = cursor.take(name_length);
+        uint64_t values = 0;
+        if (!name || !cursor.skip_to_alignment() || !cursor.read(&values, sizeof(values)) ||
+            values > size / sizeof(double)) {
+            return std::nullopt;
+        }
+        const std::byte* data = cursor.take(values * sizeof(double));
+        if (!data) return std::nullopt;
+        record.arrays_.emplace_back(std::string(reinterpret_cast<const char*>(name), name_length),
+                                    std::span<const double>(reinterpret_cast<const double*>(data), values));
+    }
+    return record;
+}
+
+bool TruthCache::store(const CacheKey& key, const CacheRecord& record) const {
+    if (!enabled()) {
+        return false;
+    }
+    std::string bytes;
+    bytes.append(kMagic, sizeof(kMagic));
+    append_pod<uint32_t>(bytes, kFormatVersion);
+    append_pod<uint32_t>(bytes, static_cast<uint32_t>(record.arrays_.size()));
+    append_padded(bytes, key.canonical());
+    for (const auto& [name, values] : record.arrays_) {
+        append_padded(bytes, name);
+        append_pod<uint64_t>(bytes, values.size());
+        bytes.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+    }
+
+    // Unique per process (salt) and per call (sequence).
+    static const uint32_t salt = std::random_device{}();
+    static std::atomic<uint64_t> sequence{0};
+    const auto target = path_for(key);
+    auto temp = target;
+    temp += ".tmp" + std::to_string(salt) + "-" + std::to_string(sequence.fetch_add(1));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace fpstudy::core
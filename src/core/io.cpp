@@ -3,29 +3,27 @@
 #include <charconv>
 #include <cctype>
 #include <filesystem>
-#include <sstream>
+#include <fstream>
 #include <stdexcept>
 
 namespace fpstudy::core {
 
 namespace {
 
-std::string escape_csv_field(std::string_view value) {
-    bool needs_quotes = value.find_first_of(",\"\n\r") != std::string_view::npos;
-    if (!needs_quotes) {
-        return std::string(value);
-    }
-    std::string quoted;
-    quoted.reserve(value.size() + 2);
-    quoted.push_back('"');
-    for (char c : value) {
-        if (c == '"') {
-            quoted.push_back('"');
-        }
-        quoted.push_back(c);
-    }
-    quoted.push_back('"');
-    return quoted;
+bool needs_quotes(std::string_view value) {
+    return value.find_first_of(",\"\n\r") != std::string_view::npos;
+}
+
+// std::to_string(double) is printf("%f"); to_chars with fixed precision 6
+// produces the same text without allocating.
+std::string_view format_double(double value, char (&scratch)[400]) {
+    auto result = std::to_chars(scratch, scratch + sizeof(scratch), value, std::chars_format::fixed, 6);
+    return {scratch, static_cast<std::size_t>(result.ptr - scratch)};
+}
+
+std::string_view format_int(int64_t value, char (&scratch)[400]) {
+    auto result = std::to_chars(scratch, scratch + sizeof(scratch), value);
+    return {scratch, static_cast<std::size_t>(result.ptr - scratch)};
 }
 
 } // namespace
@@ -48,6 +46,49 @@ CsvWriter::CsvWriter(const std::filesystem::path& path, bool append) {
     }
     if (append && std::filesystem::exists(path) && std::filesystem::file_size(path) > 0) {
         header_written_ = true;
+        bytes_flushed_ = std::filesystem::file_size(path);
+    }
+    buffer_.reserve(kFlushBytes + 4096);
+}
+
+CsvWriter::~CsvWriter() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+void CsvWriter::append_field(std::string_view value) {
+    if (!needs_quotes(value)) {
+        buffer_.append(value);
+        return;
+    }
+    buffer_.push_back('"');
+    for (char c : value) {
+        if (c == '"') {
+            buffer_.push_back('"');
+        }
+        buffer_.push_back(c);
+    }
+    buffer_.push_back('"');
+}
+
+void CsvWriter::end_row() {
+    buffer_.push_back('\n');
+    if (buffer_.size() >= kFlushBytes) {
+        flush();
+    }
+}
+
+void CsvWriter::flush() {
+    if (!buffer_.empty()) {
+        stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        bytes_flushed_ += buffer_.size();
+        buffer_.clear();
+    }
+    stream_.flush();
+    if (!stream_) {
+        throw std::runtime_error("Failed to write CSV file");
     }
 }
 
@@ -55,34 +96,56 @@ void CsvWriter::write_header(const std::vector<std::string>& columns) {
     if (header_written_) {
         return;
     }
-    std::string line;
     for (size_t i = 0; i < columns.size(); ++i) {
-        if (i > 0) line += ",";
-        line += escape_csv_field(columns[i]);
+        if (i > 0) buffer_.push_back(',');
+        append_field(columns[i]);
     }
-    stream_ << line << "\n";
     header_written_ = true;
+    end_row();
 }
 
 void CsvWriter::write_row(const std::vector<std::string>& values) {
     if (!header_written_) {
         throw std::runtime_error("CSV header must be written before rows");
     }
-    std::string line;
     for (size_t i = 0; i < values.size(); ++i) {
-        if (i > 0) line += ",";
-        line += escape_csv_field(values[i]);
+        if (i > 0) buffer_.push_back(',');
+        append_field(values[i]);
+    }
+    end_row();
+}
+
+void CsvWriter::write_fields(const Row& values) {
+    if (!header_written_) {
+        throw std::runtime_error("CSV header must be written before rows");
+    }
+    char scratch[400];
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) buffer_.push_back(',');
+        if (const auto* text = std::get_if<std::string>(&values[i])) {
+            append_field(*text);
+        } else if (const auto* number = std::get_if<double>(&values[i])) {
+            append_field(format_double(*number, scratch));
+        } else {
+            append_field(format_int(std::get<int64_t>(values[i]), scratch));
+        }
     }
-    stream_ << line << "\n";
+    end_row();
 }
 
 namespace json {
 
 namespace {
 
+// Recursive-descent parser over either an in-memory string or a stream read
+// in kChunkBytes pieces, so a config is never held in memory whole. Only the
+// unread tail of the current chunk is kept when the window is refilled.
 class Parser {
 public:
-    explicit Parser(const std::string& input) : text_(input) {}
+    static constexpr size_t kChunkBytes = size_t(1) << 16;
+
+    explicit Parser(std::string_view input) : window_(input) {}
+    explicit Parser(std::istream& input) : in_(&input) {}
 
     Value parse_value() {
         skip_ws();
@@ -95,26 +158,78 @@ public:
         return Value{parse_number()};
     }
 
+    // The top-level object, with the member `key` handled as in
+    // load_object_streaming.
+    Object parse_object_streaming(std::string_view key, const std::function<void(Value)>& on_element) {
+        Object obj;
+        parse_members([&](std::string name) {
+            if (name != key) {
+                obj.emplace(std::move(name), parse_value());
+                return;
+            }
+            skip_ws();
+            if (peek() != '[') {
+                throw std::runtime_error("JSON member '" + name + "' must be an array");
+            }
+            if (on_element) {
+                parse_elements([&] { on_element(parse_value()); });
+            } else {
+                skip_value();
+            }
+            obj.emplace(std::move(name), Value{Array{}});
+        });
+        return obj;
+    }
+
 private:
-    const std::string& text_;
+    std::istream* in_ = nullptr;
+    std::string chunk_;
+    std::string_view window_;
     size_t pos_ = 0;
 
+    // Makes n unread characters available, refilling from the stream if
+    // there is one. Returns false at the end of the input.
+    bool available(size_t n) {
+        if (window_.size() - pos_ >= n) return true;
+        if (!in_) return false;
+        chunk_.erase(0, pos_);
+        pos_ = 0;
+        while (chunk_.size() < n && *in_) {
+            const size_t old_size = chunk_.size();
+            chunk_.resize(old_size + kChunkBytes);
+            in_->read(chunk_.data() + old_size, static_cast<std::streamsize>(kChunkBytes));
+            chunk_.resize(old_size + static_cast<size_t>(in_->gcount()));
+        }
+        window_ = chunk_;
+        return chunk_.size() >= n;
+    }
+
     char peek() {
-        if (pos_ >= text_.size()) {
+        if (!available(1)) {
             throw std::runtime_error("Unexpected end of JSON input");
         }
-        return text_[pos_];
+        return window_[pos_];
+    }
+
+    char next() {
+        char c = peek();
+        ++pos_;
+        return c;
+    }
+
+    bool next_is(auto&& predicate) {
+        return available(1) && predicate(static_cast<unsigned char>(window_[pos_]));
     }
 
     void skip_ws() {
-        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+        while (next_is([](unsigned char c) { return std::isspace(c); })) {
             ++pos_;
         }
     }
 
     bool match(std::string_view token) {
         skip_ws();
-        if (text_.substr(pos_, token.size()) == token) {
+        if (available(token.size()) && window_.substr(pos_, token.size()) == token) {
             pos_ += token.size();
             return true;
         }
@@ -126,12 +241,12 @@ private:
         if (peek() != '"') throw std::runtime_error("Expected string");
         ++pos_;
         std::string result;
-        while (pos_ < text_.size()) {
-            char c = text_[pos_++];
+        while (available(1)) {
+            char c = window_[pos_++];
             if (c == '"') break;
             if (c == '\\') {
-                if (pos_ >= text_.size()) throw std::runtime_error("Invalid escape");
-                char esc = text_[pos_++];
+                if (!available(1)) throw std::runtime_error("Invalid escape");
+                char esc = window_[pos_++];
                 switch (esc) {
                     case '"': result.push_back('"'); break;
                     case '\\': result.push_back('\\'); break;
@@ -142,10 +257,10 @@ private:
                     case 'r': result.push_back('\r'); break;
                     case 't': result.push_back('\t'); break;
                     case 'u': {
-                        if (pos_ + 4 > text_.size()) throw std::runtime_error("Invalid unicode escape");
+                        if (!available(4)) throw std::runtime_error("Invalid unicode escape");
                         unsigned int code = 0;
                         for (int i = 0; i < 4; ++i) {
-                            char hex = text_[pos_++];
+                            char hex = window_[pos_++];
                             code <<= 4;
                             if (hex >= '0' && hex <= '9') code |= hex - '0';
                             else if (hex >= 'a' && hex <= 'f') code |= 10 + hex - 'a';
@@ -171,66 +286,110 @@ private:
 
     double parse_number() {
         skip_ws();
-        size_t start = pos_;
-        if (text_[pos_] == '-') ++pos_;
-        while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
-        if (pos_ < text_.size() && text_[pos_] == '.') {
-            ++pos_;
-            while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        std::string token;
+        auto take_if = [&](auto&& predicate) {
+            if (next_is(predicate)) {
+                token.push_back(window_[pos_++]);
+                return true;
+            }
+            return false;
+        };
+        auto digits = [&] {
+            while (take_if([](unsigned char c) { return std::isdigit(c); })) {
+            }
+        };
+        take_if([](unsigned char c) { return c == '-'; });
+        digits();
+        if (take_if([](unsigned char c) { return c == '.'; })) {
+            digits();
         }
-        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
-            ++pos_;
-            if (text_[pos_] == '+' || text_[pos_] == '-') ++pos_;
-            while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        if (take_if([](unsigned char c) { return c == 'e' || c == 'E'; })) {
+            take_if([](unsigned char c) { return c == '+' || c == '-'; });
+            digits();
         }
-        auto len = pos_ - start;
-        std::string token = text_.substr(start, len);
         return std::stod(token);
     }
 
-    Object parse_object() {
+    // Calls on_key(name) for every member of an object, with the input just
+    // past the ':'; on_key must consume the value.
+    template <typename Fn>
+    void parse_members(Fn&& on_key) {
         expect('{');
         skip_ws();
-        Object obj;
         if (peek() == '}') {
             ++pos_;
-            return obj;
+            return;
         }
         while (true) {
             skip_ws();
             std::string key = parse_string();
             expect(':');
-            Value value = parse_value();
-            obj.emplace(std::move(key), std::move(value));
+            on_key(std::move(key));
             skip_ws();
-            char c = peek();
-            ++pos_;
+            char c = next();
             if (c == '}') break;
             if (c != ',') throw std::runtime_error("Expected comma in object");
         }
-        return obj;
     }
 
-    Array parse_array() {
+    // Calls on_element() once per element of an array, with the input at the
+    // element; on_element must consume it.
+    template <typename Fn>
+    void parse_elements(Fn&& on_element) {
         expect('[');
         skip_ws();
-        Array arr;
         if (peek() == ']') {
             ++pos_;
-            return arr;
+            return;
         }
         while (true) {
-            Value value = parse_value();
-            arr.push_back(std::move(value));
+            on_element();
             skip_ws();
-            char c = peek();
-            ++pos_;
+            char c = next();
             if (c == ']') break;
             if (c != ',') throw std::runtime_error("Expected comma in array");
         }
+    }
+
+    Object parse_object() {
+        Object obj;
+        parse_members([&](std::string key) { obj.emplace(std::move(key), parse_value()); });
+        return obj;
+    }
+
+    Array parse_array() {
+        Array arr;
+        parse_elements([&] { arr.push_back(parse_value()); });
         return arr;
     }
 
+    // Steps over a value without building it. Objects and arrays are only
+    // bracket-matched (strings excepted), not validated.
+    void skip_value() {
+        skip_ws();
+        const char open = peek();
+        if (open == '"') {
+            parse_string();
+            return;
+        }
+        if (open != '{' && open != '[') {
+            parse_value();
+            return;
+        }
+        size_t depth = 0;
+        do {
+            const char c = next();
+            if (c == '"') {
+                --pos_;
+                parse_string();
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                --depth;
+            }
+        } while (depth > 0);
+    }
+
     void expect(char c) {
         skip_ws();
         if (peek() != c) {
@@ -240,73 +399,89 @@ private:
     }
 };
 
-std::string serialize_simple(const Value& value);
-
-std::string serialize_simple(const Value& value) {
+// Appends the compact form of `value` to `out`. Numbers use to_chars with
+// the general format and precision 6, which is the text `ostream << double`
+// produces, without a stream per number.
+void serialize_into(const Value& value, std::string& out) {
     struct Visitor {
-        std::string operator()(std::nullptr_t) const { return "null"; }
-        std::string operator()(bool v) const { return v ? "true" : "false"; }
-        std::string operator()(double v) const {
-            std::ostringstream oss;
-            oss << v;
-            return oss.str();
+        std::string& out;
+
+        void operator()(std::nullptr_t) const { out += "null"; }
+        void operator()(bool v) const { out += v ? "true" : "false"; }
+        void operator()(double v) const {
+            char scratch[64];
+            auto result = std::to_chars(scratch, scratch + sizeof(scratch), v, std::chars_format::general, 6);
+            out.append(scratch, result.ptr);
         }
-        std::string operator()(const std::string& s) const {
-            std::string out = "\"";
+        void operator()(const std::string& s) const {
+            out.push_back('"');
             for (char c : s) {
                 if (c == '"' || c == '\\') out.push_back('\\');
                 out.push_back(c);
             }
             out.push_back('"');
-            return out;
         }
-        std::string operator()(const Array& arr) const {
-            std::string out = "[";
+        void operator()(const Array& arr) const {
+            out.push_back('[');
             for (size_t i = 0; i < arr.size(); ++i) {
-                if (i > 0) out += ",";
-                out += serialize_simple(arr[i]);
+                if (i > 0) out.push_back(',');
+                serialize_into(arr[i], out);
             }
-            out += "]";
-            return out;
+            out.push_back(']');
         }
-        std::string operator()(const Object& obj) const {
-            std::string out = "{";
+        void operator()(const Object& obj) const {
+            out.push_back('{');
             size_t idx = 0;
             for (const auto& [key, val] : obj) {
-                if (idx++ > 0) out += ",";
-                out += (*this)(key);
-                out += ":";
-                out += serialize_simple(val);
+                if (idx++ > 0) out.push_back(',');
+                (*this)(key);
+                out.push_back(':');
+                serialize_into(val, out);
             }
-            out += "}";
-            return out;
-        }
-        std::string operator()(const Value& value) const {
-            return std::visit(*this, value.data);
+            out.push_back('}');
         }
     };
-    return Visitor{}(value);
+    std::visit(Visitor{out}, value.data);
 }
 
 } // namespace
 
 Value parse(const std::string& text) {
-    Parser parser(text);
+    Parser parser(std::string_view{text});
     return parser.parse_value();
 }
 
-Value load_file(const std::filesystem::path& path) {
-    std::ifstream ifs(path);
+namespace {
+
+std::ifstream open_json(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
     if (!ifs) {
         throw std::runtime_error("Failed to open JSON file: " + path.string());
     }
-    std::ostringstream buffer;
-    buffer << ifs.rdbuf();
-    return parse(buffer.str());
+    return ifs;
+}
+
+} // namespace
+
+Value load_file(const std::filesystem::path& path) {
+    auto ifs = open_json(path);
+    Parser parser(ifs);
+    return parser.parse_value();
+}
+
+Object load_object_streaming(const std::filesystem::path& path,
+                             std::string_view array_key,
+                             const std::function<void(Value)>& on_element) {
+    auto ifs = open_json(path);
+    Parser parser(ifs);
+    return parser.parse_object_streaming(array_key, on_element);
 }
 
 std::string serialize_compact(const Value& value) {
-    return serialize_simple(value);
+    std::string out;
+    out.reserve(128);
+    serialize_into(value, out);
+    return out;
 }
 
 } // namespace json
@@ -0,0 +1,91 @@
+#include "core/manifest.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace fpstudy::core {
+
+SweepManifest SweepManifest::load(const std::filesystem::path& path) {
+    SweepManifest manifest;
+    std::ifstream in(path);
+    if (!in) {
+        return manifest;
+    }
+    std::vector<uint64_t> uncommitted;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (in.eof()) {
+            // No newline: the final line was cut off mid-write.
+            break;
+        }
+        std::string_view text(line);
+        uint64_t value = 0;
+        if (text.starts_with("cell ")) {
+            auto digits = text.substr(5);
+            auto result = std::from_chars(digits.data(), digits.data() + digits.size(), value, 16);
+            if (result.ec == std::errc() && result.ptr == digits.data() + digits.size()) {
+                uncommitted.push_back(value);
+            }
+        } else if (text.starts_with("commit ")) {
+            auto digits = text.substr(7);
+            auto result = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+            if (result.ec != std::errc() || result.ptr != digits.data() + digits.size()) {
+                break;
+            }
+            manifest.cells_.insert(uncommitted.begin(), uncommitted.end());
+            uncommitted.clear();
+            manifest.committed_bytes_ = value;
+        }
+    }
+    return manifest;
+}
+
+ManifestWriter::ManifestWriter(const std::filesystem::path& path, bool append) {
+    stream_.open(path, append ? std::ios::app : std::ios::trunc);
+    if (!stream_) {
+        throw std::runtime_error("Failed to open manifest file: " + path.string());
+    }
+}
+
+void ManifestWriter::commit(uint64_t csv_bytes) {
+    std::string text;
+    text.reserve(pending_.size() * 22 + 32);
+    char hex[17];
+    for (uint64_t cell : pending_) {
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(cell));
+        text += "cell ";
+        text.append(hex, 16);
+        text.push_back('\n');
+    }
+    text += "commit " + std::to_string(csv_bytes) + "\n";
+    stream_.write(text.data(), static_cast<std::streamsize>(text.size()));
+    stream_.flush();
+    if (!stream_) {
+        throw std::runtime_error("Failed to write manifest file");
+    }
+    pending_.clear();
+}
+
+void rewrite_manifest(const std::filesystem::path& path, const SweepManifest& manifest) {
+    auto temp = path;
+    temp += ".tmp";
+    {
+        ManifestWriter writer(temp, false);
+        for (uint64_t cell : manifest.cells()) {
+            writer.add(cell);
+        }
+        writer.commit(manifest.committed_bytes());
+    }
+    std::filesystem::rename(temp, path);
+}
+
+std::filesystem::path manifest_path_for(const std::filesystem::path& csv_path) {
+    auto path = csv_path;
+    path += ".manifest";
+    return path;
+}
+
+} // namespace fpstudy::core
@@ -0,0 +1,148 @@
+#include "core/metrics.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define FPSTUDY_HAVE_PERF_EVENT 1
+#endif
+
+namespace fpstudy::core {
+
+namespace {
+
+std::atomic<bool> counters_enabled{false};
+std::once_flag unavailable_warning;
+
+void warn_unavailable(const std::string& reason) {
+    std::call_once(unavailable_warning, [&] {
+        std::cerr << "warning: hardware counters unavailable (" << reason
+                  << "); counter columns will be -1\n";
+    });
+}
+
+#if defined(FPSTUDY_HAVE_PERF_EVENT)
+
+// Cycles first: it leads the group, so the others are scheduled with it.
+constexpr uint64_t kEvents[4] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+// The calling thread's event group, counting user-space events from the
+// moment it opens. Timers read it twice and subtract, so it is never reset.
+class ThreadCounters {
+public:
+    ThreadCounters() {
+        for (std::size_t i = 0; i < 4; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = kEvents[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0));
+            if (fd < 0) {
+                warn_unavailable(std::string("perf_event_open: ") + std::strerror(errno));
+                close_all();
+                return;
+            }
+            fds_[i] = fd;
+        }
+    }
+
+    ~ThreadCounters() { close_all(); }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    bool read(detail::PerfSnapshot& snapshot) const {
+        if (fds_[0] < 0) {
+            return false;
+        }
+        // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr].
+        uint64_t data[3 + 4];
+        if (::read(fds_[0], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[0] != 4) {
+            return false;
+        }
+        snapshot.time_enabled = data[1];
+        snapshot.time_running = data[2];
+        for (std::size_t i = 0; i < 4; ++i) {
+            snapshot.values[i] = data[3 + i];
+        }
+        return true;
+    }
+
+private:
+    void close_all() {
+        for (int& fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    int fds_[4] = {-1, -1, -1, -1};
+};
+
+#endif
+
+} // namespace
+
+void set_perf_counters_enabled(bool enabled) {
+#if !defined(FPSTUDY_HAVE_PERF_EVENT)
+    if (enabled) {
+        warn_unavailable("perf_event is Linux only");
+    }
+#endif
+    counters_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool perf_counters_enabled() {
+    return counters_enabled.load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+bool read_perf_snapshot(PerfSnapshot& snapshot) {
+#if defined(FPSTUDY_HAVE_PERF_EVENT)
+    thread_local ThreadCounters counters;
+    return counters.read(snapshot);
+#else
+    (void)snapshot;
+    return false;
+#endif
+}
+
+// When the group shared the PMU with other events, scale the counts up by
+// enabled/running time over the region, as perf stat does.
+PerfCounts perf_counts_between(const PerfSnapshot& start, const PerfSnapshot& end) {
+    const uint64_t enabled = end.time_enabled - start.time_enabled;
+    const uint64_t running = end.time_running - start.time_running;
+    if (running == 0) {
+        return {};
+    }
+    const double scale = static_cast<double>(enabled) / static_cast<double>(running);
+    auto count = [&](std::size_t i) {
+        return static_cast<int64_t>(std::llround(static_cast<double>(end.values[i] - start.values[i]) * scale));
+    };
+    return {count(0), count(1), count(2), count(3)};
+}
+
+} // namespace detail
+
+} // namespace fpstudy::core
@@ -0,0 +1,178 @@
+#include "core/random.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#include "core/philox.hpp"
+#include "core/scheduler.hpp"
+
+namespace fpstudy::core {
+
+namespace {
+
+// Counter blocks per tile. The Philox rounds and the Box-Muller transform
+// are separate branch-free passes over a tile, so each vectorizes (see the
+// compile options for this file in CMakeLists.txt).
+constexpr std::size_t kTileBlocks = 128;
+
+// Below this many elements per thread, spawning costs more than it saves.
+constexpr std::size_t kMinParallelChunk = std::size_t(1) << 18;
+
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kSqrt2 = 1.41421356237309504880;
+constexpr double kHalfPi = 1.57079632679489661923;
+
+// Natural log of u in (0, 1]: u = m 2^e with m in [sqrt(1/2), sqrt(2)),
+// then log m = 2 atanh(s) for s = (m - 1) / (m + 1), |s| < 0.172, summed to
+// s^19. Accurate to a few ulps, which is all a sampler needs. The exponent
+// goes to double through the 2^52 trick rather than an int64 conversion,
+// which SSE2 and AVX2 cannot vectorize.
+double log_unit(double u) {
+    const uint64_t bits = std::bit_cast<uint64_t>(u);
+    double m = std::bit_cast<double>((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    double e = std::bit_cast<double>((bits >> 52) | 0x4330000000000000ULL) - (0x1p52 + 1023.0);
+    const bool high = m > kSqrt2;
+    m = high ? m * 0.5 : m;
+    e = high ? e + 1.0 : e;
+    const double s = (m - 1.0) / (m + 1.0);
+    const double z = s * s;
+    double p = 1.0 / 19.0;
+    p = p * z + 1.0 / 17.0;
+    p = p * z + 1.0 / 15.0;
+    p = p * z + 1.0 / 13.0;
+    p = p * z + 1.0 / 11.0;
+    p = p * z + 1.0 / 9.0;
+    p = p * z + 1.0 / 7.0;
+    p = p * z + 1.0 / 5.0;
+    p = p * z + 1.0 / 3.0;
+    const double log_m = 2.0 * s + 2.0 * s * (z * p);
+    return e * kLn2Hi + (log_m + e * kLn2Lo);
+}
+
+// cos and sin of 2 pi v for v in [0, 1): the quadrant comes from 4v exactly,
+// and the remaining angle t in [0, pi/2) goes through Taylor series to t^20
+// and t^21 (truncation below 2e-17).
+void sincos_turn(double v, double& c, double& s) {
+    const double q = v * 4.0;
+    const int quadrant = static_cast<int>(q);
+    const double t = (q - static_cast<double>(quadrant)) * kHalfPi;
+    const double t2 = t * t;
+    double cp = 1.0 / 2432902008176640000.0;          // 1/20!
+    cp = cp * t2 - 1.0 / 6402373705728000.0;          // 1/18!
+    cp = cp * t2 + 1.0 / 20922789888000.0;            // 1/16!
+    cp = cp * t2 - 1.0 / 87178291200.0;               // 1/14!
+    cp = cp * t2 + 1.0 / 479001600.0;                 // 1/12!
+    cp = cp * t2 - 1.0 / 3628800.0;                   // 1/10!
+    cp = cp * t2 + 1.0 / 40320.0;                     // 1/8!
+    cp = cp * t2 - 1.0 / 720.0;                       // 1/6!
+    cp = cp * t2 + 1.0 / 24.0;                        // 1/4!
+    cp = cp * t2 - 0.5;
+    const double cos_t = 1.0 + t2 * cp;
+    double sp = 1.0 / 51090942171709440000.0;         // 1/21!
+    sp = sp * t2 - 1.0 / 121645100408832000.0;        // 1/19!
+    sp = sp * t2 + 1.0 / 355687428096000.0;           // 1/17!
+    sp = sp * t2 - 1.0 / 1307674368000.0;             // 1/15!
+    sp = sp * t2 + 1.0 / 6227020800.0;                // 1/13!
+    sp = sp * t2 - 1.0 / 39916800.0;                  // 1/11!
+    sp = sp * t2 + 1.0 / 362880.0;                    // 1/9!
+    sp = sp * t2 - 1.0 / 5040.0;                      // 1/7!
+    sp = sp * t2 + 1.0 / 120.0;                       // 1/5!
+    sp = sp * t2 - 1.0 / 6.0;
+    const double sin_t = t + t * (t2 * sp);
+    const bool odd = (quadrant & 1) != 0;
+    const double cos_abs = odd ? sin_t : cos_t;
+    const double sin_abs = odd ? cos_t : sin_t;
+    c = (quadrant == 1 || quadrant == 2) ? -cos_abs : cos_abs;
+    s = quadrant >= 2 ? -sin_abs : sin_abs;
+}
+
+} // namespace
+
+std::string rng_kind_to_string(RngKind kind) {
+    switch (kind) {
+        case RngKind::MT19937: return "mt19937";
+        case RngKind::Philox: return "philox";
+    }
+    return "mt19937";
+}
+
+RngKind rng_kind_from_string(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower == "mt19937") return RngKind::MT19937;
+    if (lower == "philox") return RngKind::Philox;
+    throw std::runtime_error("Unknown rng: " + std::string(name));
+}
+
+void philox_normal_fill(uint32_t seed, uint64_t stream, uint64_t first, std::span<double> out, double scale) {
+    if (out.empty()) {
+        return;
+    }
+    const PhiloxKey key = {seed, static_cast<uint32_t>(stream)};
+    const uint32_t stream_hi = static_cast<uint32_t>(stream >> 32);
+    const uint64_t last_block = (first + out.size() - 1) / 2;
+    double u1[kTileBlocks];
+    double u2[kTileBlocks];
+    double cosine[kTileBlocks];
+    double sine[kTileBlocks];
+    std::size_t i = 0;
+    while (i < out.size()) {
+        const uint64_t element = first + i;
+        const uint64_t block0 = element / 2;
+        const std::size_t blocks = static_cast<std::size_t>(std::min<uint64_t>(kTileBlocks, last_block - block0 + 1));
+        for (std::size_t b = 0; b < blocks; ++b) {
+            const uint64_t block = block0 + b;
+            const auto w = philox4x32({static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32), stream_hi, 0},
+                                      key);
+            // 52-bit fractions through the exponent of 1.0: u1 in (0, 1]
+            // keeps the log finite, u2 is in [0, 1).
+            const uint64_t x1 = (uint64_t(w[0]) << 32) | w[1];
+            const uint64_t x2 = (uint64_t(w[2]) << 32) | w[3];
+            u1[b] = 2.0 - std::bit_cast<double>((x1 >> 12) | 0x3ff0000000000000ULL);
+            u2[b] = std::bit_cast<double>((x2 >> 12) | 0x3ff0000000000000ULL) - 1.0;
+        }
+        for (std::size_t b = 0; b < blocks; ++b) {
+            u1[b] = std::sqrt(-2.0 * log_unit(u1[b]));
+            sincos_turn(u2[b], cosine[b], sine[b]);
+        }
+        const std::size_t offset = static_cast<std::size_t>(element - 2 * block0);
+        const std::size_t count = std::min(out.size() - i, 2 * blocks - offset);
+        for (std::size_t k = 0; k < count; ++k) {
+            const std::size_t slot = offset + k;
+            const double half = (slot & 1) != 0 ? sine[slot / 2] : cosine[slot / 2];
+            out[i + k] = u1[slot / 2] * half * scale;
+        }
+        i += count;
+    }
+}
+
+void philox_normal_fill_parallel(uint32_t seed, uint64_t stream, std::span<double> out, double scale) {
+    const std::size_t hardware =
+        ThreadPool::on_worker_thread() ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t threads = std::min(hardware, out.size() / kMinParallelChunk);
+    if (threads <= 1) {
+        philox_normal_fill(seed, stream, 0, out, scale);
+        return;
+    }
+    const std::size_t chunk = (out.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; ++t) {
+        const std::size_t begin = std::min(out.size(), t * chunk);
+        const std::size_t end = std::min(out.size(), begin + chunk);
+        workers.emplace_back([=] { philox_normal_fill(seed, stream, begin, out.subspan(begin, end - begin), scale); });
+    }
+    philox_normal_fill(seed, stream, 0, out.first(std::min(out.size(), chunk)), scale);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace fpstudy::core
@@ -0,0 +1,274 @@
+#include "core/scheduler.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace fpstudy::core {
+
+namespace {
+
+thread_local bool tls_in_worker = false;
+
+} // namespace
+
+bool ThreadPool::on_worker_thread() {
+    return tls_in_worker;
+}
+
+ThreadPool::ThreadPool(std::size_t workers, std::size_t max_queued) : max_queued_(max_queued) {
+    threads_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return in_flight_ == 0; });
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (threads_.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (first_error_) return;
+            ++in_flight_;
+        }
+        run_task(task);
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!tls_in_worker && max_queued_ != 0) {
+            space_available_.wait(lock, [this] { return queue_.size() < max_queued_ || first_error_; });
+        }
+        if (first_error_) return;
+        ++in_flight_;
+        if (tls_in_worker) {
+            queue_.push_front(std::move(task));
+        } else {
+            queue_.push_back(std::move(task));
+        }
+    }
+    work_available_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return in_flight_ == 0; });
+        error = std::exchange(first_error_, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::run_task(std::function<void()>& task) {
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!first_error_) {
+            first_error_ = std::current_exception();
+            space_available_.notify_all();
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--in_flight_ == 0) {
+        idle_.notify_all();
+    }
+}
+
+void ThreadPool::worker_loop() {
+    tls_in_worker = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            space_available_.notify_one();
+            if (first_error_) {
+                // Drop remaining work once a task has failed.
+                if (--in_flight_ == 0) {
+                    idle_.notify_all();
+                }
+                continue;
+            }
+        }
+        run_task(task);
+    }
+}
+
+std::size_t resolve_job_count(std::size_t requested) {
+    if (requested == 0) {
+        std::size_t hw = std::thread::hardware_concurrency();
+        return hw > 1 ? hw : 0;
+    }
+    return requested == 1 ? 0 : requested;
+}
+
+void OrderedRowSink::push(std::size_t index, Row row, uint64_t cell) {
+    accept(index, Entry{std::move(row), cell, false});
+}
+
+void OrderedRowSink::skip(std::size_t index) {
+    accept(index, Entry{{}, 0, true});
+}
+
+OrderedRowSink::~OrderedRowSink() {
+    if (writer_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(inbox_mutex_);
+            stopping_ = true;
+        }
+        inbox_ready_.notify_one();
+        writer_thread_.join();
+    }
+}
+
+void OrderedRowSink::start_writer(std::size_t capacity) {
+    if (writer_thread_.joinable()) {
+        throw std::runtime_error("OrderedRowSink writer already started");
+    }
+    inbox_capacity_ = capacity == 0 ? 1 : capacity;
+    writer_thread_ = std::thread([this] { writer_loop(); });
+}
+
+void OrderedRowSink::accept(std::size_t index, Entry entry) {
+    if (!writer_thread_.joinable()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        accept_locked(index, std::move(entry));
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(inbox_mutex_);
+        inbox_space_.wait(lock, [this] { return inbox_.size() < inbox_capacity_ || writer_error_; });
+        if (writer_error_) {
+            std::rethrow_exception(writer_error_);
+        }
+        inbox_.emplace_back(index, std::move(entry));
+    }
+    inbox_ready_.notify_one();
+}
+
+// Takes the whole inbox at once, so pushers wait at most for one batch.
+void OrderedRowSink::writer_loop() {
+    while (true) {
+        std::deque<std::pair<std::size_t, Entry>> batch;
+        {
+            std::unique_lock<std::mutex> lock(inbox_mutex_);
+            inbox_ready_.wait(lock, [this] { return stopping_ || !inbox_.empty(); });
+            if (inbox_.empty()) {
+                return;
+            }
+            batch.swap(inbox_);
+            writer_busy_ = true;
+        }
+        inbox_space_.notify_all();
+        std::exception_ptr error;
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& [index, entry] : batch) {
+                accept_locked(index, std::move(entry));
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(inbox_mutex_);
+            if (error && !writer_error_) {
+                writer_error_ = error;
+            }
+            writer_busy_ = false;
+        }
+        inbox_space_.notify_all();
+        inbox_drained_.notify_all();
+    }
+}
+
+void OrderedRowSink::drain_inbox() {
+    if (!writer_thread_.joinable()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(inbox_mutex_);
+    inbox_drained_.wait(lock, [this] { return (inbox_.empty() && !writer_busy_) || writer_error_; });
+    if (writer_error_) {
+        std::rethrow_exception(writer_error_);
+    }
+}
+
+void OrderedRowSink::accept_locked(std::size_t index, Entry entry) {
+    if (index != next_) {
+        pending_.emplace(index, std::move(entry));
+        return;
+    }
+    write(next_, entry);
+    ++next_;
+    for (auto it = pending_.begin(); it != pending_.end() && it->first == next_; it = pending_.erase(it)) {
+        write(next_, it->second);
+        ++next_;
+    }
+    if (uncommitted_ >= kCommitRows) {
+        commit_locked();
+    }
+}
+
+void OrderedRowSink::write(std::size_t index, const Entry& entry) {
+    if (entry.skipped) {
+        return;
+    }
+    writer_.write_fields(entry.row);
+    if (columnar_) {
+        columnar_->write_row(entry.row);
+    }
+    if (row_index_) {
+        row_index_->add(index);
+    }
+    if (manifest_) {
+        manifest_->add(entry.cell);
+        ++uncommitted_;
+    }
+}
+
+void OrderedRowSink::commit() {
+    drain_inbox();
+    std::lock_guard<std::mutex> lock(mutex_);
+    commit_locked();
+}
+
+void OrderedRowSink::commit_locked() {
+    writer_.flush();
+    if (row_index_) {
+        row_index_->flush();
+    }
+    if (manifest_) {
+        manifest_->commit(writer_.bytes_flushed());
+    }
+    uncommitted_ = 0;
+}
+
+std::size_t OrderedRowSink::rows_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_;
+}
+
+std::size_t OrderedRowSink::rows_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+} // namespace fpstudy::core
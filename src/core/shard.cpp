@@ -0,0 +1,190 @@
+#include "core/shard.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+
+namespace fpstudy::core {
+
+namespace {
+
+constexpr std::string_view kIndexTag = "fpstudy-shard ";
+
+bool parse_size(std::string_view text, std::size_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace
+
+ShardSpec ShardSpec::parse(std::string_view text) {
+    ShardSpec spec;
+    auto slash = text.find('/');
+    if (slash == std::string_view::npos || !parse_size(text.substr(0, slash), spec.index) ||
+        !parse_size(text.substr(slash + 1), spec.count) || spec.count == 0 || spec.index >= spec.count) {
+        throw std::runtime_error("Invalid shard '" + std::string(text) + "'; expected i/N with 0 <= i < N");
+    }
+    return spec;
+}
+
+std::string ShardSpec::to_string() const {
+    return std::to_string(index) + "/" + std::to_string(count);
+}
+
+RowIndexWriter::RowIndexWriter(const std::filesystem::path& path, const ShardSpec& shard, std::size_t keep_rows) {
+    const std::string tag = std::string(kIndexTag) + shard.to_string();
+    std::string kept;
+    if (keep_rows > 0) {
+        std::ifstream in(path);
+        std::string line;
+        if (!std::getline(in, line) || line != tag) {
+            throw std::runtime_error("Row index " + path.string() + " does not belong to shard " + shard.to_string());
+        }
+        for (std::size_t i = 0; i < keep_rows; ++i) {
+            if (!std::getline(in, line) || in.eof()) {
+                throw std::runtime_error("Row index " + path.string() + " is shorter than its CSV");
+            }
+            kept += line;
+            kept.push_back('\n');
+        }
+    }
+    stream_.open(path, std::ios::trunc);
+    if (!stream_) {
+        throw std::runtime_error("Failed to open row index file: " + path.string());
+    }
+    stream_ << tag << "\n" << kept;
+}
+
+void RowIndexWriter::add(std::size_t row) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), row);
+    *result.ptr++ = '\n';
+    stream_.write(digits, result.ptr - digits);
+}
+
+void RowIndexWriter::flush() {
+    stream_.flush();
+    if (!stream_) {
+        throw std::runtime_error("Failed to write row index file");
+    }
+}
+
+std::filesystem::path row_index_path_for(const std::filesystem::path& csv_path) {
+    auto path = csv_path;
+    path += ".rows";
+    return path;
+}
+
+std::filesystem::path shard_csv_path(const std::filesystem::path& csv_path, const ShardSpec& shard) {
+    auto path = csv_path;
+    path.replace_filename(csv_path.stem().string() + ".shard-" + std::to_string(shard.index) + "-of-" +
+                          std::to_string(shard.count) + csv_path.extension().string());
+    return path;
+}
+
+std::vector<std::filesystem::path> find_shard_csvs(const std::filesystem::path& csv_path) {
+    const std::string prefix = csv_path.stem().string() + ".shard-";
+    const std::string extension = csv_path.extension().string();
+    auto dir = csv_path.parent_path();
+    std::vector<std::filesystem::path> found;
+    if (!std::filesystem::is_directory(dir.empty() ? "." : dir)) {
+        return found;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(dir.empty() ? "." : dir)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with(prefix) && name.ends_with(extension) &&
+            name.find("-of-", prefix.size()) != std::string::npos) {
+            found.push_back(dir / name);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::size_t merge_shards(const std::vector<std::filesystem::path>& shard_csvs,
+                         const std::filesystem::path& output) {
+    if (shard_csvs.empty()) {
+        throw std::runtime_error("merge needs at least one shard CSV");
+    }
+    // A shard that was resumed appends its missing cells after the rows it
+    // kept, so shards are not necessarily sorted; collect and sort them all.
+    std::vector<std::pair<std::size_t, std::string>> rows;
+    std::vector<bool> seen;
+    std::string header;
+    for (const auto& csv : shard_csvs) {
+        const auto index_path = row_index_path_for(csv);
+        std::ifstream in(csv);
+        std::ifstream index(index_path);
+        if (!in || !index) {
+            throw std::runtime_error("Missing shard CSV or row index: " + csv.string());
+        }
+        std::string line;
+        std::getline(index, line);
+        if (!std::string_view(line).starts_with(kIndexTag)) {
+            throw std::runtime_error("Not a shard row index: " + index_path.string());
+        }
+        auto spec = ShardSpec::parse(std::string_view(line).substr(kIndexTag.size()));
+        if (seen.empty()) {
+            seen.assign(spec.count, false);
+        }
+        if (spec.count != seen.size()) {
+            throw std::runtime_error("Shard " + csv.string() + " belongs to a " + std::to_string(spec.count) +
+                                     "-way split, expected " + std::to_string(seen.size()));
+        }
+        if (seen[spec.index]) {
+            throw std::runtime_error("Shard " + spec.to_string() + " given twice");
+        }
+        seen[spec.index] = true;
+
+        if (!std::getline(in, line) || (!header.empty() && line != header)) {
+            throw std::runtime_error("Shard CSV header missing or different: " + csv.string());
+        }
+        header = line;
+        std::string index_line;
+        while (std::getline(index, index_line)) {
+            std::size_t row = 0;
+            if (!parse_size(index_line, row)) {
+                throw std::runtime_error("Malformed row index in " + index_path.string());
+            }
+            if (!std::getline(in, line)) {
+                throw std::runtime_error("Shard CSV has fewer rows than its index: " + csv.string());
+            }
+            rows.emplace_back(row, std::move(line));
+        }
+        if (std::getline(in, line)) {
+            throw std::runtime_error("Shard CSV has more rows than its index: " + csv.string());
+        }
+    }
+    for (std::size_t i = 0; i < seen.size(); ++i) {
+        if (!seen[i]) {
+            throw std::runtime_error("Shard " + std::to_string(i) + "/" + std::to_string(seen.size()) + " is missing");
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].first != i) {
+            throw std::runtime_error("Shard rows do not cover the sweep: expected row " + std::to_string(i) +
+                                     ", found " + std::to_string(rows[i].first));
+        }
+    }
+
+    if (output.has_parent_path()) {
+        std::filesystem::create_directories(output.parent_path());
+    }
+    std::ofstream out(output, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open merged CSV: " + output.string());
+    }
+    out << header << "\n";
+    for (const auto& [row, text] : rows) {
+        out << text << "\n";
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write merged CSV: " + output.string());
+    }
+    return rows.size();
+}
+
+} // namespace fpstudy::core
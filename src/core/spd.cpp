@@ -0,0 +1,141 @@
+#include "core/spd.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace fpstudy::core {
+
+namespace {
+
+constexpr std::size_t kTile = 64;
+
+void mirror_upper(std::vector<double>& Q, std::size_t dim) {
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = i + 1; j < dim; ++j) {
+            Q[j * dim + i] = Q[i * dim + j];
+        }
+    }
+}
+
+} // namespace
+
+std::string spd_kind_to_string(SpdKind kind) {
+    switch (kind) {
+        case SpdKind::Gram: return "gram";
+        case SpdKind::Spectral: return "spectral";
+        case SpdKind::LowRank: return "low_rank";
+    }
+    throw std::runtime_error("Unknown SPD kind enum");
+}
+
+SpdKind spd_kind_from_string(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower == "gram") return SpdKind::Gram;
+    if (lower == "spectral") return SpdKind::Spectral;
+    if (lower == "low_rank" || lower == "lowrank") return SpdKind::LowRank;
+    throw std::runtime_error("Unknown spd generator: " + std::string(name));
+}
+
+std::vector<double> gram_spd(std::span<const double> M, std::size_t rows, std::size_t dim, double shift) {
+    if (M.size() != rows * dim) {
+        throw std::runtime_error("gram_spd: M has " + std::to_string(M.size()) + " values, expected " +
+                                 std::to_string(rows * dim));
+    }
+    std::vector<double> Q(dim * dim, 0.0);
+    for (std::size_t i0 = 0; i0 < dim; i0 += kTile) {
+        const std::size_t i1 = std::min(i0 + kTile, dim);
+        for (std::size_t j0 = i0; j0 < dim; j0 += kTile) {
+            const std::size_t j1 = std::min(j0 + kTile, dim);
+            for (std::size_t k = 0; k < rows; ++k) {
+                const double* row = M.data() + k * dim;
+                for (std::size_t i = i0; i < i1; ++i) {
+                    const double a = row[i];
+                    double* out = Q.data() + i * dim;
+                    for (std::size_t j = std::max(j0, i); j < j1; ++j) {
+                        out[j] += a * row[j];
+                    }
+                }
+            }
+        }
+    }
+    for (std::size_t i = 0; i < dim; ++i) {
+        Q[i * dim + i] += shift;
+    }
+    mirror_upper(Q, dim);
+    return Q;
+}
+
+std::vector<double> spectral_spd(std::size_t dim, double condition, Random& rng, std::size_t reflections) {
+    if (!(condition >= 1.0)) {
+        throw std::runtime_error("spectral SPD condition must be >= 1");
+    }
+    std::vector<double> Q(dim * dim, 0.0);
+    for (std::size_t i = 0; i < dim; ++i) {
+        const double t = dim > 1 ? static_cast<double>(i) / static_cast<double>(dim - 1) : 0.0;
+        Q[i * dim + i] = std::pow(condition, -t);
+    }
+    std::vector<double> w(dim);
+    for (std::size_t r = 0; r < reflections && dim > 1; ++r) {
+        auto v = random_vector(dim, rng);
+        double norm = 0.0;
+        for (double x : v) {
+            norm += x * x;
+        }
+        norm = std::sqrt(norm);
+        for (double& x : v) {
+            x /= norm;
+        }
+        // H Q H = Q - 2 w v^T - 2 v w^T + 4 alpha v v^T with w = Q v and
+        // alpha = v^T w, for H = I - 2 v v^T and symmetric Q.
+        double alpha = 0.0;
+        for (std::size_t i = 0; i < dim; ++i) {
+            double acc = 0.0;
+            for (std::size_t j = 0; j < dim; ++j) {
+                acc += Q[i * dim + j] * v[j];
+            }
+            w[i] = acc;
+            alpha += v[i] * acc;
+        }
+        for (std::size_t i = 0; i < dim; ++i) {
+            double* out = Q.data() + i * dim;
+            const double vi = v[i];
+            const double wi = w[i];
+            for (std::size_t j = i; j < dim; ++j) {
+                out[j] += 4.0 * alpha * vi * v[j] - 2.0 * (wi * v[j] + vi * w[j]);
+            }
+        }
+        mirror_upper(Q, dim);
+    }
+    return Q;
+}
+
+std::vector<double> make_spd(std::size_t dim, Random& rng, bool ill_conditioned, const SpdOptions& opts) {
+    const double shift = static_cast<double>(dim) * 0.1;
+    switch (opts.kind) {
+        case SpdKind::Gram: {
+            auto M = random_matrix(dim, dim, rng, ill_conditioned);
+            return gram_spd(M, dim, dim, shift);
+        }
+        case SpdKind::Spectral:
+            if (ill_conditioned) {
+                throw std::runtime_error("spectral SPD takes its conditioning from \"condition\", "
+                                         "not ill_conditioned");
+            }
+            return spectral_spd(dim, opts.condition, rng);
+        case SpdKind::LowRank: {
+            if (opts.rank == 0) {
+                throw std::runtime_error("low_rank SPD rank must be positive");
+            }
+            auto V = random_matrix(opts.rank, dim, rng, ill_conditioned);
+            return gram_spd(V, opts.rank, dim, shift);
+        }
+    }
+    throw std::runtime_error("Unknown SPD kind enum");
+}
+
+} // namespace fpstudy::core
@@ -0,0 +1,282 @@
+#include "core/table.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <variant>
+
+#include "core/cache.hpp"
+
+namespace fpstudy::core {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'P', 'S', 'T', 'A', 'B', 'L', 'E'};
+constexpr uint32_t kFormatVersion = 1;
+
+std::size_t padded(std::size_t n) {
+    return (n + 7) & ~std::size_t(7);
+}
+
+// Bounds-checked reads at absolute offsets of a mapped table.
+class Reader {
+public:
+    Reader(const std::byte* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename U>
+    U read(std::size_t offset) const {
+        U value;
+        std::memcpy(&value, at(offset, sizeof(U)), sizeof(U));
+        return value;
+    }
+
+    const std::byte* at(std::size_t offset, std::size_t length) const {
+        if (offset > size_ || length > size_ - offset) {
+            throw std::runtime_error("Columnar table is truncated or malformed");
+        }
+        return data_ + offset;
+    }
+
+private:
+    const std::byte* data_;
+    std::size_t size_;
+};
+
+} // namespace
+
+ColumnarWriter::ColumnarWriter(const std::filesystem::path& path, std::vector<ColumnSpec> schema,
+                               std::size_t batch_rows)
+    : schema_(std::move(schema)), buffers_(schema_.size()), batch_rows_(batch_rows == 0 ? kBatchRows : batch_rows) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    stream_.open(path, std::ios::binary | std::ios::trunc);
+    if (!stream_) {
+        throw std::runtime_error("Failed to open columnar output: " + path.string());
+    }
+    write_bytes(kMagic, sizeof(kMagic));
+    const uint32_t count = static_cast<uint32_t>(schema_.size());
+    write_bytes(&kFormatVersion, sizeof(kFormatVersion));
+    write_bytes(&count, sizeof(count));
+    for (const auto& column : schema_) {
+        const uint64_t type = static_cast<uint64_t>(column.type);
+        const uint64_t length = column.name.size();
+        write_bytes(&type, sizeof(type));
+        write_bytes(&length, sizeof(length));
+        write_bytes(column.name.data(), column.name.size());
+        pad();
+    }
+    for (auto& buffer : buffers_) {
+        buffer.offsets.push_back(0);
+    }
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+
+void ColumnarWriter::write_row(const Row& row) {
+    if (finished_) {
+        throw std::runtime_error("Columnar output already finished");
+    }
+    if (row.size() != schema_.size()) {
+        throw std::runtime_error("Columnar row has " + std::to_string(row.size()) + " fields, schema has " +
+                                 std::to_string(schema_.size()));
+    }
+    for (std::size_t c = 0; c < row.size(); ++c) {
+        auto& buffer = buffers_[c];
+        switch (schema_[c].type) {
+            case ColumnType::String: {
+                const auto* text = std::get_if<std::string>(&row[c]);
+                if (!text) {
+                    throw std::runtime_error("Columnar column " + schema_[c].name + " expects a string");
+                }
+                buffer.bytes.append(*text);
+                buffer.offsets.push_back(buffer.bytes.size());
+                break;
+            }
+            case ColumnType::Float64: {
+                const auto* number = std::get_if<double>(&row[c]);
+                if (!number) {
+                    throw std::runtime_error("Columnar column " + schema_[c].name + " expects a double");
+                }
+                buffer.floats.push_back(*number);
+                break;
+            }
+            case ColumnType::Int64: {
+                const auto* number = std::get_if<int64_t>(&row[c]);
+                if (!number) {
+                    throw std::runtime_error("Columnar column " + schema_[c].name + " expects an integer");
+                }
+                buffer.ints.push_back(*number);
+                break;
+            }
+        }
+    }
+    ++rows_written_;
+    if (++pending_rows_ == batch_rows_) {
+        write_batch();
+    }
+}
+
+void ColumnarWriter::write_batch() {
+    if (pending_rows_ == 0) {
+        return;
+    }
+    batch_offsets_.push_back(position_);
+    const uint64_t rows = pending_rows_;
+    write_bytes(&rows, sizeof(rows));
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+        auto& buffer = buffers_[c];
+        switch (schema_[c].type) {
+            case ColumnType::String:
+                write_bytes(buffer.offsets.data(), buffer.offsets.size() * sizeof(uint64_t));
+                write_bytes(buffer.bytes.data(), buffer.bytes.size());
+                pad();
+                buffer.offsets.assign(1, 0);
+                buffer.bytes.clear();
+                break;
+            case ColumnType::Float64:
+                write_bytes(buffer.floats.data(), buffer.floats.size() * sizeof(double));
+                buffer.floats.clear();
+                break;
+            case ColumnType::Int64:
+                write_bytes(buffer.ints.data(), buffer.ints.size() * sizeof(int64_t));
+                buffer.ints.clear();
+                break;
+        }
+    }
+    pending_rows_ = 0;
+}
+
+void ColumnarWriter::finish() {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    write_batch();
+    const uint64_t count = batch_offsets_.size();
+    write_bytes(batch_offsets_.data(), batch_offsets_.size() * sizeof(uint64_t));
+    write_bytes(&count, sizeof(count));
+    write_bytes(kMagic, sizeof(kMagic));
+    stream_.flush();
+    if (!stream_) {
+        throw std::runtime_error("Failed to write columnar output");
+    }
+}
+
+void ColumnarWriter::write_bytes(const void* data, std::size_t size) {
+    stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    position_ += size;
+}
+
+void ColumnarWriter::pad() {
+    static constexpr char zeros[8] = {};
+    write_bytes(zeros, padded(position_) - position_);
+}
+
+ColumnarTable::ColumnarTable(const std::filesystem::path& path) {
+    std::size_t size = 0;
+    storage_ = map_file(path, size);
+    if (!storage_) {
+        throw std::runtime_error("Failed to read columnar table: " + path.string());
+    }
+    Reader reader(static_cast<const std::byte*>(storage_.get()), size);
+    if (size < 32 || std::memcmp(reader.at(0, 8), kMagic, 8) != 0 ||
+        std::memcmp(reader.at(size - 8, 8), kMagic, 8) != 0 || reader.read<uint32_t>(8) != kFormatVersion) {
+        throw std::runtime_error("Not a complete columnar table: " + path.string());
+    }
+
+    const uint32_t column_count = reader.read<uint32_t>(12);
+    std::size_t offset = 16;
+    for (uint32_t c = 0; c < column_count; ++c) {
+        const auto type = reader.read<uint64_t>(offset);
+        const auto length = reader.read<uint64_t>(offset + 8);
+        if (type > static_cast<uint64_t>(ColumnType::Int64)) {
+            throw std::runtime_error("Unknown column type in columnar table");
+        }
+        const auto* name = reader.at(offset + 16, length);
+        columns_.push_back({std::string(reinterpret_cast<const char*>(name), length), static_cast<ColumnType>(type)});
+        offset = padded(offset + 16 + length);
+    }
+
+    const auto batch_count = reader.read<uint64_t>(size - 16);
+    if (batch_count > (size - 16) / 8) {
+        throw std::runtime_error("Columnar table is truncated or malformed");
+    }
+    const std::size_t index = size - 16 - batch_count * 8;
+    for (uint64_t b = 0; b < batch_count; ++b) {
+        std::size_t at = reader.read<uint64_t>(index + b * 8);
+        Batch batch;
+        batch.rows = reader.read<uint64_t>(at);
+        if (batch.rows > size) {
+            throw std::runtime_error("Columnar table is truncated or malformed");
+        }
+        at += 8;
+        for (const auto& column : columns_) {
+            if (column.type == ColumnType::String) {
+                const auto* offsets = reader.at(at, (batch.rows + 1) * 8);
+                const auto bytes = reader.read<uint64_t>(at + batch.rows * 8);
+                batch.columns.push_back(offsets);
+                reader.at(at + (batch.rows + 1) * 8, bytes);
+                at = padded(at + (batch.rows + 1) * 8 + bytes);
+            } else {
+                batch.columns.push_back(reader.at(at, batch.rows * 8));
+                at += batch.rows * 8;
+            }
+        }
+        batches_.push_back(std::move(batch));
+    }
+}
+
+std::size_t ColumnarTable::column_index(std::string_view name) const {
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+        if (columns_[c].name == name) {
+            return c;
+        }
+    }
+    throw std::runtime_error("Columnar table has no column: " + std::string(name));
+}
+
+std::size_t ColumnarTable::rows() const {
+    std::size_t total = 0;
+    for (const auto& batch : batches_) {
+        total += batch.rows;
+    }
+    return total;
+}
+
+const std::byte* ColumnarTable::column_data(std::size_t batch, std::size_t column, ColumnType type) const {
+    if (columns_.at(column).type != type) {
+        throw std::runtime_error("Columnar column " + columns_[column].name + " has a different type");
+    }
+    return batches_.at(batch).columns[column];
+}
+
+std::span<const double> ColumnarTable::float64(std::size_t batch, std::size_t column) const {
+    const auto* data = column_data(batch, column, ColumnType::Float64);
+    return {reinterpret_cast<const double*>(data), batches_[batch].rows};
+}
+
+std::span<const int64_t> ColumnarTable::int64(std::size_t batch, std::size_t column) const {
+    const auto* data = column_data(batch, column, ColumnType::Int64);
+    return {reinterpret_cast<const int64_t*>(data), batches_[batch].rows};
+}
+
+std::string_view ColumnarTable::string(std::size_t batch, std::size_t column, std::size_t row) const {
+    const auto* data = column_data(batch, column, ColumnType::String);
+    const std::size_t rows = batches_[batch].rows;
+    if (row >= rows) {
+        throw std::runtime_error("Columnar row index out of range");
+    }
+    const auto* offsets = reinterpret_cast<const uint64_t*>(data);
+    const auto* bytes = reinterpret_cast<const char*>(data + (rows + 1) * 8);
+    if (offsets[row] > offsets[row + 1] || offsets[row + 1] > offsets[rows]) {
+        throw std::runtime_error("Columnar table is truncated or malformed");
+    }
+    return {bytes + offsets[row], offsets[row + 1] - offsets[row]};
+}
+
+} // namespace fpstudy::core
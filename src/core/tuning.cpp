@@ -0,0 +1,140 @@
+#include "core/tuning.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "core/io.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace fpstudy::core {
+
+namespace {
+
+const json::Value& profile_field(const json::Object& object, const std::string& key) {
+    auto it = object.find(key);
+    if (it == object.end()) {
+        throw std::runtime_error("Backend profile entry is missing \"" + key + "\"");
+    }
+    return it->second;
+}
+
+json::Value kernel_to_json(const TunedKernel& kernel) {
+    json::Array timings;
+    for (const auto& timing : kernel.timings) {
+        json::Object entry;
+        entry.emplace("backend", json::Value(timing.backend));
+        entry.emplace("ms", json::Value(timing.ms));
+        entry.emplace("exact", json::Value(timing.exact));
+        timings.emplace_back(std::move(entry));
+    }
+    json::Object object;
+    object.emplace("algo", json::Value(kernel.algo));
+    object.emplace("precision", json::Value(kernel.precision));
+    object.emplace("size", json::Value(static_cast<double>(kernel.size)));
+    object.emplace("backend", json::Value(kernel.backend));
+    object.emplace("timings", json::Value(std::move(timings)));
+    return json::Value(std::move(object));
+}
+
+} // namespace
+
+BackendProfile BackendProfile::load(const std::filesystem::path& path) {
+    if (!std::filesystem::exists(path)) {
+        throw std::runtime_error("Backend profile not found: " + path.string());
+    }
+    const auto root = json::load_file(path);
+    if (!root.is_object()) {
+        throw std::runtime_error("Backend profile must be a JSON object: " + path.string());
+    }
+    const auto& object = root.as_object();
+    BackendProfile profile(profile_field(object, "host").as_string());
+    for (const auto& entry : profile_field(object, "kernels").as_array()) {
+        const auto& fields = entry.as_object();
+        TunedKernel kernel;
+        kernel.algo = profile_field(fields, "algo").as_string();
+        kernel.precision = profile_field(fields, "precision").as_string();
+        kernel.size = static_cast<std::size_t>(profile_field(fields, "size").as_number());
+        for (const auto& timing : profile_field(fields, "timings").as_array()) {
+            const auto& timing_fields = timing.as_object();
+            kernel.timings.push_back({profile_field(timing_fields, "backend").as_string(),
+                                      profile_field(timing_fields, "ms").as_number(),
+                                      profile_field(timing_fields, "exact").as_bool()});
+        }
+        profile.record(std::move(kernel));
+    }
+    return profile;
+}
+
+void BackendProfile::save(const std::filesystem::path& path) const {
+    std::string text = "{\"host\":" + json::serialize_compact(json::Value(host_)) + ",\"kernels\":[\n";
+    bool first = true;
+    for (const auto& [key, kernel] : kernels_) {
+        if (!first) {
+            text += ",\n";
+        }
+        first = false;
+        text += json::serialize_compact(kernel_to_json(kernel));
+    }
+    text += "\n]}\n";
+
+    auto temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << text;
+        if (!out) {
+            throw std::runtime_error("Failed to write backend profile: " + temp.string());
+        }
+    }
+    std::filesystem::rename(temp, path);
+}
+
+void BackendProfile::record(TunedKernel kernel) {
+    const BackendTiming* fastest = nullptr;
+    for (const auto& timing : kernel.timings) {
+        if (timing.exact && (!fastest || timing.ms < fastest->ms)) {
+            fastest = &timing;
+        }
+    }
+    if (!fastest) {
+        throw std::runtime_error("Backend profile: no exact backend for " + kernel.algo + "/" + kernel.precision +
+                                 "/" + std::to_string(kernel.size));
+    }
+    kernel.backend = fastest->backend;
+    Key key{kernel.algo, kernel.precision, kernel.size};
+    kernels_.insert_or_assign(std::move(key), std::move(kernel));
+}
+
+const std::string* BackendProfile::backend_for(std::string_view algo, std::string_view precision,
+                                               std::size_t size) const {
+    auto it = kernels_.find(std::tuple<std::string_view, std::string_view, std::size_t>(algo, precision, size));
+    return it == kernels_.end() ? nullptr : &it->second.backend;
+}
+
+std::vector<const TunedKernel*> BackendProfile::kernels() const {
+    std::vector<const TunedKernel*> result;
+    result.reserve(kernels_.size());
+    for (const auto& [key, kernel] : kernels_) {
+        result.push_back(&kernel);
+    }
+    return result;
+}
+
+std::string host_name() {
+#if defined(__unix__) || defined(__APPLE__)
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0') {
+        return name;
+    }
+#endif
+    return "unknown";
+}
+
+std::filesystem::path default_profile_path() {
+    return "fpstudy-profile-" + host_name() + ".json";
+}
+
+} // namespace fpstudy::core
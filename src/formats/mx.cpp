@@ -0,0 +1,94 @@
+#include "formats/mx.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace fpstudy::formats {
+
+namespace {
+
+// Exponent of the largest finite element value, the one encoding saturates
+// to (the top exponent field is reserved).
+int element_emax(const MiniFloatFormat& format) {
+    return std::ilogb(format.decode(format.encode(std::numeric_limits<float>::max())));
+}
+
+// Calls fn(begin, end, block) for every block of a vector of `size` elements
+// in rows of `row_length`.
+template <typename Fn>
+void for_each_block(std::size_t size, std::size_t row_length, Fn&& fn) {
+    std::size_t block = 0;
+    for (std::size_t row = 0; row < size; row += row_length) {
+        for (std::size_t begin = row; begin < row + row_length; begin += kMxBlockSize) {
+            fn(begin, std::min(begin + kMxBlockSize, row + row_length), block++);
+        }
+    }
+}
+
+} // namespace
+
+MxVector MxVector::encode(const P3109Layout& layout, std::span<const double> input, std::size_t row_length) {
+    MxVector out;
+    out.assign(layout, input, row_length);
+    return out;
+}
+
+void MxVector::assign(const P3109Layout& layout, std::span<const double> input, std::size_t row_length) {
+    if (row_length == 0) {
+        row_length = input.size();
+    }
+    if (row_length != 0 && input.size() % row_length != 0) {
+        throw std::runtime_error("MxVector: input must hold a whole number of rows");
+    }
+    format_ = &MiniFloatFormat::get(layout);
+    row_length_ = row_length;
+    codes_.resize(input.size());
+    scales_.resize(row_length_ == 0 ? 0 : input.size() / row_length_ * blocks_per_row());
+    const int emax = element_emax(*format_);
+    for_each_block(input.size(), row_length_, [&](std::size_t begin, std::size_t end, std::size_t block) {
+        double amax = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            if (std::isfinite(input[i])) {
+                amax = std::max(amax, std::abs(input[i]));
+            }
+        }
+        const int shared = std::clamp(amax > 0.0 ? std::ilogb(amax) - emax : 0, -kMxScaleBias, kMxScaleBias);
+        scales_[block] = static_cast<uint8_t>(shared + kMxScaleBias);
+        for (std::size_t i = begin; i < end; ++i) {
+            codes_[i] = format_->encode(static_cast<float>(std::ldexp(input[i], -shared)));
+        }
+    });
+}
+
+void MxVector::decode(std::span<double> out) const {
+    check_size(out.size());
+    for_each_block(codes_.size(), row_length_, [&](std::size_t begin, std::size_t end, std::size_t block) {
+        const int exponent = scale_exponent(block);
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = std::ldexp(static_cast<double>(format_->decode(codes_[i])), exponent);
+        }
+    });
+}
+
+std::vector<double> MxVector::to_doubles() const {
+    std::vector<double> out(codes_.size());
+    decode(out);
+    return out;
+}
+
+void MxVector::decode_elements(std::span<float> out) const {
+    check_size(out.size());
+    for (std::size_t i = 0; i < codes_.size(); ++i) {
+        out[i] = format_->decode(codes_[i]);
+    }
+}
+
+void MxVector::check_size(std::size_t n) const {
+    if (n != codes_.size()) {
+        throw std::runtime_error("MxVector decode: output size mismatch");
+    }
+}
+
+} // namespace fpstudy::formats
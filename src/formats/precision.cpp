@@ -2,6 +2,10 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace fpstudy::formats {
@@ -16,8 +20,95 @@ std::string to_lower(std::string_view name) {
     return result;
 }
 
+// Reads a decimal integer at `pos` and advances past it.
+bool parse_int(std::string_view text, std::size_t& pos, int& value) {
+    const char* begin = text.data() + pos;
+    const char* end = text.data() + text.size();
+    if (begin != end && *begin == '+') {
+        return false;
+    }
+    const auto result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc{} || result.ptr == begin) {
+        return false;
+    }
+    pos = static_cast<std::size_t>(result.ptr - text.data());
+    return true;
+}
+
+// "e<E>m<M>" optionally followed by ":bias<B>".
+P3109Layout parse_minifloat(std::string_view spec, std::string_view name) {
+    auto fail = [&](const std::string& why) -> P3109Layout {
+        throw std::runtime_error("Invalid precision '" + std::string(name) + "': " + why);
+    };
+    std::size_t pos = 0;
+    int exponent_bits = 0;
+    int mantissa_bits = 0;
+    if (pos >= spec.size() || spec[pos++] != 'e' || !parse_int(spec, pos, exponent_bits) ||
+        pos >= spec.size() || spec[pos++] != 'm' || !parse_int(spec, pos, mantissa_bits)) {
+        return fail("expected e<E>m<M>[:bias<B>] after the prefix");
+    }
+    if (exponent_bits < 2 || mantissa_bits < 1 || 1 + exponent_bits + mantissa_bits > 8) {
+        return fail("need at least 2 exponent bits, 1 mantissa bit and at most 8 bits in total");
+    }
+    int bias = (1 << (exponent_bits - 1)) - 1;
+    if (pos < spec.size()) {
+        constexpr std::string_view kBias = ":bias";
+        if (spec.substr(pos, kBias.size()) != kBias) {
+            return fail("expected :bias<B> after the layout");
+        }
+        pos += kBias.size();
+        if (!parse_int(spec, pos, bias) || pos != spec.size()) {
+            return fail("expected an integer bias");
+        }
+    }
+    if (bias < -128 || bias > 127) {
+        return fail("bias out of range");
+    }
+    const P3109Layout layout{static_cast<uint8_t>(exponent_bits), static_cast<uint8_t>(mantissa_bits),
+                             static_cast<int8_t>(bias)};
+    if (!minifloat_layout_valid(layout)) {
+        return fail("exponent range does not fit in FP32 normals");
+    }
+    return layout;
+}
+
+std::array<float, 256> build_decode_table(const P3109Layout& layout) {
+    std::array<float, 256> table{};
+    for (int code = 0; code < (1 << layout.width()); ++code) {
+        table[code] = detail::minifloat_decode(static_cast<uint8_t>(code), layout);
+    }
+    return table;
+}
+
 } // namespace
 
+MiniFloatFormat::MiniFloatFormat(const P3109Layout& format_layout)
+    : layout(format_layout),
+      decode_table_(build_decode_table(format_layout)),
+      accumulate_fp32_(*this),
+      round_each_op_(*this) {}
+
+const MiniFloatFormat& MiniFloatFormat::get(const P3109Layout& layout) {
+    if (!minifloat_layout_valid(layout)) {
+        throw std::runtime_error("Invalid minifloat layout: " + precision_to_string(minifloat_precision(layout)));
+    }
+    static std::mutex mutex;
+    static std::map<Precision, std::unique_ptr<const MiniFloatFormat>> formats;
+    std::lock_guard lock(mutex);
+    auto& format = formats[minifloat_precision(layout)];
+    if (!format) {
+        format.reset(new MiniFloatFormat(layout));
+    }
+    return *format;
+}
+
+const MiniFloatFormat& active_minifloat_format() {
+    if (detail::active_minifloat == nullptr) {
+        throw std::runtime_error("Runtime minifloat used outside a MiniFloatScope");
+    }
+    return *detail::active_minifloat;
+}
+
 std::string precision_to_string(Precision p) {
     switch (p) {
         case Precision::FP64: return "fp64";
@@ -25,6 +116,12 @@ std::string precision_to_string(Precision p) {
         case Precision::TF32: return "tf32";
         case Precision::BF16: return "bf16";
         case Precision::P3109_8: return "p3109_8";
+        case Precision::MiniFloatRuntime: return "minifloat";
+    }
+    if (is_minifloat_precision(p) || is_mx_precision(p)) {
+        const auto layout = minifloat_layout(p);
+        return std::string(is_mx_precision(p) ? "mx" : "minifloat") + ":e" + std::to_string(layout.exponent_bits) +
+               "m" + std::to_string(layout.mantissa_bits) + ":bias" + std::to_string(layout.exponent_bias);
     }
     throw std::runtime_error("Unknown precision enum");
 }
@@ -44,6 +141,14 @@ Precision precision_from_string(std::string_view name) {
     };
 
     auto lower = to_lower(name);
+    constexpr std::string_view kMiniFloat = "minifloat:";
+    constexpr std::string_view kMx = "mx:";
+    if (std::string_view(lower).substr(0, kMiniFloat.size()) == kMiniFloat) {
+        return minifloat_precision(parse_minifloat(std::string_view(lower).substr(kMiniFloat.size()), name));
+    }
+    if (std::string_view(lower).substr(0, kMx.size()) == kMx) {
+        return mx_precision(parse_minifloat(std::string_view(lower).substr(kMx.size()), name));
+    }
     auto it = map.find(lower);
     if (it == map.end()) {
         throw std::runtime_error("Unknown precision string: " + std::string(name));
@@ -1,17 +1,43 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 
+#include "core/arena.hpp"
+#include "core/cache.hpp"
 #include "core/io.hpp"
+#include "core/manifest.hpp"
 #include "core/metrics.hpp"
 #include "core/random.hpp"
+#include "core/scheduler.hpp"
+#include "core/shard.hpp"
+#include "core/spd.hpp"
+#include "core/table.hpp"
+#include "core/tuning.hpp"
 #include "algorithms/matmul.hpp"
 #include "algorithms/gradient_descent.hpp"
 #include "algorithms/newton.hpp"
+#include "algorithms/fft.hpp"
 #include "algorithms/fir.hpp"
+#include "algorithms/mx.hpp"
+#include "algorithms/packed.hpp"
+#include "formats/dispatch.hpp"
+#include "formats/mx.hpp"
+#include "formats/packed.hpp"
 #include "formats/precision.hpp"
 
 using fpstudy::core::CsvWriter;
@@ -28,6 +54,39 @@ const std::vector<std::string> kCsvHeader = {
     "converged", "n_nan", "n_inf", "elapsed_ms"
 };
 
+// Hardware counts of each row's timed region, appended by --perf-counters.
+const std::vector<std::string> kPerfCounterColumns = {
+    "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+std::vector<std::string> csv_header() {
+    auto header = kCsvHeader;
+    if (core::perf_counters_enabled()) {
+        header.insert(header.end(), kPerfCounterColumns.begin(), kPerfCounterColumns.end());
+    }
+    return header;
+}
+
+// Column types of csv_header() for the binary output.
+std::vector<core::ColumnSpec> results_schema() {
+    using core::ColumnType;
+    const ColumnType types[] = {
+        ColumnType::String, ColumnType::String, ColumnType::String, ColumnType::Int64,
+        ColumnType::String, ColumnType::Float64, ColumnType::Int64,
+        ColumnType::Int64, ColumnType::Int64, ColumnType::Int64, ColumnType::Float64
+    };
+    std::vector<core::ColumnSpec> schema;
+    for (std::size_t i = 0; i < kCsvHeader.size(); ++i) {
+        schema.push_back({kCsvHeader[i], types[i]});
+    }
+    if (core::perf_counters_enabled()) {
+        for (const auto& column : kPerfCounterColumns) {
+            schema.push_back({column, ColumnType::Int64});
+        }
+    }
+    return schema;
+}
+
 const json::Value& require_field(const json::Object& obj, const std::string& key) {
     auto it = obj.find(key);
     if (it == obj.end()) {
@@ -36,10 +95,15 @@ const json::Value& require_field(const json::Object& obj, const std::string& key
     return it->second;
 }
 
-std::vector<fmt::Precision> parse_precisions(const json::Value& value) {
+// Block-scaled mx precisions have no per-element type; only algorithms with
+// MX kernels (matmul, fir) accept them.
+std::vector<fmt::Precision> parse_precisions(const json::Value& value, bool allow_mx = false) {
     std::vector<fmt::Precision> result;
     for (const auto& entry : value.as_array()) {
         result.push_back(fmt::precision_from_string(entry.as_string()));
+        if (fmt::is_mx_precision(result.back()) && !allow_mx) {
+            throw std::runtime_error("Precision " + entry.as_string() + " is block-scaled; only matmul and fir run mx precisions");
+        }
     }
     return result;
 }
@@ -70,29 +134,217 @@ std::vector<double> parse_double_list(const json::Value& value) {
     return result;
 }
 
+// Kernel backend of an experiment's cells. A configured backend applies to
+// every cell; without one, each cell takes the profile's backend for its
+// (algo, precision, size) and otherwise the reference.
+struct BackendChoice {
+    std::optional<alg::Backend> configured;
+    const core::BackendProfile* profile = nullptr;
+
+    alg::Backend for_cell(const std::string& algo, fmt::Precision precision, std::size_t size) const {
+        if (configured) {
+            return *configured;
+        }
+        if (profile) {
+            if (const auto* name = profile->backend_for(algo, fmt::precision_to_string(precision), size)) {
+                return alg::backend_from_string(*name);
+            }
+        }
+        return alg::Backend::Reference;
+    }
+};
+
+// Optional "backend" field selecting the kernel implementation; "auto", like
+// leaving it out, defers to the backend profile. Backends are bit-identical,
+// so the choice is not recorded in params_json.
+BackendChoice parse_backend(const json::Object& exp, const core::BackendProfile* profile) {
+    auto it = exp.find("backend");
+    if (it == exp.end() || it->second.as_string() == "auto") {
+        return {std::nullopt, profile};
+    }
+    auto backend = alg::backend_from_string(it->second.as_string());
+    if (backend == alg::Backend::Vectorized) {
+        static const bool warned = [] {
+            if (!fmt::fp32_emulation_verified<fmt::TF32>() || !fmt::fp32_emulation_verified<fmt::BF16>()) {
+                std::cerr << "warning: FP32 emulation does not match cfloat on this build; "
+                             "vectorized backend falls back to the blocked matmul kernel and the "
+                             "reference fir and gd_quadratic loops\n";
+            }
+            return true;
+        }();
+        (void)warned;
+    }
+    return {backend, profile};
+}
+
+// Optional "rng": "mt19937" (default) or "philox" (core/random.hpp). The
+// generator changes every input, so philox is recorded in params_json and in
+// the truth cache key.
+core::RngKind parse_rng(const json::Object& exp) {
+    auto it = exp.find("rng");
+    return it == exp.end() ? core::RngKind::MT19937 : core::rng_kind_from_string(it->second.as_string());
+}
+
+void record_rng(json::Object& params, core::RngKind rng) {
+    if (rng != core::RngKind::MT19937) {
+        params.emplace("rng", json::Value(core::rng_kind_to_string(rng)));
+    }
+}
+
+void record_rng(core::CacheKey& key, core::RngKind rng) {
+    if (rng != core::RngKind::MT19937) {
+        key.add_string("rng", core::rng_kind_to_string(rng));
+    }
+}
+
+void record_split_k(json::Object& params, std::size_t split_k) {
+    if (split_k > 1) {
+        params.emplace("split_k", json::Value(static_cast<double>(split_k)));
+    }
+}
+
 std::vector<std::vector<double>> build_spd_cases(std::size_t dim,
                                                  std::size_t trials,
                                                  uint32_t base_seed,
-                                                 bool ill_conditioned) {
+                                                 bool ill_conditioned,
+                                                 const core::SpdOptions& spd = {},
+                                                 core::RngKind rng_kind = core::RngKind::MT19937) {
     std::vector<std::vector<double>> cases;
     cases.reserve(trials);
     for (std::size_t t = 0; t < trials; ++t) {
-        core::Random rng(base_seed + static_cast<uint32_t>(t * 17 + dim * 13));
-        auto M = core::random_matrix(dim, dim, rng, ill_conditioned);
-        std::vector<double> Q(dim * dim, 0.0);
-        for (std::size_t i = 0; i < dim; ++i) {
-            for (std::size_t j = 0; j < dim; ++j) {
-                double acc = 0.0;
-                for (std::size_t k = 0; k < dim; ++k) {
-                    acc += M[k * dim + i] * M[k * dim + j];
+        core::Random rng(base_seed + static_cast<uint32_t>(t * 17 + dim * 13), rng_kind);
+        cases.push_back(core::make_spd(dim, rng, ill_conditioned, spd));
+    }
+    return cases;
+}
+
+// Shared state for scheduling one sweep. Rows are numbered in the order the
+// serial driver would have produced them, so the ordered sink can reassemble
+// the CSV identically no matter how many workers run the cells.
+struct SweepContext {
+    core::ThreadPool& pool;
+    core::OrderedRowSink& sink;
+    const core::TruthCache& cache;
+    const core::SweepManifest& completed;
+    uint32_t base_seed;
+    core::ShardSpec shard;
+    // --pipeline: the data stage and how many units it may run ahead.
+    core::ThreadPool* data_stage = nullptr;
+    std::size_t lookahead = 0;
+    // Backend profile for experiments without a "backend", if one was found.
+    const core::BackendProfile* profile = nullptr;
+    std::size_t next_row = 0;
+    std::size_t next_unit = 0;
+    std::deque<std::function<void()>> staged;
+
+    // Reserves the rows of one trial unit. Returns nullopt, and releases the
+    // rows from the sink, when --shard assigns the unit to another process.
+    std::optional<std::size_t> reserve_unit(std::size_t count) {
+        std::size_t first = next_row;
+        next_row += count;
+        if (!shard.owns(next_unit++)) {
+            for (std::size_t row = first; row < next_row; ++row) {
+                sink.skip(row);
+            }
+            return std::nullopt;
+        }
+        return first;
+    }
+
+    // Submits one trial unit in two steps: prepare() plans the cells and
+    // builds the trial's inputs and truth, and returns the step that submits
+    // the cells (empty when none is pending). Without a data stage both run
+    // in one pool task. With one, prepare() runs on the data thread and the
+    // cell step joins the pool only once `lookahead` later units have gone
+    // to the data stage, so their generation overlaps this unit's cells.
+    void submit_unit(std::function<std::function<void()>()> prepare) {
+        if (!data_stage) {
+            pool.submit([prepare = std::move(prepare)] {
+                if (auto run = prepare()) {
+                    run();
                 }
-                if (i == j) acc += dim * 0.1;
-                Q[i * dim + j] = acc;
+            });
+            return;
+        }
+        auto task = std::make_shared<std::packaged_task<std::function<void()>()>>(std::move(prepare));
+        staged.push_back([ready = task->get_future().share()] {
+            if (const auto& run = ready.get()) {
+                run();
             }
+        });
+        data_stage->submit([task] { (*task)(); });
+        while (staged.size() > lookahead) {
+            release_staged();
         }
-        cases.push_back(std::move(Q));
     }
-    return cases;
+
+    // Hands every staged cell step to the pool.
+    void flush_units() {
+        while (!staged.empty()) {
+            release_staged();
+        }
+    }
+
+private:
+    void release_staged() {
+        auto run = std::move(staged.front());
+        staged.pop_front();
+        pool.submit(std::move(run));
+    }
+};
+
+// Identity of one output row across runs, for --resume: algo, size,
+// precision and seed plus every params entry in key order.
+uint64_t cell_hash(const std::string& algo,
+                   const std::string& size_str,
+                   fmt::Precision precision,
+                   uint32_t seed,
+                   const json::Object& params) {
+    std::vector<const json::Object::value_type*> entries;
+    entries.reserve(params.size());
+    for (const auto& entry : params) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+    core::CacheKey key("cell");
+    key.add_string("algo", algo)
+        .add_string("size", size_str)
+        .add_string("precision", fmt::precision_to_string(precision))
+        .add_int("seed", seed);
+    for (const auto* entry : entries) {
+        key.add_string(entry->first, json::serialize_compact(entry->second));
+    }
+    return key.hash();
+}
+
+// One row of a trial, planned before any input data exists.
+struct PlannedCell {
+    json::Object params;
+    fmt::Precision precision;
+    bool accumulate = false;
+    std::size_t row = 0;
+};
+
+// Drops the cells an earlier run already wrote and releases their rows from
+// the sink, returning the cells that still have to run.
+std::vector<PlannedCell> pending_cells(std::vector<PlannedCell> cells,
+                                       const std::string& algo,
+                                       const std::string& size_str,
+                                       uint32_t seed,
+                                       const core::SweepManifest& completed,
+                                       core::OrderedRowSink& sink) {
+    if (completed.size() == 0) {
+        return cells;
+    }
+    std::vector<PlannedCell> pending;
+    for (auto& cell : cells) {
+        if (completed.contains(cell_hash(algo, size_str, cell.precision, seed, cell.params))) {
+            sink.skip(cell.row);
+        } else {
+            pending.push_back(std::move(cell));
+        }
+    }
+    return pending;
 }
 
 template <typename T>
@@ -101,459 +353,1678 @@ core::RunMetrics emit_run(const json::Object& params,
                           const std::string& size_str,
                           fmt::Precision precision,
                           uint32_t seed,
-                          CsvWriter& writer,
-                          const std::vector<double>& truth,
-                          const std::vector<T>& result,
+                          core::OrderedRowSink& sink,
+                          std::size_t row_index,
+                          std::span<const double> truth,
+                          std::span<const T> result,
                           std::size_t iterations,
                           bool converged,
-                          double elapsed_ms) {
+                          const core::TimedRegion& timing) {
+    precision = fmt::resolve_precision(precision);
+    auto errors = core::compute_metrics(truth, result);
+    uint64_t cell = sink.tracks_cells() ? cell_hash(algo_name, size_str, precision, seed, params) : 0;
     core::RunMetrics metrics;
-    metrics.relative_error = core::relative_error(truth, fmt::to_double_vector(result));
+    metrics.relative_error = errors.relative_error;
     metrics.iterations = static_cast<int>(iterations);
     metrics.converged = converged;
-    metrics.nan_count = core::count_nan(result);
-    metrics.inf_count = core::count_inf(result);
-    metrics.elapsed_ms = elapsed_ms;
+    metrics.nan_count = errors.nan_count;
+    metrics.inf_count = errors.inf_count;
+    metrics.elapsed_ms = timing.elapsed_ms;
+    metrics.counters = timing.counters;
 
     json::Object params_obj = params;
     params_obj.emplace("precision", json::Value(fmt::precision_to_string(precision)));
     auto params_json = json::serialize_compact(json::Value(params_obj));
 
-    writer.write_row({
+    core::Row fields{
         algo_name,
         size_str,
         fmt::precision_to_string(precision),
-        std::to_string(seed),
-        params_json,
-        std::to_string(metrics.relative_error),
-        std::to_string(metrics.iterations),
-        metrics.converged ? "1" : "0",
-        std::to_string(metrics.nan_count),
-        std::to_string(metrics.inf_count),
-        std::to_string(metrics.elapsed_ms)
-    });
+        static_cast<int64_t>(seed),
+        std::move(params_json),
+        metrics.relative_error,
+        static_cast<int64_t>(metrics.iterations),
+        static_cast<int64_t>(metrics.converged ? 1 : 0),
+        static_cast<int64_t>(metrics.nan_count),
+        static_cast<int64_t>(metrics.inf_count),
+        metrics.elapsed_ms
+    };
+    if (core::perf_counters_enabled()) {
+        fields.insert(fields.end(), {
+            metrics.counters.cycles,
+            metrics.counters.instructions,
+            metrics.counters.cache_misses,
+            metrics.counters.branch_misses
+        });
+    }
+    sink.push(row_index, std::move(fields), cell);
     return metrics;
 }
 
-} // namespace
+template <typename T>
+core::RunMetrics emit_run(const json::Object& params,
+                          const std::string& algo_name,
+                          const std::string& size_str,
+                          fmt::Precision precision,
+                          uint32_t seed,
+                          core::OrderedRowSink& sink,
+                          std::size_t row_index,
+                          const std::vector<double>& truth,
+                          const std::vector<T>& result,
+                          std::size_t iterations,
+                          bool converged,
+                          const core::TimedRegion& timing) {
+    return emit_run(params, algo_name, size_str, precision, seed, sink, row_index,
+                    std::span<const double>(truth), std::span<const T>(result), iterations, converged, timing);
+}
 
-int main(int argc, char** argv) {
-    std::optional<std::filesystem::path> config_path;
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
-            config_path = argv[++i];
-        } else if (arg == "--help" || arg == "-h") {
-            std::cout << "Usage: fpstudy --config path/to/config.json\n";
-            return 0;
+// Conversion buffers of the calling worker, reused by every cell it runs.
+fmt::ConversionBuffers<3>& conversion_buffers() {
+    thread_local fmt::ConversionBuffers<3> buffers;
+    return buffers;
+}
+
+// MX operands of the calling worker, reused the same way.
+std::array<fmt::MxVector, 2>& mx_buffers() {
+    thread_local std::array<fmt::MxVector, 2> buffers;
+    return buffers;
+}
+
+// B transposed, so MX blocks of B run along k like those of A.
+std::pmr::vector<double> transpose_square(std::span<const double> B, std::size_t n, std::pmr::memory_resource* scratch) {
+    std::pmr::vector<double> Bt(B.size(), scratch);
+    for (std::size_t base = 0; base < B.size(); base += n * n) {
+        for (std::size_t k = 0; k < n; ++k) {
+            for (std::size_t j = 0; j < n; ++j) {
+                Bt[base + j * n + k] = B[base + k * n + j];
+            }
+        }
+    }
+    return Bt;
+}
+
+// Runs kernel(a, b, out) on the P3109Number instantiation selected by
+// accumulate_in_fp32 and writes the result to values as doubles. Packed
+// operands hold the default policy, so the other policy gets a code copy made
+// before the timer starts. Temporaries come from scratch.
+template <typename Number, typename Kernel>
+void run_p3109_kernel(bool accumulate_in_fp32,
+                      std::span<const Number> a,
+                      std::span<const Number> b,
+                      std::span<double> values,
+                      core::TimedRegion& timing,
+                      std::pmr::memory_resource* scratch,
+                      Kernel&& kernel) {
+    fmt::dispatch_accumulation(accumulate_in_fp32, [&](auto policy) {
+        using Policy = decltype(policy);
+        using T = fmt::rebind_policy_t<Number, Policy>;
+        auto time = [&](std::span<const T> lhs, std::span<const T> rhs) {
+            std::pmr::vector<T> result(values.size(), scratch);
+            core::ScopedTimer timer;
+            kernel(lhs, rhs, std::span<T>(result));
+            timing = timer.region();
+            for (std::size_t i = 0; i < result.size(); ++i) {
+                values[i] = static_cast<double>(result[i]);
+            }
+        };
+        if constexpr (std::is_same_v<T, Number>) {
+            time(a, b);
         } else {
-            std::cerr << "Unknown argument: " << arg << "\n";
-            return 1;
+            std::pmr::vector<T> lhs(a.begin(), a.end(), scratch);
+            std::pmr::vector<T> rhs(b.begin(), b.end(), scratch);
+            time(lhs, rhs);
         }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// matmul
+
+struct MatMulTrial {
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> truth;
+};
+
+// Encodes the operands in P, multiplies them and writes C to values as
+// doubles. Returns the timed region, which covers the product only. The
+// sweep cells and `fpstudy tune` both measure through here. opts.scratch
+// must be set.
+template <fmt::Precision P>
+core::TimedRegion compute_matmul(std::span<const double> A_values,
+                                 std::span<const double> B_values,
+                                 int size,
+                                 alg::MatMulOptions opts,
+                                 std::span<double> values) {
+    if constexpr (P == fmt::Precision::FP64) {
+        opts.accumulate_in_fp32 = false;
+    }
+    if constexpr (P == fmt::Precision::MiniFloatRuntime) {
+        // The runtime layout is active on this thread only.
+        opts.threads = 1;
     }
+    auto& buffers = conversion_buffers();
+    const auto& A = buffers.encode<P>(0, A_values);
+    const auto& B = buffers.encode<P>(1, B_values);
+    core::TimedRegion timing;
+    if constexpr (fmt::is_p3109_number_v<typename fmt::PrecisionTraits<P>::type>) {
+        run_p3109_kernel(opts.accumulate_in_fp32, A.values(), B.values(), values, timing, opts.scratch,
+                         [&]<typename T>(std::span<const T> a, std::span<const T> b, std::span<T> c) {
+                             alg::matmul_square_into<T>(a, b, size, c, opts);
+                         });
+    } else {
+        std::pmr::vector<typename fmt::PackedVector<P>::code_type> result(values.size(), opts.scratch);
+        core::ScopedTimer timer;
+        alg::matmul_square_into(A, B, size, std::span(result), opts);
+        timing = timer.region();
+        fmt::decode_codes<P>(result, values);
+    }
+    return timing;
+}
 
-    if (!config_path) {
-        std::cerr << "Config path required. Use --config <path>.\n";
-        return 1;
+template <fmt::Precision P>
+void run_matmul_cell(const json::Object& params,
+                     const std::string& algo,
+                     int size,
+                     uint32_t trial_seed,
+                     const MatMulTrial& data,
+                     alg::MatMulOptions opts,
+                     core::OrderedRowSink& sink,
+                     std::size_t row) {
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    std::pmr::vector<double> values(data.truth.size(), opts.scratch);
+    auto timing = compute_matmul<P>(data.A, data.B, size, opts, values);
+    emit_run(params, algo, std::to_string(size), P, trial_seed, sink, row,
+             std::span<const double>(data.truth), std::span<const double>(values), 0, true, timing);
+}
+
+// matmul on MX operands: A in rows of size, B transposed the same way.
+// Encoding happens before the timer, as for the packed formats.
+void run_matmul_mx_cell(const json::Object& params,
+                        const std::string& algo,
+                        int size,
+                        fmt::Precision precision,
+                        uint32_t trial_seed,
+                        const MatMulTrial& data,
+                        alg::MatMulOptions opts,
+                        core::OrderedRowSink& sink,
+                        std::size_t row) {
+    const std::size_t n = static_cast<std::size_t>(size);
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    const auto layout = fmt::mx_element_layout(precision);
+    auto& [A, Bt] = mx_buffers();
+    A.assign(layout, data.A, n);
+    Bt.assign(layout, transpose_square(data.B, n, opts.scratch), n);
+    std::pmr::vector<float> result(n * n, opts.scratch);
+    core::ScopedTimer timer;
+    alg::matmul_square_mx_into(A, Bt, n, result, opts);
+    auto timing = timer.region();
+    std::pmr::vector<double> values(result.begin(), result.end(), opts.scratch);
+    emit_run(params, algo, std::to_string(size), precision, trial_seed, sink, row,
+             std::span<const double>(data.truth), std::span<const double>(values), 0, true, timing);
+}
+
+// Generates (or loads from the cache) one trial's operands and FP64 truth.
+MatMulTrial make_matmul_trial(const core::TruthCache& cache, int size, uint32_t trial_seed,
+                              bool use_kahan, alg::Backend backend, core::RngKind rng_kind) {
+    MatMulTrial data;
+    core::CacheKey key("matmul");
+    key.add_int("size", size).add_int("trial_seed", trial_seed).add_bool("kahan", use_kahan);
+    record_rng(key, rng_kind);
+    if (auto hit = cache.load(key)) {
+        data.A = hit->vector("A");
+        data.B = hit->vector("B");
+        data.truth = hit->vector("truth");
+        return data;
+    }
+    fpstudy::core::Random rng(trial_seed, rng_kind);
+    data.A = core::random_matrix(size, size, rng);
+    data.B = core::random_matrix(size, size, rng);
+    data.truth = alg::matmul_square<double>(data.A, data.B, size, {use_kahan, false, backend});
+    if (cache.enabled()) {
+        core::CacheRecord record;
+        record.put("A", data.A);
+        record.put("B", data.B);
+        record.put("truth", data.truth);
+        cache.store(key, record);
     }
+    return data;
+}
 
-    auto config_value = json::load_file(*config_path);
-    const auto& root = config_value.as_object();
+// All trials of one size, stacked: trial t occupies [t * n * n, (t + 1) * n * n).
+struct MatMulBatch {
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> truth;
+    std::vector<uint32_t> seeds;
+};
 
-    uint32_t base_seed = static_cast<uint32_t>(require_field(root, "seed").as_number());
-    auto out_csv_path = std::filesystem::path(require_field(root, "out_csv").as_string());
-    const auto& experiments = require_field(root, "experiments").as_array();
+// Runs every trial of a batch in one matmul_batched call. Rows keep the
+// serial order (trial-major), so trial t goes to first_row + t * row_stride;
+// each row reports its share of the batch time. Trials with emit[t] false
+// were written by an earlier run and their rows were already released.
+template <fmt::Precision P>
+void run_matmul_batch_cell(const json::Object& base_params,
+                           const std::string& algo,
+                           int size,
+                           const MatMulBatch& data,
+                           alg::MatMulOptions opts,
+                           core::OrderedRowSink& sink,
+                           std::size_t first_row,
+                           std::size_t row_stride,
+                           const std::vector<bool>& emit) {
+    if constexpr (P == fmt::Precision::FP64) {
+        opts.accumulate_in_fp32 = false;
+    }
+    if constexpr (P == fmt::Precision::MiniFloatRuntime) {
+        opts.threads = 1;
+    }
+    const std::size_t batch = data.seeds.size();
+    const std::size_t stride = static_cast<std::size_t>(size) * static_cast<std::size_t>(size);
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    auto& buffers = conversion_buffers();
+    const auto& A = buffers.encode<P>(0, data.A);
+    const auto& B = buffers.encode<P>(1, data.B);
+    core::TimedRegion timing;
+    std::pmr::vector<double> values(batch * stride, opts.scratch);
+    if constexpr (fmt::is_p3109_number_v<typename fmt::PrecisionTraits<P>::type>) {
+        run_p3109_kernel(opts.accumulate_in_fp32, A.values(), B.values(), values, timing, opts.scratch,
+                         [&]<typename T>(std::span<const T> a, std::span<const T> b, std::span<T> c) {
+                             alg::matmul_batched_into<T>(a, b, size, batch, c, opts);
+                         });
+    } else {
+        std::pmr::vector<typename fmt::PackedVector<P>::code_type> result(values.size(), opts.scratch);
+        core::ScopedTimer timer;
+        alg::matmul_batched_into(A, B, size, batch, std::span(result), opts);
+        timing = timer.region();
+        fmt::decode_codes<P>(result, values);
+    }
+    timing = timing.share(batch);
+    for (std::size_t t = 0; t < batch; ++t) {
+        if (!emit[t]) {
+            continue;
+        }
+        json::Object params = base_params;
+        params.emplace("trial", json::Value(static_cast<double>(t)));
+        emit_run(params, algo, std::to_string(size), P, data.seeds[t], sink, first_row + t * row_stride,
+                 std::span<const double>(data.truth).subspan(t * stride, stride),
+                 std::span<const double>(values).subspan(t * stride, stride), 0, true, timing);
+    }
+}
 
-    CsvWriter writer(out_csv_path, false);
-    writer.write_header(kCsvHeader);
+// run_matmul_batch_cell for an mx precision.
+void run_matmul_mx_batch_cell(const json::Object& base_params,
+                              const std::string& algo,
+                              int size,
+                              fmt::Precision precision,
+                              const MatMulBatch& data,
+                              alg::MatMulOptions opts,
+                              core::OrderedRowSink& sink,
+                              std::size_t first_row,
+                              std::size_t row_stride,
+                              const std::vector<bool>& emit) {
+    const std::size_t n = static_cast<std::size_t>(size);
+    const std::size_t batch = data.seeds.size();
+    const std::size_t stride = n * n;
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    const auto layout = fmt::mx_element_layout(precision);
+    auto& [A, Bt] = mx_buffers();
+    A.assign(layout, data.A, n);
+    Bt.assign(layout, transpose_square(data.B, n, opts.scratch), n);
+    std::pmr::vector<float> result(batch * stride, opts.scratch);
+    core::ScopedTimer timer;
+    alg::matmul_batched_mx_into(A, Bt, n, batch, result, opts);
+    auto timing = timer.region().share(batch);
+    std::pmr::vector<double> values(result.begin(), result.end(), opts.scratch);
+    for (std::size_t t = 0; t < batch; ++t) {
+        if (!emit[t]) {
+            continue;
+        }
+        json::Object params = base_params;
+        params.emplace("trial", json::Value(static_cast<double>(t)));
+        emit_run(params, algo, std::to_string(size), precision, data.seeds[t], sink, first_row + t * row_stride,
+                 std::span<const double>(data.truth).subspan(t * stride, stride),
+                 std::span<const double>(values).subspan(t * stride, stride), 0, true, timing);
+    }
+}
 
-    for (const auto& exp_value : experiments) {
-        const auto& exp = exp_value.as_object();
-        const std::string algo = require_field(exp, "algo").as_string();
+void schedule_matmul(const json::Object& exp, const std::string& algo, SweepContext& ctx) {
+    auto sizes = parse_int_list(require_field(exp, "sizes"));
+    auto precisions = parse_precisions(require_field(exp, "precisions"), true);
+    auto trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : std::size_t(1);
+    auto accumulate_flags = exp.contains("accumulate_in_fp32")
+        ? parse_bool_list(&require_field(exp, "accumulate_in_fp32"))
+        : std::vector<bool>{false};
+    bool use_kahan = exp.contains("kahan") && require_field(exp, "kahan").as_bool();
+    BackendChoice backend = parse_backend(exp, ctx.profile);
+    core::RngKind rng = parse_rng(exp);
+    // Optional "batched": true runs all trials of a size through one
+    // matmul_batched call per cell. Rows gain "batched":true in params_json
+    // and elapsed_ms is the per-trial share of the batch.
+    bool batched = exp.contains("batched") && require_field(exp, "batched").as_bool();
+    // Optional "split_k": k slices per product, reduced by a pairwise tree
+    // (rows gain "split_k" in params_json when above 1), and "threads":
+    // threads per run for the slices (0 = all cores), which does not change
+    // the results. The FP64 truth is always the sequential product.
+    alg::MatMulOptions base_opts{use_kahan, false};
+    base_opts.split_k = exp.contains("split_k") ? static_cast<std::size_t>(require_field(exp, "split_k").as_number()) : 1;
+    base_opts.threads = exp.contains("threads") ? static_cast<std::size_t>(require_field(exp, "threads").as_number()) : 1;
+    const std::size_t split_k = base_opts.split_k;
+    uint32_t base_seed = ctx.base_seed;
 
-        if (algo == "matmul") {
-            auto sizes = parse_int_list(require_field(exp, "sizes"));
-            auto precisions = parse_precisions(require_field(exp, "precisions"));
-            auto trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : std::size_t(1);
-            auto accumulate_flags = exp.contains("accumulate_in_fp32")
-                ? parse_bool_list(&require_field(exp, "accumulate_in_fp32"))
-                : std::vector<bool>{false};
-            bool use_kahan = exp.contains("kahan") && require_field(exp, "kahan").as_bool();
-
-            for (int size : sizes) {
+    for (int size : sizes) {
+        if (batched) {
+            const std::size_t row_stride = accumulate_flags.size() * precisions.size();
+            auto unit_row = ctx.reserve_unit(trials * row_stride);
+            if (!unit_row) {
+                continue;
+            }
+            std::size_t first_row = *unit_row;
+            ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &cache = ctx.cache, &completed = ctx.completed,
+                             algo, size, trials, base_seed, precisions, accumulate_flags, use_kahan, backend,
+                             rng, base_opts, split_k, first_row, row_stride]() -> std::function<void()> {
+                // emit[column][t]: whether trial t of that column still has to be written.
+                std::vector<std::vector<bool>> emit;
+                bool any_pending = false;
+                for (bool accumulate : accumulate_flags) {
+                    for (auto precision : precisions) {
+                        std::size_t column = emit.size();
+                        auto& mask = emit.emplace_back(trials, true);
+                        for (std::size_t trial = 0; trial < trials && completed.size() > 0; ++trial) {
+                            json::Object params;
+                            params.emplace("size", json::Value(static_cast<double>(size)));
+                            params.emplace("accumulate_in_fp32", json::Value(accumulate));
+                            params.emplace("kahan", json::Value(use_kahan));
+                            params.emplace("batched", json::Value(true));
+                            record_rng(params, rng);
+                            record_split_k(params, split_k);
+                            params.emplace("trial", json::Value(static_cast<double>(trial)));
+                            uint32_t trial_seed = base_seed + static_cast<uint32_t>(size * 997 + trial);
+                            if (completed.contains(cell_hash(algo, std::to_string(size), precision, trial_seed, params))) {
+                                mask[trial] = false;
+                                sink.skip(first_row + trial * row_stride + column);
+                            }
+                        }
+                        for (bool pending : mask) {
+                            any_pending = any_pending || pending;
+                        }
+                    }
+                }
+                if (!any_pending) {
+                    return {};
+                }
+
+                auto data = std::make_shared<MatMulBatch>();
                 for (std::size_t trial = 0; trial < trials; ++trial) {
                     uint32_t trial_seed = base_seed + static_cast<uint32_t>(size * 997 + trial);
-                    fpstudy::core::Random rng(trial_seed);
-                    auto A = core::random_matrix(size, size, rng);
-                    auto B = core::random_matrix(size, size, rng);
-                    auto truth = alg::matmul_square<double>(A, B, size, {use_kahan, false});
+                    auto element = make_matmul_trial(cache, size, trial_seed, use_kahan,
+                                                     backend.for_cell(algo, fmt::Precision::FP64, size), rng);
+                    data->A.insert(data->A.end(), element.A.begin(), element.A.end());
+                    data->B.insert(data->B.end(), element.B.begin(), element.B.end());
+                    data->truth.insert(data->truth.end(), element.truth.begin(), element.truth.end());
+                    data->seeds.push_back(trial_seed);
+                }
+
+                return [&pool = pool, &sink = sink, data, emit = std::move(emit), algo, size, precisions,
+                        accumulate_flags, use_kahan, backend, rng, base_opts, split_k, first_row, row_stride] {
+                    std::size_t column = 0;
                     for (bool accumulate : accumulate_flags) {
                         for (auto precision : precisions) {
-                            alg::MatMulOptions opts{use_kahan, accumulate};
-                            std::string size_str = std::to_string(size);
+                            const auto& mask = emit[column];
+                            if (std::find(mask.begin(), mask.end(), true) == mask.end()) {
+                                ++column;
+                                continue;
+                            }
+                            auto opts = base_opts;
+                            opts.accumulate_in_fp32 = accumulate;
+                            opts.backend = backend.for_cell(algo, precision, size);
                             json::Object params;
                             params.emplace("size", json::Value(static_cast<double>(size)));
-                            params.emplace("trial", json::Value(static_cast<double>(trial)));
                             params.emplace("accumulate_in_fp32", json::Value(accumulate));
                             params.emplace("kahan", json::Value(use_kahan));
-
-                            switch (precision) {
-                                case fmt::Precision::FP64: {
-                                    core::ScopedTimer timer;
-                                    auto result = alg::matmul_square<double>(A, B, size, {use_kahan, false});
-                                    auto elapsed = timer.elapsed_ms();
-                                    emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                             truth, result, 0, true, elapsed);
-                                    break;
-                                }
-                                case fmt::Precision::FP32: {
-                                    auto A32 = fmt::cast_vector<float>(A);
-                                    auto B32 = fmt::cast_vector<float>(B);
-                                    core::ScopedTimer timer;
-                                    auto result = alg::matmul_square<float>(A32, B32, size, opts);
-                                    auto elapsed = timer.elapsed_ms();
-                                    emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                             truth, result, 0, true, elapsed);
-                                    break;
-                                }
-                                case fmt::Precision::TF32: {
-                                    auto A19 = fmt::cast_vector<fmt::TF32>(A);
-                                    auto B19 = fmt::cast_vector<fmt::TF32>(B);
-                                    core::ScopedTimer timer;
-                                    auto result = alg::matmul_square<fmt::TF32>(A19, B19, size, opts);
-                                    auto elapsed = timer.elapsed_ms();
-                                    emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                             truth, result, 0, true, elapsed);
-                                    break;
+                            params.emplace("batched", json::Value(true));
+                            record_rng(params, rng);
+                            record_split_k(params, split_k);
+                            std::size_t row = first_row + column;
+                            pool.submit([&sink, data, params = std::move(params), algo, size,
+                                         precision, opts, row, row_stride, mask] {
+                                if (fmt::is_mx_precision(precision)) {
+                                    run_matmul_mx_batch_cell(params, algo, size, precision, *data, opts, sink, row,
+                                                             row_stride, mask);
+                                    return;
                                 }
-                                case fmt::Precision::BF16: {
-                                    auto A16 = fmt::cast_vector<fmt::BF16>(A);
-                                    auto B16 = fmt::cast_vector<fmt::BF16>(B);
-                                    core::ScopedTimer timer;
-                                    auto result = alg::matmul_square<fmt::BF16>(A16, B16, size, opts);
-                                    auto elapsed = timer.elapsed_ms();
-                                    emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                             truth, result, 0, true, elapsed);
-                                    break;
-                                }
-                                case fmt::Precision::P3109_8: {
-                                    fmt::P3109Number::set_accumulate_fp32(accumulate);
-                                    auto A8 = fmt::cast_vector<fmt::P3109Number>(A);
-                                    auto B8 = fmt::cast_vector<fmt::P3109Number>(B);
-                                    core::ScopedTimer timer;
-                                    auto result = alg::matmul_square<fmt::P3109Number>(A8, B8, size, opts);
-                                    auto elapsed = timer.elapsed_ms();
-                                    emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                             truth, result, 0, true, elapsed);
-                                    break;
-                                }
-                            }
+                                fmt::dispatch_precision(precision, [&](auto tag) {
+                                    run_matmul_batch_cell<decltype(tag)::value>(params, algo, size, *data, opts,
+                                                                                 sink, row, row_stride, mask);
+                                });
+                            });
+                            ++column;
                         }
                     }
+                };
+            });
+            continue;
+        }
+        for (std::size_t trial = 0; trial < trials; ++trial) {
+            auto unit_row = ctx.reserve_unit(accumulate_flags.size() * precisions.size());
+            if (!unit_row) {
+                continue;
+            }
+            std::size_t first_row = *unit_row;
+            ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &cache = ctx.cache, &completed = ctx.completed,
+                             algo, size, trial, base_seed, precisions, accumulate_flags, use_kahan, backend, rng,
+                             base_opts, split_k, first_row]() -> std::function<void()> {
+                uint32_t trial_seed = base_seed + static_cast<uint32_t>(size * 997 + trial);
+                std::vector<PlannedCell> cells;
+                std::size_t row = first_row;
+                for (bool accumulate : accumulate_flags) {
+                    for (auto precision : precisions) {
+                        json::Object params;
+                        params.emplace("size", json::Value(static_cast<double>(size)));
+                        params.emplace("trial", json::Value(static_cast<double>(trial)));
+                        params.emplace("accumulate_in_fp32", json::Value(accumulate));
+                        params.emplace("kahan", json::Value(use_kahan));
+                        record_rng(params, rng);
+                        record_split_k(params, split_k);
+                        cells.push_back({std::move(params), precision, accumulate, row++});
+                    }
+                }
+                cells = pending_cells(std::move(cells), algo, std::to_string(size), trial_seed, completed, sink);
+                if (cells.empty()) {
+                    return {};
                 }
+
+                auto data = std::make_shared<MatMulTrial>(make_matmul_trial(
+                    cache, size, trial_seed, use_kahan, backend.for_cell(algo, fmt::Precision::FP64, size), rng));
+                return [&pool = pool, &sink = sink, data, cells = std::move(cells), algo, size, trial_seed, backend,
+                        base_opts] {
+                    for (const auto& cell : cells) {
+                        auto opts = base_opts;
+                        opts.accumulate_in_fp32 = cell.accumulate;
+                        opts.backend = backend.for_cell(algo, cell.precision, size);
+                        pool.submit([&sink, data, params = cell.params, algo, size,
+                                     precision = cell.precision, trial_seed, opts, row = cell.row] {
+                            if (fmt::is_mx_precision(precision)) {
+                                run_matmul_mx_cell(params, algo, size, precision, trial_seed, *data, opts, sink, row);
+                                return;
+                            }
+                            fmt::dispatch_precision(precision, [&](auto tag) {
+                                run_matmul_cell<decltype(tag)::value>(params, algo, size, trial_seed, *data, opts, sink, row);
+                            });
+                        });
+                    }
+                };
+            });
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// gd_quadratic
+
+struct GradientDescentTrial {
+    std::vector<double> Q;
+    std::vector<double> b;
+    std::vector<double> x0;
+    alg::GradientDescentResult<double> truth_result;
+    core::TimedRegion baseline;
+};
+
+// Runs gradient descent in P from the FP64 problem into x and sets timing
+// to the solve alone, as compute_matmul does. opts.scratch must be set.
+template <fmt::Precision P>
+alg::GradientDescentStatus compute_gd(std::span<const double> Q_values,
+                                      std::span<const double> b_values,
+                                      std::span<const double> x0_values,
+                                      std::size_t dim,
+                                      alg::GradientDescentOptions opts,
+                                      std::span<typename fmt::PrecisionTraits<P>::type> x,
+                                      core::TimedRegion& timing) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    if constexpr (P == fmt::Precision::MiniFloatRuntime) {
+        // The runtime layout is active on this thread only; GD results
+        // do not depend on the thread count.
+        opts.threads = 1;
+    }
+    auto& buffers = conversion_buffers();
+    auto Q = buffers.values<P>(0, Q_values);
+    auto b = buffers.values<P>(1, b_values);
+    auto x0 = buffers.values<P>(2, x0_values);
+    core::ScopedTimer timer;
+    auto status = alg::gradient_descent_quadratic_into<T>(Q, b, x0, dim, x, opts);
+    timing = timer.region();
+    return status;
+}
+
+template <fmt::Precision P>
+void run_gd_cell(const json::Object& params,
+                 const std::string& algo,
+                 std::size_t dim,
+                 uint32_t trial_seed,
+                 const GradientDescentTrial& data,
+                 const alg::GradientDescentOptions& opts,
+                 core::OrderedRowSink& sink,
+                 std::size_t row) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    const auto& truth_vec = data.truth_result.x;
+    if constexpr (P == fmt::Precision::FP64) {
+        // The FP64 run is the truth itself.
+        const auto& result = data.truth_result;
+        emit_run(params, algo, std::to_string(dim), P, trial_seed, sink, row,
+                 truth_vec, result.x, result.iterations, result.converged, data.baseline);
+    } else {
+        core::ArenaScope scope;
+        auto cell_opts = opts;
+        cell_opts.scratch = scope.resource();
+        std::pmr::vector<T> x(dim, cell_opts.scratch);
+        core::TimedRegion timing;
+        auto status = compute_gd<P>(data.Q, data.b, data.x0, dim, cell_opts, x, timing);
+        emit_run(params, algo, std::to_string(dim), P, trial_seed, sink, row,
+                 std::span<const double>(truth_vec), std::span<const T>(x), status.iterations, status.converged,
+                 timing);
+    }
+}
+
+void schedule_gd(const json::Object& exp, const std::string& algo, SweepContext& ctx) {
+    std::size_t dim = static_cast<std::size_t>(require_field(exp, "dim").as_number());
+    auto precisions = parse_precisions(require_field(exp, "precisions"));
+    std::size_t trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : 1;
+    alg::GradientDescentOptions opts;
+    opts.step_size = exp.contains("step_size") ? require_field(exp, "step_size").as_number() : 1e-2;
+    opts.max_iters = exp.contains("max_iters") ? static_cast<std::size_t>(require_field(exp, "max_iters").as_number()) : 1000;
+    opts.tol = exp.contains("tol") ? require_field(exp, "tol").as_number() : 1e-6;
+    BackendChoice backend = parse_backend(exp, ctx.profile);
+    // Optional "threads": threads per run for the gradient rows (0 = all
+    // cores). Results are identical for every value.
+    opts.threads = exp.contains("threads") ? static_cast<std::size_t>(require_field(exp, "threads").as_number()) : 1;
+    bool ill_conditioned = exp.contains("ill_conditioned") && require_field(exp, "ill_conditioned").as_bool();
+    // Optional "spd": "gram" (default), "spectral" with "condition", or
+    // "low_rank" with "rank". Non-default generators and their parameter are
+    // recorded in params_json.
+    core::SpdOptions spd;
+    if (exp.contains("spd")) {
+        spd.kind = core::spd_kind_from_string(require_field(exp, "spd").as_string());
+    }
+    if (exp.contains("condition")) {
+        spd.condition = require_field(exp, "condition").as_number();
+    }
+    if (exp.contains("rank")) {
+        spd.rank = static_cast<std::size_t>(require_field(exp, "rank").as_number());
+    }
+    if (spd.kind == core::SpdKind::Spectral && ill_conditioned) {
+        throw std::runtime_error("gd_quadratic: \"spd\": \"spectral\" sets its conditioning with \"condition\"; "
+                                 "drop \"ill_conditioned\"");
+    }
+    core::RngKind rng = parse_rng(exp);
+    uint32_t base_seed = ctx.base_seed;
+
+    for (std::size_t trial = 0; trial < trials; ++trial) {
+        auto unit_row = ctx.reserve_unit(precisions.size());
+        if (!unit_row) {
+            continue;
+        }
+        std::size_t first_row = *unit_row;
+        ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &cache = ctx.cache, &completed = ctx.completed,
+                         algo, dim, trial, base_seed, precisions, opts, backend, ill_conditioned, spd, rng,
+                         first_row]() -> std::function<void()> {
+            uint32_t trial_seed = base_seed + static_cast<uint32_t>(dim * 577 + trial * 31);
+            json::Object params;
+            params.emplace("dim", json::Value(static_cast<double>(dim)));
+            params.emplace("trial", json::Value(static_cast<double>(trial)));
+            params.emplace("step_size", json::Value(opts.step_size));
+            params.emplace("tol", json::Value(opts.tol));
+            params.emplace("max_iters", json::Value(static_cast<double>(opts.max_iters)));
+            params.emplace("ill_conditioned", json::Value(ill_conditioned));
+            if (spd.kind != core::SpdKind::Gram) {
+                params.emplace("spd", json::Value(core::spd_kind_to_string(spd.kind)));
+            }
+            if (spd.kind == core::SpdKind::Spectral) {
+                params.emplace("condition", json::Value(spd.condition));
+            } else if (spd.kind == core::SpdKind::LowRank) {
+                params.emplace("rank", json::Value(static_cast<double>(spd.rank)));
+            }
+            record_rng(params, rng);
+            std::vector<PlannedCell> cells;
+            for (std::size_t i = 0; i < precisions.size(); ++i) {
+                cells.push_back({params, precisions[i], false, first_row + i});
+            }
+            cells = pending_cells(std::move(cells), algo, std::to_string(dim), trial_seed, completed, sink);
+            if (cells.empty()) {
+                return {};
             }
-        } else if (algo == "gd_quadratic") {
-            std::size_t dim = static_cast<std::size_t>(require_field(exp, "dim").as_number());
-            auto precisions = parse_precisions(require_field(exp, "precisions"));
-            std::size_t trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : 1;
-            alg::GradientDescentOptions opts;
-            opts.step_size = exp.contains("step_size") ? require_field(exp, "step_size").as_number() : 1e-2;
-            opts.max_iters = exp.contains("max_iters") ? static_cast<std::size_t>(require_field(exp, "max_iters").as_number()) : 1000;
-            opts.tol = exp.contains("tol") ? require_field(exp, "tol").as_number() : 1e-6;
-            bool ill_conditioned = exp.contains("ill_conditioned") && require_field(exp, "ill_conditioned").as_bool();
-
-            for (std::size_t trial = 0; trial < trials; ++trial) {
-                uint32_t trial_seed = base_seed + static_cast<uint32_t>(dim * 577 + trial * 31);
-                fpstudy::core::Random rng(trial_seed);
-                auto Q_cases = build_spd_cases(dim, 1, trial_seed, ill_conditioned);
-                auto Q = Q_cases.front();
-                auto b = fpstudy::core::random_vector(dim, rng);
-                auto x0 = std::vector<double>(dim, 0.0);
 
-                core::ScopedTimer baseline_timer;
-                alg::GradientDescentResult<double> truth_result = alg::gradient_descent_quadratic<double>(
-                    Q, b, x0, dim, opts);
-                double baseline_elapsed = baseline_timer.elapsed_ms();
-                auto truth_vec = truth_result.x;
-
-                json::Object params;
-                params.emplace("dim", json::Value(static_cast<double>(dim)));
-                params.emplace("trial", json::Value(static_cast<double>(trial)));
-                params.emplace("step_size", json::Value(opts.step_size));
-                params.emplace("tol", json::Value(opts.tol));
-                params.emplace("max_iters", json::Value(static_cast<double>(opts.max_iters)));
-                params.emplace("ill_conditioned", json::Value(ill_conditioned));
+            auto data = std::make_shared<GradientDescentTrial>();
+            data->x0 = std::vector<double>(dim, 0.0);
+            core::CacheKey key("gd_quadratic");
+            key.add_int("dim", static_cast<int64_t>(dim))
+                .add_int("trial_seed", trial_seed)
+                .add_bool("ill_conditioned", ill_conditioned)
+                .add_number("step_size", opts.step_size)
+                .add_number("tol", opts.tol)
+                .add_int("max_iters", static_cast<int64_t>(opts.max_iters));
+            if (spd.kind == core::SpdKind::Spectral) {
+                key.add_string("spd", "spectral").add_number("condition", spd.condition);
+            } else if (spd.kind == core::SpdKind::LowRank) {
+                key.add_string("spd", "low_rank").add_int("rank", static_cast<int64_t>(spd.rank));
+            }
+            record_rng(key, rng);
+            if (auto hit = cache.load(key)) {
+                // The FP64 row reports the baseline time of the run that
+                // filled the cache, without hardware counts.
+                data->Q = hit->vector("Q");
+                data->b = hit->vector("b");
+                data->truth_result.x = hit->vector("truth");
+                data->truth_result.iterations = static_cast<std::size_t>(hit->scalar("iterations"));
+                data->truth_result.converged = hit->scalar("converged") != 0.0;
+                data->baseline.elapsed_ms = hit->scalar("baseline_elapsed_ms");
+            } else {
+                fpstudy::core::Random b_rng(trial_seed, rng);
+                auto Q_cases = build_spd_cases(dim, 1, trial_seed, ill_conditioned, spd, rng);
+                data->Q = Q_cases.front();
+                data->b = fpstudy::core::random_vector(dim, b_rng);
 
-                for (auto precision : precisions) {
-                    switch (precision) {
-                        case fmt::Precision::FP64: {
-                            auto result = truth_result;
-                            emit_run(params, algo, std::to_string(dim), precision, trial_seed, writer,
-                                     truth_vec, result.x, result.iterations, result.converged, baseline_elapsed);
-                            break;
-                        }
-                        case fmt::Precision::FP32: {
-                            auto Q32 = fmt::cast_vector<float>(Q);
-                            auto b32 = fmt::cast_vector<float>(b);
-                            auto x32 = fmt::cast_vector<float>(x0);
-                            core::ScopedTimer timer;
-                            auto result = alg::gradient_descent_quadratic<float>(Q32, b32, x32, dim, opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, std::to_string(dim), precision, trial_seed, writer,
-                                     truth_vec, result.x, result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::TF32: {
-                            auto Q19 = fmt::cast_vector<fmt::TF32>(Q);
-                            auto b19 = fmt::cast_vector<fmt::TF32>(b);
-                            auto x19 = fmt::cast_vector<fmt::TF32>(x0);
-                            core::ScopedTimer timer;
-                            auto result = alg::gradient_descent_quadratic<fmt::TF32>(Q19, b19, x19, dim, opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, std::to_string(dim), precision, trial_seed, writer,
-                                     truth_vec, result.x, result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::BF16: {
-                            auto Q16 = fmt::cast_vector<fmt::BF16>(Q);
-                            auto b16 = fmt::cast_vector<fmt::BF16>(b);
-                            auto x16 = fmt::cast_vector<fmt::BF16>(x0);
-                            core::ScopedTimer timer;
-                            auto result = alg::gradient_descent_quadratic<fmt::BF16>(Q16, b16, x16, dim, opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, std::to_string(dim), precision, trial_seed, writer,
-                                     truth_vec, result.x, result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::P3109_8: {
-                            fmt::P3109Number::set_accumulate_fp32(true);
-                            auto Q8 = fmt::cast_vector<fmt::P3109Number>(Q);
-                            auto b8 = fmt::cast_vector<fmt::P3109Number>(b);
-                            auto x8 = fmt::cast_vector<fmt::P3109Number>(x0);
-                            core::ScopedTimer timer;
-                            auto result = alg::gradient_descent_quadratic<fmt::P3109Number>(Q8, b8, x8, dim, opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, std::to_string(dim), precision, trial_seed, writer,
-                                     truth_vec, result.x, result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                    }
+                auto truth_opts = opts;
+                truth_opts.backend = backend.for_cell(algo, fmt::Precision::FP64, dim);
+                core::ScopedTimer baseline_timer;
+                data->truth_result = alg::gradient_descent_quadratic<double>(
+                    data->Q, data->b, data->x0, dim, truth_opts);
+                data->baseline = baseline_timer.region();
+                if (cache.enabled()) {
+                    core::CacheRecord record;
+                    record.put("Q", data->Q);
+                    record.put("b", data->b);
+                    record.put("truth", data->truth_result.x);
+                    record.put_scalar("iterations", static_cast<double>(data->truth_result.iterations));
+                    record.put_scalar("converged", data->truth_result.converged ? 1.0 : 0.0);
+                    record.put_scalar("baseline_elapsed_ms", data->baseline.elapsed_ms);
+                    cache.store(key, record);
                 }
             }
-        } else if (algo == "newton") {
-            const std::string function_name = require_field(exp, "function").as_string();
-            auto initials = parse_double_list(require_field(exp, "initials"));
-            auto precisions = parse_precisions(require_field(exp, "precisions"));
-            alg::NewtonOptions opts;
-            opts.max_iters = exp.contains("max_iters") ? static_cast<std::size_t>(require_field(exp, "max_iters").as_number()) : 100;
-            opts.tol = exp.contains("tol") ? require_field(exp, "tol").as_number() : 1e-8;
-
-            auto function = [&](double x) {
-                if (function_name == "x3_minus_2") {
-                    return x * x * x - 2.0;
+
+            return [&pool = pool, &sink = sink, data, cells = std::move(cells), algo, dim, trial_seed, opts,
+                    backend] {
+                for (const auto& cell : cells) {
+                    auto cell_opts = opts;
+                    cell_opts.backend = backend.for_cell(algo, cell.precision, dim);
+                    pool.submit([&sink, data, params = cell.params, algo, dim, precision = cell.precision,
+                                 trial_seed, opts = cell_opts, row = cell.row] {
+                        fmt::dispatch_precision(precision, [&](auto tag) {
+                            run_gd_cell<decltype(tag)::value>(params, algo, dim, trial_seed, *data, opts, sink, row);
+                        });
+                    });
                 }
-                throw std::runtime_error("Unknown Newton function: " + function_name);
             };
-            auto derivative = [&](double x) {
-                if (function_name == "x3_minus_2") {
-                    return 3.0 * x * x;
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// newton
+
+// Calls fn(f, df) with the named function and its derivative as lambdas, so
+// the name is looked up once per solve and the kernels can inline them.
+template <typename Fn>
+decltype(auto) dispatch_newton_function(const std::string& function_name, Fn&& fn) {
+    if (function_name == "x3_minus_2") {
+        return fn([](double x) { return x * x * x - 2.0; }, [](double x) { return 3.0 * x * x; });
+    }
+    throw std::runtime_error("Unknown Newton function: " + function_name);
+}
+
+template <fmt::Precision P>
+void run_newton_cell(const json::Object& params,
+                     const std::string& algo,
+                     const std::string& function_name,
+                     double initial,
+                     uint32_t trial_seed,
+                     const alg::NewtonResult<double>& truth_result,
+                     const core::TimedRegion& baseline,
+                     const alg::NewtonOptions& opts,
+                     core::OrderedRowSink& sink,
+                     std::size_t row) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    const double truth_root = static_cast<double>(truth_result.root);
+    if constexpr (P == fmt::Precision::FP64) {
+        emit_run(params, algo, "1", P, trial_seed, sink, row,
+                 std::span<const double>(&truth_root, 1), std::span<const double>(&truth_result.root, 1),
+                 truth_result.iterations, truth_result.converged, baseline);
+    } else {
+        T init(initial);
+        dispatch_newton_function(function_name, [&](auto f, auto df) {
+            core::ScopedTimer timer;
+            auto result = alg::newton_raphson<T>(
+                init,
+                [&](T x) { return T(f(static_cast<double>(x))); },
+                [&](T x) { return T(df(static_cast<double>(x))); },
+                opts);
+            auto timing = timer.region();
+            emit_run(params, algo, "1", P, trial_seed, sink, row,
+                     std::span<const double>(&truth_root, 1), std::span<const T>(&result.root, 1),
+                     result.iterations, result.converged, timing);
+        });
+    }
+}
+
+// One precision of a batched newton experiment: every initial point runs in
+// a single newton_raphson_batch call and gets its own row, at
+// first_row + i * row_stride, as in the per-point loop. Rows whose cells are
+// already complete (emit[i] false) are computed but not written.
+template <fmt::Precision P>
+void run_newton_batch_cell(const json::Object& base_params,
+                           const std::string& algo,
+                           const std::string& function_name,
+                           const std::vector<double>& initials,
+                           uint32_t base_seed,
+                           const alg::NewtonBatchResult<double>& truth,
+                           const core::TimedRegion& baseline,
+                           const alg::NewtonOptions& opts,
+                           core::OrderedRowSink& sink,
+                           std::size_t first_row,
+                           std::size_t row_stride,
+                           const std::vector<bool>& emit) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    auto emit_lanes = [&](auto roots, auto iterations, auto converged, const core::TimedRegion& timing) {
+        for (std::size_t i = 0; i < initials.size(); ++i) {
+            if (!emit[i]) {
+                continue;
+            }
+            json::Object params = base_params;
+            params.emplace("initial", json::Value(initials[i]));
+            uint32_t trial_seed = base_seed + static_cast<uint32_t>(initials[i] * 101);
+            emit_run(params, algo, "1", P, trial_seed, sink, first_row + i * row_stride,
+                     std::span<const double>(&truth.roots[i], 1), roots.subspan(i, 1),
+                     iterations[i], converged[i] != 0, timing);
+        }
+    };
+    if constexpr (P == fmt::Precision::FP64) {
+        emit_lanes(std::span<const double>(truth.roots), std::span<const std::size_t>(truth.iterations),
+                   std::span<const uint8_t>(truth.converged), baseline);
+    } else {
+        core::ArenaScope scope;
+        auto* arena = scope.resource();
+        const std::size_t count = initials.size();
+        std::pmr::vector<T> starts(initials.begin(), initials.end(), arena);
+        std::pmr::vector<T> roots(count, arena);
+        std::pmr::vector<std::size_t> iterations(count, arena);
+        std::pmr::vector<uint8_t> converged(count, arena);
+        core::ScopedTimer timer;
+        dispatch_newton_function(function_name, [&](auto f, auto df) {
+            alg::newton_raphson_batch_into<T>(
+                starts,
+                [f](T x) { return T(f(static_cast<double>(x))); },
+                [df](T x) { return T(df(static_cast<double>(x))); },
+                roots, iterations, converged, opts);
+        });
+        emit_lanes(std::span<const T>(roots), std::span<const std::size_t>(iterations),
+                   std::span<const uint8_t>(converged), timer.region().share(count));
+    }
+}
+
+// Every point of a batched newton experiment as one trial unit: plans the
+// rows, skips the cells an earlier run completed, computes the FP64 batch
+// and fans out one batch per precision.
+void schedule_newton_batch(const std::string& algo,
+                           const std::string& function_name,
+                           const std::vector<double>& initials,
+                           const std::vector<fmt::Precision>& precisions,
+                           const alg::NewtonOptions& opts,
+                           SweepContext& ctx) {
+    auto unit_row = ctx.reserve_unit(initials.size() * precisions.size());
+    if (!unit_row || initials.empty()) {
+        return;
+    }
+    std::size_t first_row = *unit_row;
+    ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &completed = ctx.completed, algo, function_name,
+                     initials, base_seed = ctx.base_seed, precisions, opts, first_row]() -> std::function<void()> {
+        json::Object base_params;
+        base_params.emplace("function", json::Value(function_name));
+        base_params.emplace("tol", json::Value(opts.tol));
+        base_params.emplace("max_iters", json::Value(static_cast<double>(opts.max_iters)));
+        base_params.emplace("batch", json::Value(true));
+        const std::size_t row_stride = precisions.size();
+        // emit[p][i]: whether initial i still needs its precision-p row.
+        std::vector<std::vector<bool>> emit(precisions.size(), std::vector<bool>(initials.size(), true));
+        bool any_pending = completed.size() == 0;
+        for (std::size_t p = 0; p < precisions.size() && completed.size() > 0; ++p) {
+            for (std::size_t i = 0; i < initials.size(); ++i) {
+                json::Object params = base_params;
+                params.emplace("initial", json::Value(initials[i]));
+                uint32_t trial_seed = base_seed + static_cast<uint32_t>(initials[i] * 101);
+                if (completed.contains(cell_hash(algo, "1", precisions[p], trial_seed, params))) {
+                    emit[p][i] = false;
+                    sink.skip(first_row + i * row_stride + p);
+                } else {
+                    any_pending = true;
                 }
-                throw std::runtime_error("Unknown Newton derivative: " + function_name);
-            };
+            }
+        }
+        if (!any_pending) {
+            return {};
+        }
+
+        core::ScopedTimer baseline_timer;
+        auto truth = std::make_shared<alg::NewtonBatchResult<double>>(
+            dispatch_newton_function(function_name, [&](auto f, auto df) {
+                return alg::newton_raphson_batch<double>(initials, f, df, opts);
+            }));
+        auto baseline = baseline_timer.region().share(initials.size());
+
+        return [&pool = pool, &sink = sink, base_params = std::move(base_params), emit = std::move(emit), algo,
+                function_name, initials, base_seed, precisions, truth, baseline, opts, first_row, row_stride] {
+            for (std::size_t p = 0; p < precisions.size(); ++p) {
+                if (std::find(emit[p].begin(), emit[p].end(), true) == emit[p].end()) {
+                    continue;
+                }
+                pool.submit([&sink, base_params, algo, function_name, initials, base_seed, truth, baseline, opts,
+                             precision = precisions[p], row = first_row + p, row_stride, mask = emit[p]] {
+                    fmt::dispatch_precision(precision, [&](auto tag) {
+                        run_newton_batch_cell<decltype(tag)::value>(base_params, algo, function_name, initials,
+                                                                    base_seed, *truth, baseline, opts, sink, row,
+                                                                    row_stride, mask);
+                    });
+                });
+            }
+        };
+    });
+}
 
-            for (double initial : initials) {
+void schedule_newton(const json::Object& exp, const std::string& algo, SweepContext& ctx) {
+    const std::string function_name = require_field(exp, "function").as_string();
+    // "initial_grid": {"min", "max", "count"} expands to count evenly spaced
+    // points and may replace the "initials" list.
+    std::vector<double> initials;
+    if (exp.contains("initial_grid")) {
+        const auto& grid = require_field(exp, "initial_grid").as_object();
+        double lo = require_field(grid, "min").as_number();
+        double hi = require_field(grid, "max").as_number();
+        auto count = static_cast<std::size_t>(require_field(grid, "count").as_number());
+        for (std::size_t i = 0; i < count; ++i) {
+            initials.push_back(count == 1 ? lo : lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(count - 1));
+        }
+    } else {
+        initials = parse_double_list(require_field(exp, "initials"));
+    }
+    auto precisions = parse_precisions(require_field(exp, "precisions"));
+    alg::NewtonOptions opts;
+    opts.max_iters = exp.contains("max_iters") ? static_cast<std::size_t>(require_field(exp, "max_iters").as_number()) : 100;
+    opts.tol = exp.contains("tol") ? require_field(exp, "tol").as_number() : 1e-8;
+    // Optional "batch": true iterates all initial points at once with
+    // newton_raphson_batch, one batch per precision. Rows gain "batch":true in
+    // params_json and elapsed_ms is the per-point share of the batch.
+    if (exp.contains("batch") && require_field(exp, "batch").as_bool()) {
+        schedule_newton_batch(algo, function_name, initials, precisions, opts, ctx);
+        return;
+    }
+    uint32_t base_seed = ctx.base_seed;
+
+    for (double initial : initials) {
+        auto unit_row = ctx.reserve_unit(precisions.size());
+        if (!unit_row) {
+            continue;
+        }
+        std::size_t first_row = *unit_row;
+        ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &completed = ctx.completed, algo, function_name,
+                         initial, base_seed, precisions, opts, first_row]() -> std::function<void()> {
+            uint32_t trial_seed = base_seed + static_cast<uint32_t>(initial * 101);
+            json::Object params;
+            params.emplace("function", json::Value(function_name));
+            params.emplace("initial", json::Value(initial));
+            params.emplace("tol", json::Value(opts.tol));
+            params.emplace("max_iters", json::Value(static_cast<double>(opts.max_iters)));
+            std::vector<PlannedCell> cells;
+            for (std::size_t i = 0; i < precisions.size(); ++i) {
+                cells.push_back({params, precisions[i], false, first_row + i});
+            }
+            cells = pending_cells(std::move(cells), algo, "1", trial_seed, completed, sink);
+            if (cells.empty()) {
+                return {};
+            }
+
+            core::TimedRegion baseline;
+            auto truth_result = dispatch_newton_function(function_name, [&](auto f, auto df) {
                 core::ScopedTimer baseline_timer;
-                auto truth_result = alg::newton_raphson<double>(
-                    initial,
-                    [&](double x) { return function(x); },
-                    [&](double x) { return derivative(x); },
-                    opts);
-                double baseline_elapsed = baseline_timer.elapsed_ms();
-                std::vector<double> truth_vec = {static_cast<double>(truth_result.root)};
-                uint32_t trial_seed = base_seed + static_cast<uint32_t>(initial * 101);
-
-                json::Object params;
-                params.emplace("function", json::Value(function_name));
-                params.emplace("initial", json::Value(initial));
-                params.emplace("tol", json::Value(opts.tol));
-                params.emplace("max_iters", json::Value(static_cast<double>(opts.max_iters)));
+                auto result = alg::newton_raphson<double>(initial, f, df, opts);
+                baseline = baseline_timer.region();
+                return result;
+            });
+
+            return [&pool = pool, &sink = sink, cells = std::move(cells), algo, function_name, initial, trial_seed,
+                    truth_result, baseline, opts] {
+                for (const auto& cell : cells) {
+                    pool.submit([&sink, params = cell.params, algo, function_name, initial,
+                                 precision = cell.precision, trial_seed, truth_result, baseline, opts,
+                                 row = cell.row] {
+                        fmt::dispatch_precision(precision, [&](auto tag) {
+                            run_newton_cell<decltype(tag)::value>(params, algo, function_name, initial, trial_seed,
+                                                   truth_result, baseline, opts, sink, row);
+                        });
+                    });
+                }
+            };
+        });
+    }
+}
 
+// ---------------------------------------------------------------------------
+// fir
+
+struct FirTrial {
+    std::vector<double> h;
+    std::vector<double> x;
+    std::vector<double> truth;
+};
+
+// The fir counterpart of compute_matmul: y = h * x in P, as doubles.
+template <fmt::Precision P>
+core::TimedRegion compute_fir(std::span<const double> h_values,
+                              std::span<const double> x_values,
+                              alg::FIROptions opts,
+                              std::span<double> values) {
+    if constexpr (P == fmt::Precision::FP64) {
+        opts.accumulate_in_fp32 = false;
+    }
+    auto& buffers = conversion_buffers();
+    const auto& h = buffers.encode<P>(0, h_values);
+    const auto& x = buffers.encode<P>(1, x_values);
+    core::TimedRegion timing;
+    if constexpr (fmt::is_p3109_number_v<typename fmt::PrecisionTraits<P>::type>) {
+        run_p3109_kernel(opts.accumulate_in_fp32, h.values(), x.values(), values, timing, opts.scratch,
+                         [&]<typename T>(std::span<const T> taps, std::span<const T> signal, std::span<T> y) {
+                             alg::fir_filter_into<T>(taps, signal, y, opts);
+                         });
+    } else {
+        std::pmr::vector<typename fmt::PackedVector<P>::code_type> result(values.size(), opts.scratch);
+        core::ScopedTimer timer;
+        alg::fir_filter_into(h, x, std::span(result), opts);
+        timing = timer.region();
+        fmt::decode_codes<P>(result, values);
+    }
+    return timing;
+}
+
+template <fmt::Precision P>
+void run_fir_cell(const json::Object& params,
+                  const std::string& algo,
+                  const std::string& size_str,
+                  uint32_t trial_seed,
+                  const FirTrial& data,
+                  alg::FIROptions opts,
+                  core::OrderedRowSink& sink,
+                  std::size_t row) {
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    std::pmr::vector<double> values(data.x.size(), opts.scratch);
+    auto timing = compute_fir<P>(data.h, data.x, opts, values);
+    emit_run(params, algo, size_str, P, trial_seed, sink, row,
+             std::span<const double>(data.truth), std::span<const double>(values), 0, true, timing);
+}
+
+// fir on MX taps and signal, each one block-scaled row.
+void run_fir_mx_cell(const json::Object& params,
+                     const std::string& algo,
+                     const std::string& size_str,
+                     fmt::Precision precision,
+                     uint32_t trial_seed,
+                     const FirTrial& data,
+                     alg::FIROptions opts,
+                     core::OrderedRowSink& sink,
+                     std::size_t row) {
+    core::ArenaScope scope;
+    opts.scratch = scope.resource();
+    const auto layout = fmt::mx_element_layout(precision);
+    auto& [h, x] = mx_buffers();
+    h.assign(layout, data.h);
+    x.assign(layout, data.x);
+    std::pmr::vector<float> result(data.x.size(), opts.scratch);
+    core::ScopedTimer timer;
+    alg::fir_filter_mx_into(h, x, result, opts);
+    auto timing = timer.region();
+    std::pmr::vector<double> values(result.begin(), result.end(), opts.scratch);
+    emit_run(params, algo, size_str, precision, trial_seed, sink, row,
+             std::span<const double>(data.truth), std::span<const double>(values), 0, true, timing);
+}
+
+void schedule_fir(const json::Object& exp, const std::string& algo, SweepContext& ctx) {
+    std::size_t filter_order = static_cast<std::size_t>(require_field(exp, "filter_order").as_number());
+    std::size_t signal_length = static_cast<std::size_t>(require_field(exp, "signal_length").as_number());
+    auto precisions = parse_precisions(require_field(exp, "precisions"), true);
+    std::size_t trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : std::size_t(1);
+    auto accumulate_flags = exp.contains("accumulate_in_fp32")
+        ? parse_bool_list(&require_field(exp, "accumulate_in_fp32"))
+        : std::vector<bool>{false};
+    bool use_kahan = exp.contains("kahan") && require_field(exp, "kahan").as_bool();
+    BackendChoice backend = parse_backend(exp, ctx.profile);
+    // Optional "truth_engine": "direct" (default) or "fft" (overlap-save, see
+    // algorithms/fft.hpp). Only recorded in params_json when fft is chosen.
+    bool fft_truth = false;
+    if (exp.contains("truth_engine")) {
+        const std::string engine = require_field(exp, "truth_engine").as_string();
+        if (engine == "fft") {
+            fft_truth = true;
+        } else if (engine != "direct") {
+            throw std::runtime_error("Unknown truth_engine: " + engine);
+        }
+    }
+    core::RngKind rng = parse_rng(exp);
+    uint32_t base_seed = ctx.base_seed;
+
+    for (std::size_t trial = 0; trial < trials; ++trial) {
+        auto unit_row = ctx.reserve_unit(accumulate_flags.size() * precisions.size());
+        if (!unit_row) {
+            continue;
+        }
+        std::size_t first_row = *unit_row;
+        ctx.submit_unit([&pool = ctx.pool, &sink = ctx.sink, &cache = ctx.cache, &completed = ctx.completed, algo,
+                         filter_order, signal_length, trial, base_seed, precisions, accumulate_flags, use_kahan,
+                         backend, fft_truth, rng, first_row]() -> std::function<void()> {
+            uint32_t trial_seed = base_seed + static_cast<uint32_t>(filter_order * 701 + signal_length * 503 + trial * 41);
+            std::string size_str = std::to_string(filter_order) + "x" + std::to_string(signal_length);
+            std::vector<PlannedCell> cells;
+            std::size_t row = first_row;
+            for (bool accumulate : accumulate_flags) {
                 for (auto precision : precisions) {
-                    switch (precision) {
-                        case fmt::Precision::FP64: {
-                            emit_run(params, algo, "1", precision, trial_seed, writer,
-                                     truth_vec, std::vector<double>{truth_result.root},
-                                     truth_result.iterations, truth_result.converged, baseline_elapsed);
-                            break;
-                        }
-                        case fmt::Precision::FP32: {
-                            float init = static_cast<float>(initial);
-                            core::ScopedTimer timer;
-                            auto result = alg::newton_raphson<float>(
-                                init,
-                                [&](float x) { return static_cast<float>(function(x)); },
-                                [&](float x) { return static_cast<float>(derivative(x)); },
-                                opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, "1", precision, trial_seed, writer,
-                                     truth_vec, std::vector<float>{result.root},
-                                     result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::TF32: {
-                            fmt::TF32 init(initial);
-                            core::ScopedTimer timer;
-                            auto result = alg::newton_raphson<fmt::TF32>(
-                                init,
-                                [&](fmt::TF32 x) { return fmt::TF32(function(static_cast<double>(x))); },
-                                [&](fmt::TF32 x) { return fmt::TF32(derivative(static_cast<double>(x))); },
-                                opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, "1", precision, trial_seed, writer,
-                                     truth_vec, std::vector<fmt::TF32>{result.root},
-                                     result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::BF16: {
-                            fmt::BF16 init(initial);
-                            core::ScopedTimer timer;
-                            auto result = alg::newton_raphson<fmt::BF16>(
-                                init,
-                                [&](fmt::BF16 x) { return fmt::BF16(function(static_cast<double>(x))); },
-                                [&](fmt::BF16 x) { return fmt::BF16(derivative(static_cast<double>(x))); },
-                                opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, "1", precision, trial_seed, writer,
-                                     truth_vec, std::vector<fmt::BF16>{result.root},
-                                     result.iterations, result.converged, elapsed);
-                            break;
-                        }
-                        case fmt::Precision::P3109_8: {
-                            fmt::P3109Number::set_accumulate_fp32(true);
-                            fmt::P3109Number init(initial);
-                            core::ScopedTimer timer;
-                            auto result = alg::newton_raphson<fmt::P3109Number>(
-                                init,
-                                [&](fmt::P3109Number x) {
-                                    double xd = static_cast<double>(x);
-                                    return fmt::P3109Number(function(xd));
-                                },
-                                [&](fmt::P3109Number x) {
-                                    double xd = static_cast<double>(x);
-                                    return fmt::P3109Number(derivative(xd));
-                                },
-                                opts);
-                            auto elapsed = timer.elapsed_ms();
-                            emit_run(params, algo, "1", precision, trial_seed, writer,
-                                     truth_vec, std::vector<fmt::P3109Number>{result.root},
-                                     result.iterations, result.converged, elapsed);
-                            break;
-                        }
+                    json::Object params;
+                    params.emplace("filter_order", json::Value(static_cast<double>(filter_order)));
+                    params.emplace("signal_length", json::Value(static_cast<double>(signal_length)));
+                    params.emplace("trial", json::Value(static_cast<double>(trial)));
+                    params.emplace("accumulate_in_fp32", json::Value(accumulate));
+                    params.emplace("kahan", json::Value(use_kahan));
+                    if (fft_truth) {
+                        params.emplace("truth_engine", json::Value(std::string("fft")));
                     }
+                    record_rng(params, rng);
+                    cells.push_back({std::move(params), precision, accumulate, row++});
                 }
             }
-        } else if (algo == "fir") {
-            std::size_t filter_order = static_cast<std::size_t>(require_field(exp, "filter_order").as_number());
-            std::size_t signal_length = static_cast<std::size_t>(require_field(exp, "signal_length").as_number());
-            auto precisions = parse_precisions(require_field(exp, "precisions"));
-            std::size_t trials = exp.contains("trials") ? static_cast<std::size_t>(require_field(exp, "trials").as_number()) : std::size_t(1);
-            auto accumulate_flags = exp.contains("accumulate_in_fp32")
-                ? parse_bool_list(&require_field(exp, "accumulate_in_fp32"))
-                : std::vector<bool>{false};
-            bool use_kahan = exp.contains("kahan") && require_field(exp, "kahan").as_bool();
-
-            for (std::size_t trial = 0; trial < trials; ++trial) {
-                uint32_t trial_seed = base_seed + static_cast<uint32_t>(filter_order * 701 + signal_length * 503 + trial * 41);
-                fpstudy::core::Random rng(trial_seed);
-                
+            cells = pending_cells(std::move(cells), algo, size_str, trial_seed, completed, sink);
+            if (cells.empty()) {
+                return {};
+            }
+
+            auto data = std::make_shared<FirTrial>();
+            core::CacheKey key("fir");
+            key.add_int("filter_order", static_cast<int64_t>(filter_order))
+                .add_int("signal_length", static_cast<int64_t>(signal_length))
+                .add_int("trial_seed", trial_seed)
+                .add_bool("kahan", use_kahan)
+                .add_string("truth_engine", fft_truth ? "fft" : "direct");
+            record_rng(key, rng);
+            if (auto hit = cache.load(key)) {
+                data->h = hit->vector("h");
+                data->x = hit->vector("x");
+                data->truth = hit->vector("truth");
+            } else {
+                fpstudy::core::Random signal_rng(trial_seed, rng);
+
                 // Generate random filter coefficients and normalize to sum to 1
-                auto h = core::random_vector(filter_order, rng, 1.0);
+                data->h = core::random_vector(filter_order, signal_rng, 1.0);
                 double h_sum = 0.0;
-                for (double coeff : h) {
+                for (double coeff : data->h) {
                     h_sum += coeff;
                 }
                 if (std::abs(h_sum) > 1e-12) {
-                    for (double& coeff : h) {
+                    for (double& coeff : data->h) {
                         coeff /= h_sum;
                     }
                 }
-                
+
                 // Generate random input signal
-                auto x = core::random_vector(signal_length, rng, 1.0);
-                
-                // Compute truth using FP64
-                auto truth = alg::fir_filter<double>(h, x, {use_kahan, false});
+                data->x = core::random_vector(signal_length, signal_rng, 1.0);
 
-                for (bool accumulate : accumulate_flags) {
-                    for (auto precision : precisions) {
-                        alg::FIROptions opts{use_kahan, accumulate};
-                        std::string size_str = std::to_string(filter_order) + "x" + std::to_string(signal_length);
-                        json::Object params;
-                        params.emplace("filter_order", json::Value(static_cast<double>(filter_order)));
-                        params.emplace("signal_length", json::Value(static_cast<double>(signal_length)));
-                        params.emplace("trial", json::Value(static_cast<double>(trial)));
-                        params.emplace("accumulate_in_fp32", json::Value(accumulate));
-                        params.emplace("kahan", json::Value(use_kahan));
+                // Compute truth using FP64
+                data->truth = fft_truth
+                    ? alg::fir_filter_fft(data->h, data->x)
+                    : alg::fir_filter<double>(data->h, data->x,
+                                              {use_kahan, false,
+                                               backend.for_cell(algo, fmt::Precision::FP64, filter_order)});
+                if (cache.enabled()) {
+                    core::CacheRecord record;
+                    record.put("h", data->h);
+                    record.put("x", data->x);
+                    record.put("truth", data->truth);
+                    cache.store(key, record);
+                }
+            }
 
-                        switch (precision) {
-                            case fmt::Precision::FP64: {
-                                core::ScopedTimer timer;
-                                auto result = alg::fir_filter<double>(h, x, {use_kahan, false});
-                                auto elapsed = timer.elapsed_ms();
-                                emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                         truth, result, 0, true, elapsed);
-                                break;
-                            }
-                            case fmt::Precision::FP32: {
-                                auto h32 = fmt::cast_vector<float>(h);
-                                auto x32 = fmt::cast_vector<float>(x);
-                                core::ScopedTimer timer;
-                                auto result = alg::fir_filter<float>(h32, x32, opts);
-                                auto elapsed = timer.elapsed_ms();
-                                emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                         truth, result, 0, true, elapsed);
-                                break;
-                            }
-                            case fmt::Precision::TF32: {
-                                auto h19 = fmt::cast_vector<fmt::TF32>(h);
-                                auto x19 = fmt::cast_vector<fmt::TF32>(x);
-                                core::ScopedTimer timer;
-                                auto result = alg::fir_filter<fmt::TF32>(h19, x19, opts);
-                                auto elapsed = timer.elapsed_ms();
-                                emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                         truth, result, 0, true, elapsed);
-                                break;
-                            }
-                            case fmt::Precision::BF16: {
-                                auto h16 = fmt::cast_vector<fmt::BF16>(h);
-                                auto x16 = fmt::cast_vector<fmt::BF16>(x);
-                                core::ScopedTimer timer;
-                                auto result = alg::fir_filter<fmt::BF16>(h16, x16, opts);
-                                auto elapsed = timer.elapsed_ms();
-                                emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                         truth, result, 0, true, elapsed);
-                                break;
-                            }
-                            case fmt::Precision::P3109_8: {
-                                fmt::P3109Number::set_accumulate_fp32(accumulate);
-                                auto h8 = fmt::cast_vector<fmt::P3109Number>(h);
-                                auto x8 = fmt::cast_vector<fmt::P3109Number>(x);
-                                core::ScopedTimer timer;
-                                auto result = alg::fir_filter<fmt::P3109Number>(h8, x8, opts);
-                                auto elapsed = timer.elapsed_ms();
-                                emit_run(params, algo, size_str, precision, trial_seed, writer,
-                                         truth, result, 0, true, elapsed);
-                                break;
-                            }
+            return [&pool = pool, &sink = sink, data, cells = std::move(cells), algo, size_str, trial_seed, use_kahan,
+                    backend, filter_order] {
+                for (const auto& cell : cells) {
+                    alg::FIROptions opts{use_kahan, cell.accumulate, backend.for_cell(algo, cell.precision, filter_order)};
+                    pool.submit([&sink, data, params = cell.params, algo, size_str,
+                                 precision = cell.precision, trial_seed, opts, row = cell.row] {
+                        if (fmt::is_mx_precision(precision)) {
+                            run_fir_mx_cell(params, algo, size_str, precision, trial_seed, *data, opts, sink, row);
+                            return;
                         }
+                        fmt::dispatch_precision(precision, [&](auto tag) {
+                            run_fir_cell<decltype(tag)::value>(params, algo, size_str, trial_seed, *data, opts, sink,
+                                                               row);
+                        });
+                    });
+                }
+            };
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// tune
+
+// One kernel cell of a backend profile: algo, precision and size as the
+// profile keys them, plus the fir signal length the cell is timed on.
+struct TuneCell {
+    std::string algo;
+    fmt::Precision precision;
+    std::size_t size;
+    std::size_t signal_length;
+};
+
+struct TuneSettings {
+    std::size_t samples = 7;
+    double min_sample_total_ms = 50.0;
+};
+
+constexpr std::size_t kTuneMaxSamples = 1000;
+constexpr std::size_t kTuneFirSignalLength = 4096;
+constexpr std::size_t kTuneGdIters = 20;
+constexpr uint32_t kTuneSeed = 2024;
+
+// Backends with their own implementation for the cell. The others would run
+// the reference loop (or, for matmul, the blocked one) again.
+template <fmt::Precision P>
+std::vector<alg::Backend> tune_candidates(const TuneCell& cell) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    constexpr bool emulated = fmt::Fp32Emulation<T>::enabled;
+    const auto fixed = [&](const auto& sizes) {
+        return std::find(sizes.begin(), sizes.end(), cell.size) != sizes.end();
+    };
+    std::vector<alg::Backend> backends = {alg::Backend::Reference};
+    if (cell.algo == "matmul") {
+        backends.push_back(alg::Backend::Blocked);
+        if (fixed(alg::kFixedMatMulSizes)) {
+            backends.push_back(alg::Backend::Fixed);
+        }
+    } else if (cell.algo == "fir" && fixed(alg::kFixedFirTaps)) {
+        backends.push_back(alg::Backend::Fixed);
+    }
+    if (emulated) {
+        backends.push_back(alg::Backend::Vectorized);
+    }
+    return backends;
+}
+
+// Times every candidate backend of the cell on one fixed input, through the
+// same compute_* path as the sweep cells, and checks its output against the
+// reference backend's bit for bit. Each backend gets one warm-up run and at
+// least settings.samples timed runs, more until their total reaches
+// settings.min_sample_total_ms; the median is recorded.
+template <fmt::Precision P>
+core::TunedKernel tune_cell(const TuneCell& cell, const TuneSettings& settings) {
+    using T = typename fmt::PrecisionTraits<P>::type;
+    core::Random rng(kTuneSeed + static_cast<uint32_t>(cell.size));
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> x0;
+    std::size_t outputs = 0;
+    if (cell.algo == "matmul") {
+        a = core::random_matrix(cell.size, cell.size, rng);
+        b = core::random_matrix(cell.size, cell.size, rng);
+        outputs = cell.size * cell.size;
+    } else if (cell.algo == "fir") {
+        a = core::random_vector(cell.size, rng, 1.0);
+        b = core::random_vector(cell.signal_length, rng, 1.0);
+        outputs = cell.signal_length;
+    } else {
+        a = build_spd_cases(cell.size, 1, kTuneSeed, false, core::SpdOptions{}, core::RngKind::MT19937).front();
+        b = core::random_vector(cell.size, rng);
+        x0.assign(cell.size, 0.0);
+        outputs = cell.size;
+    }
+
+    // Runs the kernel once on `backend` into values; returns its time.
+    auto run = [&](alg::Backend backend, std::span<double> values) {
+        core::ArenaScope scope;
+        if (cell.algo == "matmul") {
+            alg::MatMulOptions opts;
+            opts.backend = backend;
+            opts.scratch = scope.resource();
+            return compute_matmul<P>(a, b, static_cast<int>(cell.size), opts, values).elapsed_ms;
+        }
+        if (cell.algo == "fir") {
+            alg::FIROptions opts;
+            opts.backend = backend;
+            opts.scratch = scope.resource();
+            return compute_fir<P>(a, b, opts, values).elapsed_ms;
+        }
+        alg::GradientDescentOptions opts;
+        opts.max_iters = kTuneGdIters;
+        opts.tol = 0.0;
+        opts.backend = backend;
+        opts.scratch = scope.resource();
+        std::pmr::vector<T> x(cell.size, opts.scratch);
+        core::TimedRegion timing;
+        compute_gd<P>(a, b, x0, cell.size, opts, x, timing);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            values[i] = static_cast<double>(x[i]);
+        }
+        return timing.elapsed_ms;
+    };
+
+    core::TunedKernel kernel{cell.algo, fmt::precision_to_string(cell.precision), cell.size, {}, {}};
+    std::vector<double> reference(outputs);
+    std::vector<double> values(outputs);
+    for (auto backend : tune_candidates<P>(cell)) {
+        const bool is_reference = backend == alg::Backend::Reference;
+        run(backend, is_reference ? std::span<double>(reference) : std::span<double>(values));
+        bool exact = true;
+        for (std::size_t i = 0; i < outputs && !is_reference; ++i) {
+            exact = exact && std::bit_cast<uint64_t>(values[i]) == std::bit_cast<uint64_t>(reference[i]);
+        }
+        std::vector<double> times;
+        double total = 0.0;
+        while (times.size() < settings.samples ||
+               (total < settings.min_sample_total_ms && times.size() < kTuneMaxSamples)) {
+            times.push_back(run(backend, values));
+            total += times.back();
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        kernel.timings.push_back({alg::backend_to_string(backend), times[times.size() / 2], exact});
+    }
+    return kernel;
+}
+
+// The cells of a config's matmul, fir and gd_quadratic experiments, each
+// (algo, precision, size) once; mx precisions, which ignore the backend, and
+// newton, which has none, are left out.
+std::vector<TuneCell> tune_cells_from_config(const std::filesystem::path& path) {
+    std::vector<TuneCell> cells;
+    auto add = [&](const std::string& algo, fmt::Precision precision, std::size_t size, std::size_t signal_length) {
+        for (const auto& cell : cells) {
+            if (cell.algo == algo && cell.precision == precision && cell.size == size) {
+                return;
+            }
+        }
+        cells.push_back({algo, precision, size, signal_length});
+    };
+    json::load_object_streaming(path, "experiments", [&](json::Value exp_value) {
+        const auto& exp = exp_value.as_object();
+        const std::string algo = require_field(exp, "algo").as_string();
+        if (algo == "matmul") {
+            for (auto precision : parse_precisions(require_field(exp, "precisions"), true)) {
+                for (int size : parse_int_list(require_field(exp, "sizes"))) {
+                    if (!fmt::is_mx_precision(precision)) {
+                        add(algo, precision, static_cast<std::size_t>(size), 0);
                     }
                 }
             }
+        } else if (algo == "fir") {
+            auto taps = static_cast<std::size_t>(require_field(exp, "filter_order").as_number());
+            auto length = static_cast<std::size_t>(require_field(exp, "signal_length").as_number());
+            for (auto precision : parse_precisions(require_field(exp, "precisions"), true)) {
+                if (!fmt::is_mx_precision(precision)) {
+                    add(algo, precision, taps, length);
+                }
+            }
+        } else if (algo == "gd_quadratic") {
+            auto dim = static_cast<std::size_t>(require_field(exp, "dim").as_number());
+            for (auto precision : parse_precisions(require_field(exp, "precisions"))) {
+                add(algo, precision, dim, 0);
+            }
+        }
+    });
+    return cells;
+}
+
+// Without a config: the named formats over the sizes the example configs
+// use and the fixed kernels cover.
+std::vector<TuneCell> default_tune_cells() {
+    std::vector<TuneCell> cells;
+    for (auto precision : {fmt::Precision::FP64, fmt::Precision::FP32, fmt::Precision::TF32, fmt::Precision::BF16,
+                           fmt::Precision::P3109_8}) {
+        for (std::size_t n : {16, 32, 64, 128, 256}) {
+            cells.push_back({"matmul", precision, n, 0});
+        }
+        for (std::size_t taps : {8, 16, 32, 64}) {
+            cells.push_back({"fir", precision, taps, kTuneFirSignalLength});
+        }
+        for (std::size_t dim : {64, 256}) {
+            cells.push_back({"gd_quadratic", precision, dim, 0});
+        }
+    }
+    return cells;
+}
+
+} // namespace
+
+// `fpstudy merge --config C` or `fpstudy merge --out merged.csv shard.csv...`
+int run_merge(int argc, char** argv) {
+    std::optional<std::filesystem::path> config_path;
+    std::optional<std::filesystem::path> out_path;
+    std::vector<std::filesystem::path> shards;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if ((arg == "--out" || arg == "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: fpstudy merge --config path/to/config.json [--out PATH] [shard.csv...]\n"
+                      << "  Combines the CSVs of every --shard i/N run of one config into the row order of an\n"
+                      << "  unsharded run. Without shard CSVs, the shards of the config's out_csv are used;\n"
+                      << "  --out defaults to out_csv. Each shard CSV needs its <csv>.rows index next to it.\n";
+            return 0;
+        } else if (arg.starts_with("-")) {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        } else {
+            shards.emplace_back(arg);
+        }
+    }
+    if (config_path) {
+        auto config = json::load_object_streaming(*config_path, "experiments");
+        auto out_csv_path = std::filesystem::path(require_field(config, "out_csv").as_string());
+        if (!out_path) {
+            out_path = out_csv_path;
+        }
+        if (shards.empty()) {
+            shards = core::find_shard_csvs(out_csv_path);
+        }
+    }
+    if (!out_path || shards.empty()) {
+        std::cerr << "merge needs --config <path> or --out <path>, and at least one shard CSV.\n";
+        return 1;
+    }
+    std::size_t rows = core::merge_shards(shards, *out_path);
+    std::cout << "Merged " << shards.size() << " shards, " << rows << " rows into " << out_path->string() << "\n";
+    return 0;
+}
+
+// `fpstudy tune [--config C] [--out PATH]`
+int run_tune(int argc, char** argv) {
+    std::optional<std::filesystem::path> config_path;
+    std::filesystem::path out_path = core::default_profile_path();
+    TuneSettings settings;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if ((arg == "--out" || arg == "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            settings.samples = std::max<std::size_t>(1, static_cast<std::size_t>(std::stoul(argv[++i])));
+        } else if (arg == "--min-total-ms" && i + 1 < argc) {
+            settings.min_sample_total_ms = std::stod(argv[++i]);
+        } else if (arg == "--quick") {
+            settings = {3, 0.0};
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: fpstudy tune [--config path/to/config.json] [--out PATH] [--samples N]"
+                         " [--min-total-ms MS] [--quick]\n"
+                      << "  Times every backend of the matmul, fir and gd_quadratic kernels on this host and\n"
+                      << "  records the fastest one that matches the reference bit for bit, per (algo,\n"
+                      << "  precision, size). With --config, the config's cells are tuned; without, a default\n"
+                      << "  grid. Entries already in the profile for other cells are kept. --out defaults to\n"
+                      << "  " << core::default_profile_path().string() << ", which sweeps pick up by default.\n"
+                      << "  --samples N        timed runs per backend at least (default 7)\n"
+                      << "  --min-total-ms MS  keep sampling until the runs total MS (default 50)\n"
+                      << "  --quick            3 runs per backend, for smoke tests\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    const auto cells = config_path ? tune_cells_from_config(*config_path) : default_tune_cells();
+    core::BackendProfile profile(core::host_name());
+    if (std::filesystem::exists(out_path)) {
+        auto existing = core::BackendProfile::load(out_path);
+        if (existing.host() == profile.host()) {
+            profile = std::move(existing);
+        } else {
+            std::cerr << "warning: " << out_path.string() << " was tuned on " << existing.host()
+                      << "; replacing it\n";
+        }
+    }
+    for (const auto& cell : cells) {
+        auto kernel = fmt::dispatch_precision(cell.precision, [&](auto tag) {
+            return tune_cell<decltype(tag)::value>(cell, settings);
+        });
+        std::cout << cell.algo << "/" << kernel.precision << "/" << cell.size << ":";
+        for (const auto& timing : kernel.timings) {
+            std::cout << (&timing == &kernel.timings.front() ? " " : ", ") << timing.backend << " " << timing.ms
+                      << " ms" << (timing.exact ? "" : " (inexact)");
+        }
+        profile.record(std::move(kernel));
+        std::cout << " -> " << *profile.backend_for(cell.algo, fmt::precision_to_string(cell.precision), cell.size)
+                  << "\n";
+    }
+    profile.save(out_path);
+    std::cout << "Wrote " << profile.size() << " kernels to " << out_path.string() << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "merge") {
+        return run_merge(argc, argv);
+    }
+    if (argc > 1 && std::string_view(argv[1]) == "tune") {
+        return run_tune(argc, argv);
+    }
+    std::optional<std::filesystem::path> config_path;
+    std::size_t jobs = 1;
+    std::optional<std::filesystem::path> cache_dir;
+    std::optional<std::filesystem::path> binary_out;
+    bool resume = false;
+    bool perf_counters = false;
+    bool pipeline = false;
+    std::optional<std::filesystem::path> profile_path;
+    core::ShardSpec shard;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--config" || arg == "-c") && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            jobs = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--binary-out" && i + 1 < argc) {
+            binary_out = argv[++i];
+        } else if (arg == "--resume") {
+            resume = true;
+        } else if (arg == "--shard" && i + 1 < argc) {
+            shard = core::ShardSpec::parse(argv[++i]);
+        } else if (arg == "--perf-counters") {
+            perf_counters = true;
+        } else if (arg == "--pipeline") {
+            pipeline = true;
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: fpstudy --config path/to/config.json [--jobs N] [--cache-dir DIR] [--binary-out PATH]"
+                         " [--resume] [--shard i/N] [--perf-counters] [--pipeline] [--profile PATH]\n"
+                      << "       fpstudy merge --out merged.csv shard.csv...\n"
+                      << "       fpstudy tune [--config path/to/config.json] [--out PATH]\n"
+                      << "  --jobs N           run sweep cells on N worker threads (0 = all cores, default 1)\n"
+                      << "  --cache-dir DIR    reuse FP64 inputs and truths stored under DIR\n"
+                      << "  --binary-out PATH  also write the results as a columnar table to PATH\n"
+                      << "  --resume           skip cells recorded in <out_csv>.manifest and append the rest\n"
+                      << "  --shard i/N        run every N-th trial unit from unit i into <out_csv stem>.shard-i-of-N.csv\n"
+                      << "  --perf-counters    add cycles, instructions, cache_misses and branch_misses columns\n"
+                      << "                     measured with perf_event around each timed region (Linux)\n"
+                      << "  --pipeline         generate upcoming trials' inputs and truths on a separate thread\n"
+                      << "                     while the current cells run, and write rows on a writer thread\n"
+                      << "  --profile PATH     pick backends from this `fpstudy tune` profile (default\n"
+                      << "                     " << core::default_profile_path().string() << " if present)\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (!config_path) {
+        std::cerr << "Config path required. Use --config <path>.\n";
+        return 1;
+    }
+
+    core::set_perf_counters_enabled(perf_counters);
+
+    // The config is read twice as a stream: once for the settings, skipping
+    // the experiments array, and once more below, handing each experiment to
+    // its scheduler as soon as it is parsed. A generated sweep with a huge
+    // experiments list is therefore never held in memory as a whole.
+    const auto root = json::load_object_streaming(*config_path, "experiments");
+
+    uint32_t base_seed = static_cast<uint32_t>(require_field(root, "seed").as_number());
+    auto out_csv_path = std::filesystem::path(require_field(root, "out_csv").as_string());
+    if (shard.enabled()) {
+        out_csv_path = core::shard_csv_path(out_csv_path, shard);
+    }
+    require_field(root, "experiments");
+
+    // "cache_dir" in the config enables the truth cache; --cache-dir overrides it.
+    if (!cache_dir && root.contains("cache_dir")) {
+        cache_dir = require_field(root, "cache_dir").as_string();
+    }
+    core::TruthCache cache = cache_dir ? core::TruthCache(*cache_dir) : core::TruthCache();
+
+    // "out_binary" in the config adds the columnar table; --binary-out overrides it.
+    if (!binary_out && root.contains("out_binary")) {
+        binary_out = require_field(root, "out_binary").as_string();
+    }
+    if (binary_out && shard.enabled()) {
+        binary_out = core::shard_csv_path(*binary_out, shard);
+    }
+
+    // Experiments without a "backend" take the fastest exact backend per
+    // cell from the backend profile: --profile, else "backend_profile" in the
+    // config, else this host's default profile if one has been tuned. With
+    // no profile they run the reference kernels.
+    if (!profile_path && root.contains("backend_profile")) {
+        profile_path = require_field(root, "backend_profile").as_string();
+    }
+    std::optional<core::BackendProfile> profile;
+    if (profile_path || std::filesystem::exists(core::default_profile_path())) {
+        profile = core::BackendProfile::load(profile_path.value_or(core::default_profile_path()));
+        if (profile->host() != core::host_name()) {
+            std::cerr << "warning: backend profile was tuned on " << profile->host() << ", not on "
+                      << core::host_name() << "\n";
+        }
+    }
+
+    // --resume keeps the rows committed in the manifest, truncating anything
+    // written after the last commit, and appends the cells still missing.
+    core::SweepManifest completed;
+    std::optional<core::ManifestWriter> manifest;
+    const auto manifest_path = core::manifest_path_for(out_csv_path);
+    if (resume) {
+        if (binary_out) {
+            throw std::runtime_error("--binary-out cannot be combined with --resume");
+        }
+        completed = core::SweepManifest::load(manifest_path);
+        const bool have_csv = std::filesystem::exists(out_csv_path);
+        if (completed.committed_bytes() > 0) {
+            if (!have_csv || std::filesystem::file_size(out_csv_path) < completed.committed_bytes()) {
+                throw std::runtime_error("Manifest does not match " + out_csv_path.string() +
+                                         "; rerun without --resume");
+            }
+            // The appended rows must have the columns the kept ones have.
+            std::ifstream existing(out_csv_path);
+            std::string header_line;
+            std::getline(existing, header_line);
+            auto header = csv_header();
+            std::string expected = header.front();
+            for (std::size_t i = 1; i < header.size(); ++i) {
+                expected += "," + header[i];
+            }
+            if (header_line != expected) {
+                throw std::runtime_error(out_csv_path.string() + " has different columns; resume with the same "
+                                         "--perf-counters setting");
+            }
+            std::filesystem::resize_file(out_csv_path, completed.committed_bytes());
+        } else if (have_csv) {
+            std::filesystem::resize_file(out_csv_path, 0);
+        }
+        if (out_csv_path.has_parent_path()) {
+            std::filesystem::create_directories(out_csv_path.parent_path());
+        }
+        core::rewrite_manifest(manifest_path, completed);
+        manifest.emplace(manifest_path, true);
+        std::cout << "Resuming: " << completed.size() << " cells already in " << out_csv_path.string() << "\n";
+    }
+
+    CsvWriter writer(out_csv_path, resume);
+    writer.write_header(csv_header());
+    std::optional<core::ColumnarWriter> columnar;
+    if (binary_out) {
+        columnar.emplace(*binary_out, results_schema());
+    }
+
+    // A sharded run records the unsharded row number of each row it writes in
+    // <out_csv>.rows so `fpstudy merge` can interleave the shards again. On
+    // resume the index is cut back to the rows the truncated CSV still holds.
+    std::optional<core::RowIndexWriter> row_index;
+    if (shard.enabled()) {
+        std::size_t kept_rows = 0;
+        if (resume && writer.bytes_flushed() > 0) {
+            std::ifstream csv(out_csv_path, std::ios::binary);
+            kept_rows = static_cast<std::size_t>(
+                std::count(std::istreambuf_iterator<char>(csv), std::istreambuf_iterator<char>(), '\n')) - 1;
+        }
+        row_index.emplace(core::row_index_path_for(out_csv_path), shard, kept_rows);
+    }
+
+    core::OrderedRowSink sink(writer, columnar ? &*columnar : nullptr, manifest ? &*manifest : nullptr,
+                              row_index ? &*row_index : nullptr);
+    constexpr std::size_t kWriterQueueRows = 1024;
+    if (pipeline) {
+        sink.start_writer(kWriterQueueRows);
+    }
+    // The schedulers expand each experiment's cross product one trial unit
+    // at a time, and submit() blocks once kQueuedUnitsPerWorker units per
+    // worker are waiting, so expansion runs only a little ahead of the
+    // workers instead of queueing the whole sweep up front.
+    constexpr std::size_t kQueuedUnitsPerWorker = 4;
+    const std::size_t workers = core::resolve_job_count(jobs);
+    core::ThreadPool pool(workers, kQueuedUnitsPerWorker * workers);
+    // --pipeline: one data thread builds trial inputs and truths up to
+    // `lookahead` units ahead of the cells (one unit ahead per worker, and
+    // one past the inline loop of --jobs 1).
+    std::optional<core::ThreadPool> data_stage;
+    const std::size_t lookahead = std::max<std::size_t>(workers, 1);
+    if (pipeline) {
+        data_stage.emplace(1, lookahead);
+    }
+    SweepContext ctx{pool, sink, cache, completed, base_seed, shard, data_stage ? &*data_stage : nullptr,
+                     lookahead, profile ? &*profile : nullptr, 0, 0, {}};
+
+    json::load_object_streaming(*config_path, "experiments", [&](json::Value exp_value) {
+        const auto& exp = exp_value.as_object();
+        const std::string algo = require_field(exp, "algo").as_string();
+
+        if (algo == "matmul") {
+            schedule_matmul(exp, algo, ctx);
+        } else if (algo == "gd_quadratic") {
+            schedule_gd(exp, algo, ctx);
+        } else if (algo == "newton") {
+            schedule_newton(exp, algo, ctx);
+        } else if (algo == "fir") {
+            schedule_fir(exp, algo, ctx);
         } else {
+            pool.wait();
             throw std::runtime_error("Unsupported algo: " + algo);
         }
+    });
+    ctx.flush_units();
+    pool.wait();
+    sink.commit();
+    if (columnar) {
+        columnar->finish();
     }
 
     return 0;
 }
-
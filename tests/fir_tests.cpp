@@ -1,8 +1,161 @@
+#include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include <span>
 #include <vector>
 
+#include "algorithms/fft.hpp"
 #include "algorithms/fir.hpp"
+#include "algorithms/fir_stream.hpp"
+#include "algorithms/mx.hpp"
+#include "formats/precision.hpp"
+
+namespace {
+
+template <typename T>
+bool backend_fir_matches_reference(std::size_t taps, std::size_t length, fpstudy::algorithms::Backend backend,
+                                   const char* name) {
+    std::mt19937 engine(static_cast<uint32_t>(taps * 101 + length));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> h(taps);
+    std::vector<double> x(length);
+    for (double& v : h) v = dist(engine) / static_cast<double>(taps);
+    for (double& v : x) v = dist(engine);
+    auto ht = fpstudy::formats::cast_vector<T>(h);
+    auto xt = fpstudy::formats::cast_vector<T>(x);
+    for (bool kahan : {false, true}) {
+        for (bool fp32 : {false, true}) {
+            fpstudy::algorithms::FIROptions ref_opts{kahan, fp32};
+            fpstudy::algorithms::FIROptions vec_opts{kahan, fp32, backend};
+            auto ref = fpstudy::algorithms::fir_filter<T>(ht, xt, ref_opts);
+            auto vec = fpstudy::algorithms::fir_filter<T>(ht, xt, vec_opts);
+            for (std::size_t i = 0; i < ref.size(); ++i) {
+                if (std::bit_cast<uint64_t>(static_cast<double>(ref[i])) !=
+                    std::bit_cast<uint64_t>(static_cast<double>(vec[i]))) {
+                    std::cerr << fpstudy::algorithms::backend_to_string(backend) << " FIR (" << name << ", M=" << taps
+                              << ", N=" << length
+                              << ") differs at index " << i << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Feeding the signal through FirStream in uneven blocks must reproduce the
+// batch filter bit for bit, including across the prologue boundary.
+template <typename T>
+bool stream_fir_matches_batch(std::size_t taps, std::size_t length, const char* name) {
+    std::mt19937 engine(static_cast<uint32_t>(taps * 13 + length));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> h(taps);
+    std::vector<double> x(length);
+    for (double& v : h) v = dist(engine) / static_cast<double>(taps);
+    for (double& v : x) v = dist(engine);
+    auto ht = fpstudy::formats::cast_vector<T>(h);
+    auto xt = fpstudy::formats::cast_vector<T>(x);
+    for (bool kahan : {false, true}) {
+        for (bool fp32 : {false, true}) {
+            fpstudy::algorithms::FIROptions opts{kahan, fp32};
+            auto batch = fpstudy::algorithms::fir_filter<T>(ht, xt, opts);
+            for (std::size_t block : {std::size_t{1}, std::size_t{3}, taps, std::size_t{64}}) {
+                fpstudy::algorithms::FirStream<T> stream(ht, opts);
+                std::size_t read_pos = 0;
+                std::vector<T> streamed;
+                stream.filter(
+                    [&](std::span<T> buffer) {
+                        std::size_t count = std::min(buffer.size(), xt.size() - read_pos);
+                        std::copy(xt.begin() + read_pos, xt.begin() + read_pos + count, buffer.begin());
+                        read_pos += count;
+                        return count;
+                    },
+                    [&](std::span<const T> out) { streamed.insert(streamed.end(), out.begin(), out.end()); },
+                    std::max<std::size_t>(block, 1));
+                if (streamed.size() != batch.size() || stream.samples_processed() != length) {
+                    std::cerr << "FirStream (" << name << ") produced " << streamed.size() << " samples\n";
+                    return false;
+                }
+                for (std::size_t i = 0; i < batch.size(); ++i) {
+                    if (std::bit_cast<uint64_t>(static_cast<double>(batch[i])) !=
+                        std::bit_cast<uint64_t>(static_cast<double>(streamed[i]))) {
+                        std::cerr << "FirStream (" << name << ", M=" << taps << ", block=" << block
+                                  << ") differs at index " << i << "\n";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Overlap-save output must stay within its documented bound of a long double
+// direct convolution.
+bool fft_fir_within_bound(std::size_t taps, std::size_t length) {
+    std::mt19937 engine(static_cast<uint32_t>(taps * 7 + length));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> h(taps);
+    std::vector<double> x(length);
+    for (double& v : h) v = dist(engine) / static_cast<double>(taps);
+    for (double& v : x) v = dist(engine);
+    auto y = fpstudy::algorithms::fir_filter_fft(h, x);
+    double err = 0.0;
+    double norm = 0.0;
+    for (std::size_t n = 0; n < length; ++n) {
+        long double exact = 0.0L;
+        for (std::size_t k = 0; k < taps && k <= n; ++k) {
+            exact += static_cast<long double>(h[k]) * static_cast<long double>(x[n - k]);
+        }
+        double diff = static_cast<double>(static_cast<long double>(y[n]) - exact);
+        err += diff * diff;
+        norm += static_cast<double>(exact * exact);
+    }
+    err = std::sqrt(err);
+    double bound = fpstudy::algorithms::fir_filter_fft_error_bound(h, x);
+    if (y.size() != length || err > bound || err > 1e-12 * std::sqrt(norm)) {
+        std::cerr << "FFT FIR (M=" << taps << ", N=" << length << ") error " << err
+                  << " exceeds bound " << bound << "\n";
+        return false;
+    }
+    return true;
+}
+
+// MX filtering against an FP64 filter of the decoded taps and signal, within
+// the FP32 rounding of the segment sums, for windows that straddle tap and
+// signal blocks.
+bool mx_fir_within_bound(std::size_t taps, std::size_t length) {
+    using fpstudy::formats::MxVector;
+    std::mt19937 engine(static_cast<uint32_t>(taps * 7 + length));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> h(taps);
+    std::vector<double> x(length);
+    for (double& v : h) v = dist(engine) / static_cast<double>(taps);
+    for (double& v : x) v = std::ldexp(dist(engine), static_cast<int>(engine() % 13) - 6);
+    auto hm = MxVector::encode({4, 3, 7}, h);
+    auto xm = MxVector::encode({4, 3, 7}, x);
+    auto y = fpstudy::algorithms::fir_filter_mx(hm, xm);
+    auto hd = hm.to_doubles();
+    auto xd = xm.to_doubles();
+    for (std::size_t n = 0; n < length; ++n) {
+        double exact = 0.0;
+        double magnitude = 0.0;
+        for (std::size_t k = 0; k < taps && k <= n; ++k) {
+            exact += hd[k] * xd[n - k];
+            magnitude += std::fabs(hd[k] * xd[n - k]);
+        }
+        if (std::fabs(y[n] - exact) > 1e-6 * magnitude) {
+            std::cerr << "fir_filter_mx taps=" << taps << " length=" << length << ": sample " << n << " is off\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 bool run_fir_tests() {
     // Test case: Simple 2-tap moving average filter
@@ -53,6 +206,48 @@ bool run_fir_tests() {
             return false;
         }
     }
+
+    // Vectorized backend vs reference, including signals shorter than the filter.
+    using fpstudy::algorithms::Backend;
+    for (auto [taps, length] : {std::pair<std::size_t, std::size_t>{1, 9}, {8, 5}, {8, 100}, {33, 257}}) {
+        if (!backend_fir_matches_reference<float>(taps, length, Backend::Vectorized, "fp32") ||
+            !backend_fir_matches_reference<fpstudy::formats::BF16>(taps, length, Backend::Vectorized, "bf16") ||
+            !backend_fir_matches_reference<fpstudy::formats::TF32>(taps, length, Backend::Vectorized, "tf32")) {
+            return false;
+        }
+    }
+
+    // Fixed-tap kernels, for every specialized count (and one that falls
+    // back), on signals shorter and longer than the filter.
+    for (auto [taps, length] : {std::pair<std::size_t, std::size_t>{8, 5}, {8, 100}, {16, 16}, {32, 300}, {12, 40}}) {
+        if (!backend_fir_matches_reference<double>(taps, length, Backend::Fixed, "fp64") ||
+            !backend_fir_matches_reference<float>(taps, length, Backend::Fixed, "fp32") ||
+            !backend_fir_matches_reference<fpstudy::formats::BF16>(taps, length, Backend::Fixed, "bf16") ||
+            !backend_fir_matches_reference<fpstudy::formats::P3109Number<>>(taps, length, Backend::Fixed, "p3109_8")) {
+            return false;
+        }
+    }
+
+    for (auto [taps, length] : {std::pair<std::size_t, std::size_t>{1, 9}, {8, 5}, {17, 300}}) {
+        if (!stream_fir_matches_batch<double>(taps, length, "fp64") ||
+            !stream_fir_matches_batch<float>(taps, length, "fp32") ||
+            !stream_fir_matches_batch<fpstudy::formats::BF16>(taps, length, "bf16") ||
+            !stream_fir_matches_batch<fpstudy::formats::P3109Number<>>(taps, length, "p3109_8")) {
+            return false;
+        }
+    }
+
+    for (auto [taps, length] : {std::pair<std::size_t, std::size_t>{1, 9}, {8, 5}, {33, 1000}, {700, 5000}}) {
+        if (!fft_fir_within_bound(taps, length)) {
+            return false;
+        }
+    }
+
+    for (auto [taps, length] : {std::pair<std::size_t, std::size_t>{1, 9}, {8, 5}, {33, 100}, {70, 300}}) {
+        if (!mx_fir_within_bound(taps, length)) {
+            return false;
+        }
+    }
     
     return true;
 }
@@ -0,0 +1,355 @@
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "algorithms/packed.hpp"
+#include "formats/dispatch.hpp"
+#include "formats/mx.hpp"
+#include "formats/packed.hpp"
+#include "formats/quantize.hpp"
+
+namespace {
+
+template <fpstudy::formats::P3109Layout Layout>
+bool check_codec_matches_reference(const char* name) {
+    using Codec = fpstudy::formats::P3109Codec<Layout>;
+    constexpr int codes = 1 << Layout.width();
+
+    // Every code must decode to the same bits as the ldexp-based reference.
+    for (int code = 0; code < codes; ++code) {
+        float fast = Codec::decode(static_cast<uint8_t>(code));
+        float ref = fpstudy::formats::p3109_dequantize(static_cast<uint8_t>(code), Layout);
+        if (std::bit_cast<uint32_t>(fast) != std::bit_cast<uint32_t>(ref)) {
+            std::cerr << name << ": decode mismatch for code " << code << "\n";
+            return false;
+        }
+    }
+
+    // Encode a strided walk over all float bit patterns plus every decoded value
+    // and its rounding midpoints, where the two paths are most likely to diverge.
+    std::vector<float> samples;
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFull; bits += 251) {
+        samples.push_back(std::bit_cast<float>(static_cast<uint32_t>(bits)));
+    }
+    for (int code = 0; code < codes; ++code) {
+        float v = Codec::decode(static_cast<uint8_t>(code));
+        float next = Codec::decode(static_cast<uint8_t>((code + 1) % codes));
+        samples.push_back(v);
+        samples.push_back(std::nextafter(v, 0.0f));
+        samples.push_back(std::nextafter(v, v * 2.0f));
+        if (std::isfinite(v) && std::isfinite(next)) {
+            float mid = v + (next - v) * 0.5f;
+            samples.push_back(mid);
+            samples.push_back(std::nextafter(mid, 0.0f));
+            samples.push_back(std::nextafter(mid, mid * 2.0f));
+        }
+    }
+    for (float v : samples) {
+        uint8_t fast = Codec::encode(v);
+        uint8_t ref = fpstudy::formats::p3109_quantize(v, Layout);
+        if (fast != ref) {
+            std::cerr << name << ": encode mismatch for bits 0x" << std::hex
+                      << std::bit_cast<uint32_t>(v) << std::dec << " (fast " << int(fast)
+                      << ", reference " << int(ref) << ")\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool same_double(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return std::bit_cast<uint64_t>(a) == std::bit_cast<uint64_t>(b);
+}
+
+// Packed encode/decode must agree with building T element by element.
+template <fpstudy::formats::Precision P>
+bool check_packed_matches_cast(const char* name) {
+    using T = typename fpstudy::formats::PrecisionTraits<P>::type;
+    std::mt19937 engine(1234);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> input = {0.0, -0.0, 1.0, -1.5, 1e-39, -1e-45, 3.4e38, 3.5e38, -1e300,
+                                 std::numeric_limits<double>::infinity(),
+                                 -std::numeric_limits<double>::infinity(),
+                                 std::numeric_limits<double>::quiet_NaN()};
+    for (int scale = -20; scale <= 20; scale += 5) {
+        for (int i = 0; i < 200; ++i) {
+            input.push_back(std::ldexp(dist(engine), scale));
+        }
+    }
+    auto packed = fpstudy::formats::PackedVector<P>::encode(input);
+    auto decoded = packed.to_doubles();
+    auto expected = fpstudy::formats::to_double_vector(fpstudy::formats::cast_vector<T>(input));
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        if (!same_double(decoded[i], expected[i]) || !same_double(static_cast<double>(packed[i]), expected[i])) {
+            std::cerr << name << ": packed encode of " << input[i] << " gives " << decoded[i]
+                      << ", expected " << expected[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+template <fpstudy::formats::Precision P>
+bool check_packed_kernels(const char* name) {
+    namespace alg = fpstudy::algorithms;
+    using T = typename fpstudy::formats::PrecisionTraits<P>::type;
+    const std::size_t n = 19;
+    std::mt19937 engine(99);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(n * n);
+    std::vector<double> B(n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : B) v = dist(engine);
+    auto Ap = fpstudy::formats::PackedVector<P>::encode(A);
+    auto Bp = fpstudy::formats::PackedVector<P>::encode(B);
+    auto At = fpstudy::formats::cast_vector<T>(A);
+    auto Bt = fpstudy::formats::cast_vector<T>(B);
+    // Packed temporaries come from a small monotonic resource, as in a sweep
+    // cell, so the scratch path is exercised past its first buffer.
+    std::pmr::monotonic_buffer_resource scratch(256);
+    for (auto backend : {alg::Backend::Reference, alg::Backend::Vectorized}) {
+        for (bool fp32 : {false, true}) {
+            auto packed = alg::matmul_square(Ap, Bp, n, {false, fp32, backend, &scratch}).to_doubles();
+            auto plain = fpstudy::formats::to_double_vector(alg::matmul_square<T>(At, Bt, n, {false, fp32}));
+            auto packed_fir = alg::fir_filter(Ap, Bp, {true, fp32, backend, &scratch}).to_doubles();
+            auto plain_fir = fpstudy::formats::to_double_vector(alg::fir_filter<T>(At, Bt, {true, fp32}));
+            for (std::size_t i = 0; i < plain.size(); ++i) {
+                if (!same_double(packed[i], plain[i]) || !same_double(packed_fir[i], plain_fir[i])) {
+                    std::cerr << name << ": packed kernel differs at index " << i << " ("
+                              << alg::backend_to_string(backend) << ", fp32=" << fp32 << ")\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool check_dispatch() {
+    using fpstudy::formats::Precision;
+    for (auto p : fpstudy::formats::all_precisions()) {
+        auto dispatched = fpstudy::formats::dispatch_precision(p, [](auto tag) { return decltype(tag)::value; });
+        if (dispatched != p) {
+            std::cerr << "dispatch_precision routed " << fpstudy::formats::precision_to_string(p) << " wrongly\n";
+            return false;
+        }
+    }
+    // Re-encoding into a slot must reuse its allocation.
+    fpstudy::formats::ConversionBuffers<1> buffers;
+    std::vector<double> input(100, 0.5);
+    const auto* first = buffers.encode<Precision::BF16>(0, input).codes().data();
+    const auto* second = buffers.encode<Precision::BF16>(0, input).codes().data();
+    auto values = buffers.values<Precision::TF32>(0, input);
+    return first == second && values.size() == input.size() && static_cast<double>(values[7]) == 0.5;
+}
+
+bool check_minifloat_names() {
+    using namespace fpstudy::formats;
+    if (precision_from_string("minifloat:e4m3") != kMiniFloatE4M3 ||
+        precision_from_string("MiniFloat:E5M2:Bias15") != kMiniFloatE5M2 ||
+        precision_to_string(kMiniFloatE2M3) != "minifloat:e2m3:bias1") {
+        std::cerr << "minifloat precision names do not round-trip\n";
+        return false;
+    }
+    const Precision custom = precision_from_string("minifloat:e3m3:bias-2");
+    if (!is_minifloat_precision(custom) || minifloat_layout(custom) != P3109Layout{3, 3, -2} ||
+        precision_from_string(precision_to_string(custom)) != custom) {
+        std::cerr << "custom minifloat layout does not round-trip\n";
+        return false;
+    }
+    for (const char* bad : {"minifloat:e4", "minifloat:e1m4", "minifloat:e5m3", "minifloat:e4m3:bias",
+                            "minifloat:e4m3:7", "minifloat:e6m1:bias-100"}) {
+        try {
+            precision_from_string(bad);
+            std::cerr << "precision_from_string accepted " << bad << "\n";
+            return false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    return true;
+}
+
+// A layout without a compiled instantiation runs on the runtime tables, which
+// must equal the compiled tables of the same layout code for code.
+template <fpstudy::formats::P3109Layout Layout>
+bool check_runtime_minifloat(const char* name) {
+    using namespace fpstudy::formats;
+    const Precision p = minifloat_precision(Layout);
+    const bool routed = dispatch_precision(p, [&](auto tag) {
+        if constexpr (decltype(tag)::value == Precision::MiniFloatRuntime) {
+            using Runtime = PrecisionTraits<Precision::MiniFloatRuntime>::type;
+            const auto& format = active_minifloat_format();
+            const auto& fp32 = format.tables<AccumulateFp32>();
+            const auto& round = format.tables<RoundEachOp>();
+            const auto& expected_fp32 = P3109OpTables<AccumulateFp32, P3109Codec<Layout>>::get();
+            const auto& expected_round = P3109OpTables<RoundEachOp, P3109Codec<Layout>>::get();
+            bool same = resolve_precision(decltype(tag)::value) == p && fp32.add == expected_fp32.add &&
+                        fp32.mul == expected_fp32.mul && fp32.div == expected_fp32.div &&
+                        round.sub == expected_round.sub && round.mul == expected_round.mul;
+            for (int code = 0; code < (1 << Layout.width()); ++code) {
+                const float v = P3109Codec<Layout>::decode(static_cast<uint8_t>(code));
+                same = same && std::bit_cast<uint32_t>(static_cast<float>(Runtime(static_cast<uint8_t>(code)))) ==
+                                   std::bit_cast<uint32_t>(v) &&
+                       Runtime(v * 1.01f).raw() == P3109Codec<Layout>::encode(v * 1.01f);
+            }
+            return same;
+        } else {
+            return false;
+        }
+    });
+    if (!routed) {
+        std::cerr << name << ": runtime minifloat differs from the compiled layout\n";
+    }
+    return routed;
+}
+
+// Each policy's operators must match their definition, and the two
+// instantiations must be usable concurrently without shared state.
+template <typename Policy>
+bool policy_sum_matches(const std::vector<double>& terms, float& out) {
+    using T = fpstudy::formats::P3109Number<Policy>;
+    using Codec = typename T::Codec;
+    T acc(0.0f);
+    uint8_t expected = Codec::encode(0.0f);
+    for (double v : terms) {
+        T term(v);
+        acc += term * T(0.75f);
+        float product = Policy::finish(Codec{}, Codec::decode(term.raw()) * 0.75f);
+        float sum = Codec::decode(expected) + Codec::decode(Codec::encode(product));
+        expected = Codec::encode(Policy::finish(Codec{}, sum));
+        if (acc.raw() != expected) {
+            return false;
+        }
+    }
+    out = static_cast<float>(acc);
+    return true;
+}
+
+bool check_accumulation_policies() {
+    using fpstudy::formats::AccumulateFp32;
+    using fpstudy::formats::P3109Number;
+    using fpstudy::formats::RoundEachOp;
+    static_assert(sizeof(P3109Number<RoundEachOp>) == 1);
+    static_assert(P3109Number<>::accumulate_fp32() && !P3109Number<RoundEachOp>::accumulate_fp32());
+
+    std::mt19937 engine(41);
+    std::normal_distribution<double> dist(0.0, 0.5);
+    std::vector<double> terms(2000);
+    for (double& v : terms) v = dist(engine);
+
+    bool ok_fp32 = false;
+    bool ok_round = false;
+    float sum_fp32 = 0.0f;
+    float sum_round = 0.0f;
+    std::thread a([&] { ok_fp32 = policy_sum_matches<AccumulateFp32>(terms, sum_fp32); });
+    std::thread b([&] { ok_round = policy_sum_matches<RoundEachOp>(terms, sum_round); });
+    a.join();
+    b.join();
+    float serial = 0.0f;
+    if (!ok_fp32 || !ok_round || !policy_sum_matches<AccumulateFp32>(terms, serial) || serial != sum_fp32) {
+        std::cerr << "P3109Number accumulation policies disagree with their definition\n";
+        return false;
+    }
+
+    std::vector<P3109Number<>> codes = {P3109Number<>(0.5f), P3109Number<>(-3.0f)};
+    auto rebound = fpstudy::formats::rebind_policy<RoundEachOp>(std::span<const P3109Number<>>(codes));
+    return rebound.size() == 2 && rebound[0].raw() == codes[0].raw() && rebound[1].raw() == codes[1].raw();
+}
+
+// MX blocks: the shared exponent puts the block maximum in the element
+// layout's top binade, values within range round-trip exactly, specials keep
+// their codes, and blocks restart at every row.
+bool check_mx_vector() {
+    using namespace fpstudy::formats;
+    const P3109Layout e4m3{4, 3, 7};  // largest finite 240 = 1.875 * 2^7
+    std::vector<double> row = {3.0, -0.5, 0.125, std::ldexp(1.0, -10), 0.0, -2.75,
+                               std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()};
+    row.resize(40, 1.0);
+    row[39] = 1e6;
+    std::vector<double> input = row;
+    input.insert(input.end(), row.begin(), row.end());
+    auto mx = MxVector::encode(e4m3, input, row.size());
+    auto decoded = mx.to_doubles();
+    if (mx.blocks() != 4 || mx.block_of(39) != 1 || mx.block_of(40) != 2 || mx.scale_exponent(0) != 1 - 7 ||
+        mx.scale_exponent(1) != 19 - 7 || mx.scale_exponent(2) != mx.scale_exponent(0) ||
+        mx.bytes() != input.size() + 4) {
+        std::cerr << "MxVector blocks or scales are wrong\n";
+        return false;
+    }
+    for (std::size_t i : {0, 1, 2, 3, 4, 5, 41, 42}) {
+        if (!same_double(decoded[i], input[i])) {
+            std::cerr << "MxVector does not round-trip " << input[i] << "\n";
+            return false;
+        }
+    }
+    // Block 1 scales by 2^12: 1e6 saturates to 240 * 2^12 and 1.0 flushes.
+    if (!std::isinf(decoded[6]) || !std::isnan(decoded[7]) || decoded[39] != 240.0 * 4096.0 || decoded[32] != 0.0) {
+        std::cerr << "MxVector mishandles specials or saturation\n";
+        return false;
+    }
+    try {
+        MxVector::encode(e4m3, input, 30);
+        std::cerr << "MxVector accepted a partial row\n";
+        return false;
+    } catch (const std::runtime_error&) {
+    }
+    return precision_to_string(precision_from_string("MX:E2M1")) == "mx:e2m1:bias1" &&
+           is_mx_precision(precision_from_string("mx:e4m3:bias7"));
+}
+
+} // namespace
+
+bool run_format_tests() {
+    using fpstudy::formats::Precision;
+    using fpstudy::formats::P3109Layout;
+    if (!check_codec_matches_reference<P3109Layout{}>("default layout")) {
+        return false;
+    }
+    if (!check_codec_matches_reference<P3109Layout{2, 5, 1}>("e2m5 layout")) {
+        return false;
+    }
+    if (!check_codec_matches_reference<P3109Layout{4, 3, 7}>("e4m3 layout") ||
+        !check_codec_matches_reference<P3109Layout{5, 2, 15}>("e5m2 layout") ||
+        !check_codec_matches_reference<P3109Layout{3, 2, 3}>("e3m2 layout") ||
+        !check_codec_matches_reference<P3109Layout{2, 3, 1}>("e2m3 layout")) {
+        return false;
+    }
+    if (!check_packed_matches_cast<Precision::FP64>("packed fp64") ||
+        !check_packed_matches_cast<Precision::FP32>("packed fp32") ||
+        !check_packed_matches_cast<Precision::TF32>("packed tf32") ||
+        !check_packed_matches_cast<Precision::BF16>("packed bf16") ||
+        !check_packed_matches_cast<Precision::P3109_8>("packed p3109_8") ||
+        !check_packed_matches_cast<fpstudy::formats::kMiniFloatE4M3>("packed e4m3")) {
+        return false;
+    }
+    if (fpstudy::formats::p3109_op_table_mismatches<fpstudy::formats::AccumulateFp32>() != 0 ||
+        fpstudy::formats::p3109_op_table_mismatches<fpstudy::formats::RoundEachOp>() != 0 ||
+        fpstudy::formats::p3109_op_table_mismatches<fpstudy::formats::RoundEachOp, P3109Layout{4, 3, 7}>() != 0 ||
+        fpstudy::formats::p3109_op_table_mismatches<fpstudy::formats::AccumulateFp32, P3109Layout{2, 3, 1}>() != 0) {
+        std::cerr << "P3109 operation tables differ from the quantize/dequantize round trip\n";
+        return false;
+    }
+    if (!check_dispatch() || !check_accumulation_policies() || !check_minifloat_names() || !check_mx_vector() ||
+        !check_runtime_minifloat<P3109Layout{3, 3, 2}>("e3m3 runtime") ||
+        !check_runtime_minifloat<P3109Layout{4, 2, 5}>("e4m2 runtime")) {
+        return false;
+    }
+    if (!check_packed_kernels<Precision::TF32>("packed tf32") ||
+        !check_packed_kernels<Precision::BF16>("packed bf16") ||
+        !check_packed_kernels<Precision::P3109_8>("packed p3109_8") ||
+        !check_packed_kernels<fpstudy::formats::kMiniFloatE5M2>("packed e5m2")) {
+        return false;
+    }
+    return true;
+}
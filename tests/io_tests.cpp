@@ -1,9 +1,26 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "core/arena.hpp"
+#include "core/cache.hpp"
 #include "core/io.hpp"
+#include "core/manifest.hpp"
+#include "core/metrics.hpp"
+#include "core/philox.hpp"
+#include "core/random.hpp"
+#include "core/scheduler.hpp"
+#include "core/shard.hpp"
+#include "core/table.hpp"
+#include "core/tuning.hpp"
 
 bool run_io_tests() {
     auto temp_dir = std::filesystem::temp_directory_path();
@@ -27,6 +44,445 @@ bool run_io_tests() {
     std::string expected_header = "algo,size,precision,seed,params_json,rel_error,iters,converged,n_nan,n_inf,elapsed_ms";
     bool ok = line == expected_header;
     std::filesystem::remove(csv_path);
+    if (!ok) {
+        return false;
+    }
+
+    // Rows pushed out of order from worker threads must come out in index order.
+    auto ordered_path = temp_dir / "fpstudy_ordered_sink.csv";
+    {
+        fpstudy::core::CsvWriter writer(ordered_path, false);
+        writer.write_header({"index"});
+        fpstudy::core::OrderedRowSink sink(writer);
+        fpstudy::core::ThreadPool pool(4);
+        for (int i = 63; i >= 0; --i) {
+            pool.submit([&sink, i] { sink.push(static_cast<std::size_t>(i), {std::to_string(i)}); });
+        }
+        pool.wait();
+        ok = sink.rows_written() == 64 && sink.rows_pending() == 0;
+    }
+    std::ifstream ordered(ordered_path);
+    std::getline(ordered, line);
+    for (int i = 0; ok && i < 64; ++i) {
+        ok = std::getline(ordered, line) && line == std::to_string(i);
+    }
+    ordered.close();
+    std::filesystem::remove(ordered_path);
+    if (!ok) {
+        return false;
+    }
+
+    // The same through the writer thread, with a queue shorter than the run
+    // before the first row arrives.
+    {
+        fpstudy::core::CsvWriter writer(ordered_path, false);
+        writer.write_header({"index"});
+        fpstudy::core::OrderedRowSink sink(writer);
+        sink.start_writer(4);
+        fpstudy::core::ThreadPool pool(4);
+        for (int i = 255; i >= 0; --i) {
+            pool.submit([&sink, i] { sink.push(static_cast<std::size_t>(i), {std::to_string(i)}); });
+        }
+        pool.wait();
+        sink.commit();
+        ok = sink.rows_written() == 256 && sink.rows_pending() == 0;
+    }
+    ordered.open(ordered_path);
+    std::getline(ordered, line);
+    for (int i = 0; ok && i < 256; ++i) {
+        ok = std::getline(ordered, line) && line == std::to_string(i);
+    }
+    ordered.close();
+    std::filesystem::remove(ordered_path);
+    if (!ok) {
+        return false;
+    }
+
+    // A bounded pool still runs every task, including nested submissions,
+    // while an outside submitter waits for queue space.
+    {
+        std::atomic<int> done{0};
+        fpstudy::core::ThreadPool pool(2, 1);
+        for (int i = 0; i < 50; ++i) {
+            pool.submit([&pool, &done] {
+                pool.submit([&done] { ++done; });
+                ++done;
+            });
+        }
+        pool.wait();
+        if (done != 100) {
+            return false;
+        }
+    }
+
+    // Streamed configs: the settings come back without the experiments, and
+    // the experiments arrive one at a time, in order, equal to what the DOM
+    // parser builds, whatever their position and across buffer refills.
+    auto config_path = temp_dir / "fpstudy_streamed_config.json";
+    {
+        std::ofstream config(config_path, std::ios::binary);
+        config << "{ \"experiments\" : [\n";
+        for (int i = 0; i < 3000; ++i) {
+            config << (i > 0 ? ",\n" : "") << "  {\"algo\": \"fir\", \"note\": \"[{\\\"\\\\" << i
+                   << "\", \"sizes\": [" << i << ", -1.5e-3], \"nested\": {\"ok\": true, \"none\": null}}";
+        }
+        config << "],\n \"seed\": 42, \"padding\": \"" << std::string(3 * 65536 + 7, 'x') << "\", \"out_csv\": \"r.csv\"}\n";
+    }
+    {
+        auto dom = fpstudy::core::json::load_file(config_path);
+        const auto& all = dom.as_object().at("experiments").as_array();
+        auto root = fpstudy::core::json::load_object_streaming(config_path, "experiments");
+        ok = root.at("seed").as_number() == 42 && root.at("out_csv").as_string() == "r.csv" &&
+             root.at("padding").as_string().size() == 3 * 65536 + 7 && root.at("experiments").as_array().empty();
+        std::size_t seen = 0;
+        fpstudy::core::json::load_object_streaming(config_path, "experiments", [&](fpstudy::core::json::Value exp) {
+            ok = ok && seen < all.size() &&
+                 fpstudy::core::json::serialize_compact(exp) == fpstudy::core::json::serialize_compact(all[seen]) &&
+                 exp.as_object().at("note").as_string() == "[{\"\\" + std::to_string(seen);
+            ++seen;
+        });
+        ok = ok && seen == 3000;
+        bool rejected = false;
+        try {
+            fpstudy::core::json::load_object_streaming(config_path, "seed", [](fpstudy::core::json::Value) {});
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        ok = ok && rejected;
+    }
+    std::filesystem::remove(config_path);
+    if (!ok) {
+        return false;
+    }
+
+    // Truth cache: round trip, key mismatch and a truncated entry.
+    auto cache_dir = temp_dir / "fpstudy_cache_test";
+    std::filesystem::remove_all(cache_dir);
+    {
+        fpstudy::core::TruthCache cache(cache_dir);
+        fpstudy::core::CacheKey key("matmul");
+        key.add_int("size", 3).add_int("trial_seed", 42).add_bool("kahan", false);
+        std::vector<double> truth = {1.0, -0.0, 1e-300, 3.5};
+        fpstudy::core::CacheRecord record;
+        record.put("truth", truth);
+        record.put_scalar("elapsed", 2.25);
+        ok = !cache.load(key) && cache.store(key, record);
+        auto hit = cache.load(key);
+        ok = ok && hit && hit->vector("truth").size() == truth.size() && hit->scalar("elapsed") == 2.25;
+        for (std::size_t i = 0; ok && i < truth.size(); ++i) {
+            ok = std::signbit(hit->vector("truth")[i]) == std::signbit(truth[i]) && hit->vector("truth")[i] == truth[i];
+        }
+        fpstudy::core::CacheKey other("matmul");
+        other.add_int("size", 3).add_int("trial_seed", 43).add_bool("kahan", false);
+        ok = ok && !cache.load(other);
+        auto path = cache.path_for(key);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        ok = ok && !cache.load(key);
+    }
+    std::filesystem::remove_all(cache_dir);
+    if (!ok) {
+        return false;
+    }
+
+    // Typed rows: CSV keeps the std::to_string text, the columnar table keeps
+    // full precision and reads back in place across batch boundaries.
+    auto typed_csv = temp_dir / "fpstudy_typed_rows.csv";
+    auto table_path = temp_dir / "fpstudy_rows.fpt";
+    {
+        fpstudy::core::CsvWriter writer(typed_csv, false);
+        writer.write_header({"name", "value", "count"});
+        fpstudy::core::ColumnarWriter columnar(table_path,
+                                               {{"name", fpstudy::core::ColumnType::String},
+                                                {"value", fpstudy::core::ColumnType::Float64},
+                                                {"count", fpstudy::core::ColumnType::Int64}},
+                                               3);
+        fpstudy::core::OrderedRowSink sink(writer, &columnar);
+        for (int i = 6; i >= 0; --i) {
+            std::string name = i == 2 ? std::string("a,\"b\"") : "row" + std::to_string(i);
+            sink.push(static_cast<std::size_t>(i), {name, 1.0 / (i + 1), static_cast<int64_t>(i) - 3});
+        }
+        bool rejected = false;
+        try {
+            columnar.write_row({1.0, 1.0, static_cast<int64_t>(0)});
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        ok = rejected;
+    }
+    std::ifstream typed(typed_csv);
+    std::getline(typed, line);
+    std::getline(typed, line);
+    ok = ok && line == "row0," + std::to_string(1.0) + ",-3";
+    std::getline(typed, line);
+    std::getline(typed, line);
+    ok = ok && line == "\"a,\"\"b\"\"\"," + std::to_string(1.0 / 3) + ",-1";
+    {
+        fpstudy::core::ColumnarTable table(table_path);
+        ok = ok && table.rows() == 7 && table.batch_count() == 3 && table.column_index("count") == 2;
+        std::size_t row = 0;
+        for (std::size_t b = 0; ok && b < table.batch_count(); ++b) {
+            auto values = table.float64(b, 1);
+            auto counts = table.int64(b, 2);
+            for (std::size_t r = 0; ok && r < table.batch_rows(b); ++r, ++row) {
+                std::string name = row == 2 ? std::string("a,\"b\"") : "row" + std::to_string(row);
+                ok = table.string(b, 0, r) == name && values[r] == 1.0 / static_cast<double>(row + 1) &&
+                     counts[r] == static_cast<int64_t>(row) - 3;
+            }
+        }
+    }
+    std::filesystem::resize_file(table_path, std::filesystem::file_size(table_path) - 4);
+    bool truncated_rejected = false;
+    try {
+        fpstudy::core::ColumnarTable table(table_path);
+    } catch (const std::runtime_error&) {
+        truncated_rejected = true;
+    }
+    std::filesystem::remove(typed_csv);
+    std::filesystem::remove(table_path);
+    if (!ok || !truncated_rejected) {
+        return false;
+    }
+
+    // Resume manifest: rows are committed with the CSV length that holds
+    // them, skipped rows do not block later ones, and cells after the last
+    // commit do not count.
+    auto resume_csv = temp_dir / "fpstudy_resume.csv";
+    auto manifest_path = fpstudy::core::manifest_path_for(resume_csv);
+    {
+        fpstudy::core::CsvWriter writer(resume_csv, false);
+        writer.write_header({"index"});
+        fpstudy::core::ManifestWriter manifest(manifest_path, false);
+        fpstudy::core::OrderedRowSink sink(writer, nullptr, &manifest);
+        sink.push(2, {std::string("2")}, 102);
+        sink.skip(1);
+        sink.push(0, {std::string("0")}, 100);
+        ok = sink.rows_written() == 3 && sink.rows_pending() == 0;
+        sink.commit();
+        sink.push(3, {std::string("3")}, 103);
+    }
+    {
+        std::ofstream torn(manifest_path, std::ios::app);
+        torn << "cell 0000000000000067\ncommit 99";
+    }
+    auto loaded = fpstudy::core::SweepManifest::load(manifest_path);
+    ok = ok && loaded.size() == 2 && loaded.contains(100) && loaded.contains(102) && !loaded.contains(103) &&
+         loaded.committed_bytes() == std::string("index\n0\n2\n").size();
+    fpstudy::core::rewrite_manifest(manifest_path, loaded);
+    auto rewritten = fpstudy::core::SweepManifest::load(manifest_path);
+    ok = ok && rewritten.size() == 2 && rewritten.committed_bytes() == loaded.committed_bytes();
+    std::filesystem::remove(resume_csv);
+    std::filesystem::remove(manifest_path);
+    if (!ok) {
+        return false;
+    }
+
+    // Shards: rows of units owned by other shards are skipped, and merge
+    // interleaves the shard CSVs back into serial order, whatever order the
+    // shards are given in, and rejects incomplete sets.
+    auto spec = fpstudy::core::ShardSpec::parse("1/2");
+    bool bad_spec_rejected = false;
+    try {
+        fpstudy::core::ShardSpec::parse("2/2");
+    } catch (const std::runtime_error&) {
+        bad_spec_rejected = true;
+    }
+    ok = bad_spec_rejected && spec.owns(3) && !spec.owns(4) &&
+         fpstudy::core::shard_csv_path(temp_dir / "sweep.csv", spec) == temp_dir / "sweep.shard-1-of-2.csv";
+    std::vector<std::filesystem::path> shard_csvs;
+    for (std::size_t s = 0; s < 2; ++s) {
+        fpstudy::core::ShardSpec shard{s, 2};
+        auto path = temp_dir / ("fpstudy_shard_" + std::to_string(s) + ".csv");
+        shard_csvs.push_back(path);
+        fpstudy::core::CsvWriter writer(path, false);
+        writer.write_header({"index"});
+        fpstudy::core::RowIndexWriter row_index(fpstudy::core::row_index_path_for(path), shard);
+        fpstudy::core::OrderedRowSink sink(writer, nullptr, nullptr, &row_index);
+        for (std::size_t unit = 0; unit < 3; ++unit) {
+            for (std::size_t r = 0; r < 2; ++r) {
+                std::size_t row = unit * 2 + r;
+                if (shard.owns(unit)) {
+                    sink.push(row, {std::to_string(row)});
+                } else {
+                    sink.skip(row);
+                }
+            }
+        }
+        sink.commit();
+    }
+    auto merged_path = temp_dir / "fpstudy_merged.csv";
+    std::size_t merged_rows = fpstudy::core::merge_shards({shard_csvs[1], shard_csvs[0]}, merged_path);
+    std::ifstream merged_in(merged_path);
+    std::string merged((std::istreambuf_iterator<char>(merged_in)), std::istreambuf_iterator<char>());
+    ok = ok && merged_rows == 6 && merged == "index\n0\n1\n2\n3\n4\n5\n";
+    bool incomplete_rejected = false;
+    try {
+        fpstudy::core::merge_shards({shard_csvs[0]}, merged_path);
+    } catch (const std::runtime_error&) {
+        incomplete_rejected = true;
+    }
+    ok = ok && incomplete_rejected;
+    for (const auto& path : shard_csvs) {
+        std::filesystem::remove(path);
+        std::filesystem::remove(fpstudy::core::row_index_path_for(path));
+    }
+    std::filesystem::remove(merged_path);
+    if (!ok) {
+        return false;
+    }
+
+    // The fused metrics pass must reproduce the two-norm formula bit for bit.
+    std::vector<double> truth(1000);
+    std::vector<float> approx(truth.size());
+    for (std::size_t i = 0; i < truth.size(); ++i) {
+        truth[i] = std::sin(static_cast<double>(i) * 0.37) * 1e3;
+        approx[i] = static_cast<float>(truth[i]);
+    }
+    double truth_sq = 0.0;
+    double diff_sq = 0.0;
+    for (std::size_t i = 0; i < truth.size(); ++i) {
+        double d = truth[i] - static_cast<double>(approx[i]);
+        truth_sq += truth[i] * truth[i];
+        diff_sq += d * d;
+    }
+    auto metrics = fpstudy::core::compute_metrics(truth, approx);
+    ok = metrics.relative_error == std::sqrt(diff_sq) / std::sqrt(truth_sq) &&
+         metrics.nan_count == 0 && metrics.inf_count == 0;
+    approx[3] = std::numeric_limits<float>::quiet_NaN();
+    approx[5] = -std::numeric_limits<float>::infinity();
+    approx[8] = std::numeric_limits<float>::infinity();
+    metrics = fpstudy::core::compute_metrics(truth, approx);
+    ok = ok && metrics.nan_count == 1 && metrics.inf_count == 2 && std::isnan(metrics.relative_error);
+
+    // Counter deltas scale by enabled/running time when multiplexed, batch
+    // shares divide them, and a timer with counting off records nothing.
+    fpstudy::core::detail::PerfSnapshot start;
+    fpstudy::core::detail::PerfSnapshot end;
+    start.values = {100, 200, 10, 5};
+    start.time_enabled = 1000;
+    start.time_running = 1000;
+    end.values = {1100, 2200, 30, 9};
+    end.time_enabled = 3000;
+    end.time_running = 2000;
+    auto counts = fpstudy::core::detail::perf_counts_between(start, end);
+    auto share = counts.share(4);
+    fpstudy::core::ScopedTimer timer;
+    ok = ok && counts.cycles == 2000 && counts.instructions == 4000 && counts.cache_misses == 40 &&
+         counts.branch_misses == 8 && share.cycles == 500 && share.branch_misses == 2 &&
+         !fpstudy::core::detail::perf_counts_between(start, start).valid() &&
+         !timer.counters().valid() && timer.counters().share(3).cache_misses == -1;
+
+    // The arena hands out the same block after a reset, regrows it to cover
+    // an overflow, and only the outermost scope on a thread resets it.
+    fpstudy::core::Arena arena(4096);
+    void* first = arena.resource()->allocate(1024);
+    arena.reset();
+    ok = ok && arena.resource()->allocate(1024) == first;
+    {
+        std::pmr::vector<double> big(1024, 0.0, arena.resource());
+        ok = ok && big.size() == 1024;
+    }
+    arena.reset();
+    ok = ok && arena.block_bytes() >= 4096 + 1024 * sizeof(double);
+    {
+        fpstudy::core::ArenaScope outer;
+        void* held = outer.resource()->allocate(64);
+        {
+            fpstudy::core::ArenaScope inner;
+            ok = ok && inner.resource() == outer.resource() && inner.resource()->allocate(64) != held;
+        }
+        std::pmr::vector<int> after(4, 7, outer.resource());
+        ok = ok && after.data() != held && after[3] == 7;
+    }
+
+    // Backend profiles keep the fastest exact backend per cell, replace a
+    // cell recorded twice, and survive a save/load round trip.
+    {
+        auto profile_path = temp_dir / "fpstudy_backend_profile.json";
+        fpstudy::core::BackendProfile profile("host-a");
+        profile.record({"matmul", "bf16", 64, "", {{"reference", 2.0, true}, {"blocked", 0.5, false},
+                                                   {"vectorized", 0.8, true}}});
+        profile.record({"fir", "fp32", 32, "", {{"reference", 1.0, true}, {"fixed", 0.9, true}}});
+        profile.record({"fir", "fp32", 32, "", {{"reference", 1.0, true}, {"fixed", 1.5, true}}});
+        bool no_exact_throws = false;
+        try {
+            profile.record({"fir", "fp64", 8, "", {{"fixed", 0.1, false}}});
+        } catch (const std::runtime_error&) {
+            no_exact_throws = true;
+        }
+        profile.save(profile_path);
+        auto loaded = fpstudy::core::BackendProfile::load(profile_path);
+        std::filesystem::remove(profile_path);
+        const auto* matmul = loaded.backend_for("matmul", "bf16", 64);
+        const auto* fir = loaded.backend_for("fir", "fp32", 32);
+        ok = ok && no_exact_throws && loaded.host() == "host-a" && loaded.size() == 2 && matmul &&
+             *matmul == "vectorized" && fir && *fir == "reference" && !loaded.backend_for("matmul", "bf16", 32) &&
+             loaded.kernels().front()->algo == "fir" && loaded.kernels().back()->timings.size() == 3 &&
+             !loaded.kernels().back()->timings[1].exact;
+        bool missing_throws = false;
+        try {
+            fpstudy::core::BackendProfile::load(profile_path);
+        } catch (const std::runtime_error&) {
+            missing_throws = true;
+        }
+        ok = ok && missing_throws;
+    }
+
+    // Philox4x32-10 known-answer vectors from Random123.
+    constexpr auto zero = fpstudy::core::philox4x32({0, 0, 0, 0}, {0, 0});
+    static_assert(zero == fpstudy::core::PhiloxCounter{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u});
+    ok = ok && fpstudy::core::philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+                                         {0xa4093822u, 0x299f31d0u}) ==
+                   fpstudy::core::PhiloxCounter{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u};
+
+    // Philox normals: any sub-range regenerates the same elements, the
+    // parallel fill matches the serial one, each pair is Box-Muller of its
+    // counter block to within a few ulps of libm, and the moments are N(0, 1).
+    const std::size_t draws = (std::size_t(1) << 19) + 3;
+    std::vector<double> serial(draws);
+    std::vector<double> parallel(draws);
+    fpstudy::core::philox_normal_fill(77, 2, 0, serial);
+    fpstudy::core::philox_normal_fill_parallel(77, 2, parallel);
+    ok = ok && serial == parallel;
+    // On a pool worker the fill stays on that thread and gives the same values.
+    {
+        std::vector<double> on_worker(draws);
+        bool worker_flag = false;
+        fpstudy::core::ThreadPool pool(1);
+        pool.submit([&] {
+            worker_flag = fpstudy::core::ThreadPool::on_worker_thread();
+            fpstudy::core::philox_normal_fill_parallel(77, 2, on_worker);
+        });
+        pool.wait();
+        ok = ok && worker_flag && !fpstudy::core::ThreadPool::on_worker_thread() && on_worker == serial;
+    }
+    std::vector<double> window(501);
+    fpstudy::core::philox_normal_fill(77, 2, 333, window);
+    ok = ok && std::equal(window.begin(), window.end(), serial.begin() + 333);
+    for (uint32_t k = 0; k < 1000; ++k) {
+        const auto w = fpstudy::core::philox4x32({k, 0, 0, 0}, {77, 2});
+        const double u1 = 1.0 - static_cast<double>((((uint64_t(w[0]) << 32) | w[1]) >> 12)) * 0x1p-52;
+        const double u2 = static_cast<double>((((uint64_t(w[2]) << 32) | w[3]) >> 12)) * 0x1p-52;
+        const double radius = std::sqrt(-2.0 * std::log(u1));
+        const double angle = 2.0 * 3.14159265358979323846 * u2;
+        ok = ok && std::abs(serial[2 * k] - radius * std::cos(angle)) <= 1e-14 * std::max(1.0, radius) &&
+             std::abs(serial[2 * k + 1] - radius * std::sin(angle)) <= 1e-14 * std::max(1.0, radius);
+    }
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (double v : serial) {
+        sum += v;
+        sum_sq += v * v;
+    }
+    const double mean = sum / static_cast<double>(draws);
+    const double variance = sum_sq / static_cast<double>(draws) - mean * mean;
+    ok = ok && std::abs(mean) < 0.01 && std::abs(variance - 1.0) < 0.01;
+    fpstudy::core::Random philox_rng(77, fpstudy::core::RngKind::Philox);
+    auto first_draw = fpstudy::core::random_vector(16, philox_rng, 2.0);
+    auto second_draw = fpstudy::core::random_vector(16, philox_rng, 2.0);
+    std::vector<double> stream_one(1);
+    fpstudy::core::philox_normal_fill(77, 1, 0, stream_one, 2.0);
+    ok = ok && second_draw[0] == stream_one[0] && second_draw != first_draw &&
+         fpstudy::core::rng_kind_from_string("Philox") == fpstudy::core::RngKind::Philox;
     return ok;
 }
 
@@ -1,9 +1,147 @@
 #include <cmath>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 #include "algorithms/gradient_descent.hpp"
 #include "algorithms/newton.hpp"
+#include "core/spd.hpp"
+#include "formats/precision.hpp"
+
+namespace {
+
+template <typename T>
+bool vectorized_gd_matches_reference(std::size_t dim, const char* name) {
+    std::vector<double> Q(dim * dim);
+    std::vector<double> b(dim);
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < dim; ++j) {
+            Q[i * dim + j] = (i == j) ? 4.0 + 0.1 * static_cast<double>(i % 5) : 0.5 / (1.0 + static_cast<double>(i + j));
+        }
+        b[i] = std::sin(static_cast<double>(i) + 0.3);
+    }
+    std::vector<double> x0(dim, 0.0);
+    fpstudy::algorithms::GradientDescentOptions opts;
+    opts.step_size = 0.05;
+    opts.max_iters = 150;
+    opts.tol = 1e-4;
+    auto Qt = fpstudy::formats::cast_vector<T>(Q);
+    auto bt = fpstudy::formats::cast_vector<T>(b);
+    auto xt = fpstudy::formats::cast_vector<T>(x0);
+    auto ref = fpstudy::algorithms::gradient_descent_quadratic<T>(Qt, bt, xt, dim, opts);
+    opts.backend = fpstudy::algorithms::Backend::Vectorized;
+    auto vec = fpstudy::algorithms::gradient_descent_quadratic<T>(Qt, bt, xt, dim, opts);
+    // Row blocks on several threads must not change a single bit either.
+    opts.threads = 4;
+    auto vec_threaded = fpstudy::algorithms::gradient_descent_quadratic<T>(Qt, bt, xt, dim, opts);
+    opts.backend = fpstudy::algorithms::Backend::Reference;
+    auto ref_threaded = fpstudy::algorithms::gradient_descent_quadratic<T>(Qt, bt, xt, dim, opts);
+    bool ok = true;
+    for (const auto* run : {&vec, &vec_threaded, &ref_threaded}) {
+        ok = ok && ref.iterations == run->iterations && ref.converged == run->converged;
+        for (std::size_t i = 0; ok && i < dim; ++i) {
+            ok = static_cast<double>(ref.x[i]) == static_cast<double>(run->x[i]);
+        }
+    }
+    if (!ok) {
+        std::cerr << "Vectorized or threaded gradient descent (" << name << ", dim=" << dim
+                  << ") differs from reference\n";
+    }
+    return ok;
+}
+
+// The blocked SYRK must match the column-walking triple loop bit for bit, and
+// the spectral generator must keep the prescribed eigenvalues, checked
+// through the similarity invariants trace(Q) and ||Q||_F.
+bool spd_generators_match() {
+    const std::size_t dim = 70;
+    for (std::size_t rows : {std::size_t{70}, std::size_t{5}}) {
+        fpstudy::core::Random rng(42);
+        auto M = fpstudy::core::random_matrix(rows, dim, rng);
+        auto Q = fpstudy::core::gram_spd(M, rows, dim, 7.0);
+        for (std::size_t i = 0; i < dim; ++i) {
+            for (std::size_t j = 0; j < dim; ++j) {
+                double acc = 0.0;
+                for (std::size_t k = 0; k < rows; ++k) {
+                    acc += M[k * dim + i] * M[k * dim + j];
+                }
+                if (i == j) acc += 7.0;
+                if (Q[i * dim + j] != acc) {
+                    std::cerr << "gram_spd differs from the triple loop at (" << i << ", " << j << ")\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    fpstudy::core::Random rng(7);
+    const double condition = 1e4;
+    auto Q = fpstudy::core::spectral_spd(dim, condition, rng);
+    double trace = 0.0;
+    double frobenius = 0.0;
+    double expected_trace = 0.0;
+    double expected_frobenius = 0.0;
+    for (std::size_t i = 0; i < dim; ++i) {
+        double lambda = std::pow(condition, -static_cast<double>(i) / static_cast<double>(dim - 1));
+        expected_trace += lambda;
+        expected_frobenius += lambda * lambda;
+        trace += Q[i * dim + i];
+        for (std::size_t j = 0; j < dim; ++j) {
+            frobenius += Q[i * dim + j] * Q[i * dim + j];
+            if (Q[i * dim + j] != Q[j * dim + i]) {
+                std::cerr << "spectral_spd is not symmetric\n";
+                return false;
+            }
+        }
+    }
+    if (std::fabs(trace - expected_trace) > 1e-12 * expected_trace ||
+        std::fabs(frobenius - expected_frobenius) > 1e-12 * expected_frobenius ||
+        std::fabs(Q[1]) < 1e-6) {
+        std::cerr << "spectral_spd does not preserve its spectrum or is still diagonal\n";
+        return false;
+    }
+
+    // ill_conditioned has no meaning for a prescribed spectrum.
+    fpstudy::core::SpdOptions spectral;
+    spectral.kind = fpstudy::core::SpdKind::Spectral;
+    try {
+        fpstudy::core::make_spd(dim, rng, true, spectral);
+        std::cerr << "make_spd accepted ill_conditioned for a spectral matrix\n";
+        return false;
+    } catch (const std::runtime_error&) {
+    }
+    return true;
+}
+
+// Each lane of newton_raphson_batch must retire exactly where the scalar loop
+// returns, including zero-derivative starts and lanes that never converge.
+template <typename T>
+bool newton_batch_matches_scalar(const char* name) {
+    auto f = [](T x) { return x * x * x - T(2.0); };
+    auto df = [](T x) { return T(3.0) * x * x; };
+    fpstudy::algorithms::NewtonOptions opts;
+    opts.max_iters = 25;
+    opts.tol = 1e-6;
+    std::vector<T> initials;
+    for (int i = 0; i < 150; ++i) {
+        initials.push_back(T(-3.0 + 0.04 * i));
+    }
+    initials.push_back(T(0.0));
+    auto batch = fpstudy::algorithms::newton_raphson_batch<T>(initials, f, df, opts);
+    for (std::size_t i = 0; i < initials.size(); ++i) {
+        auto scalar = fpstudy::algorithms::newton_raphson<T>(initials[i], f, df, opts);
+        double a = static_cast<double>(scalar.root);
+        double b = static_cast<double>(batch.roots[i]);
+        if (!(a == b || (std::isnan(a) && std::isnan(b))) || scalar.iterations != batch.iterations[i] ||
+            scalar.converged != (batch.converged[i] != 0)) {
+            std::cerr << "newton_raphson_batch (" << name << ") differs from the scalar loop at lane " << i << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 bool run_iterative_tests() {
     // Gradient descent test
@@ -45,6 +183,18 @@ bool run_iterative_tests() {
         std::cerr << "Newton method failed to converge to cube root of 2\n";
         return false;
     }
-    return true;
+
+    for (std::size_t dim : {3, 17, 300, 613}) {
+        if (!vectorized_gd_matches_reference<float>(dim, "fp32") ||
+            !vectorized_gd_matches_reference<fpstudy::formats::BF16>(dim, "bf16") ||
+            !vectorized_gd_matches_reference<fpstudy::formats::TF32>(dim, "tf32")) {
+            return false;
+        }
+    }
+    if (!newton_batch_matches_scalar<double>("fp64") || !newton_batch_matches_scalar<float>("fp32") ||
+        !newton_batch_matches_scalar<fpstudy::formats::BF16>("bf16")) {
+        return false;
+    }
+    return spd_generators_match();
 }
 
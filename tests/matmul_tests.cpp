@@ -1,12 +1,223 @@
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <cassert>
 
 #include "algorithms/matmul.hpp"
+#include "algorithms/mx.hpp"
 #include "formats/precision.hpp"
 
+namespace {
+
+template <typename T>
+uint64_t value_bits(const T& v) {
+    if constexpr (fpstudy::formats::is_p3109_number_v<T>) {
+        return v.raw();
+    } else {
+        return std::bit_cast<uint64_t>(static_cast<double>(v));
+    }
+}
+
+template <typename T>
+bool backend_matches_reference(std::size_t n, fpstudy::algorithms::Backend backend, const char* name) {
+    std::mt19937 engine(static_cast<uint32_t>(n * 31 + 7));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(n * n);
+    std::vector<double> B(n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : B) v = dist(engine);
+    auto At = fpstudy::formats::cast_vector<T>(A);
+    auto Bt = fpstudy::formats::cast_vector<T>(B);
+
+    for (bool kahan : {false, true}) {
+        for (bool fp32 : {false, true}) {
+            fpstudy::algorithms::MatMulOptions ref_opts{kahan, fp32};
+            fpstudy::algorithms::MatMulOptions blk_opts{kahan, fp32, backend};
+            auto ref = fpstudy::algorithms::matmul_square<T>(At, Bt, n, ref_opts);
+            auto blk = fpstudy::algorithms::matmul_square<T>(At, Bt, n, blk_opts);
+            for (std::size_t i = 0; i < ref.size(); ++i) {
+                if (value_bits(ref[i]) != value_bits(blk[i])) {
+                    std::cerr << fpstudy::algorithms::backend_to_string(backend) << " matmul (" << name << ", n=" << n << ", kahan=" << kahan
+                              << ", fp32=" << fp32 << ") differs at index " << i << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Each batch element must match a standalone matmul_square bit for bit.
+template <typename T>
+bool batched_matches_single(std::size_t n, std::size_t batch, fpstudy::algorithms::Backend backend, const char* name) {
+    std::mt19937 engine(static_cast<uint32_t>(n * 17 + batch));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(batch * n * n);
+    std::vector<double> B(batch * n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : B) v = dist(engine);
+    auto At = fpstudy::formats::cast_vector<T>(A);
+    auto Bt = fpstudy::formats::cast_vector<T>(B);
+
+    for (bool fp32 : {false, true}) {
+        fpstudy::algorithms::MatMulOptions opts{false, fp32, backend};
+        auto C = fpstudy::algorithms::matmul_batched<T>(At, Bt, n, batch, opts);
+        std::span<const T> a(At);
+        std::span<const T> b(Bt);
+        for (std::size_t e = 0; e < batch; ++e) {
+            auto single = fpstudy::algorithms::matmul_square<T>(a.subspan(e * n * n, n * n),
+                                                                b.subspan(e * n * n, n * n), n, opts);
+            for (std::size_t i = 0; i < single.size(); ++i) {
+                if (value_bits(single[i]) != value_bits(C[e * n * n + i])) {
+                    std::cerr << "batched matmul (" << name << ", n=" << n << ", fp32=" << fp32
+                              << ") element " << e << " differs at index " << i << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Split-K must equal its definition: slice s is the sequential product over
+// k in [n s / slices, n (s + 1) / slices) (the A columns outside it zeroed,
+// which adds exact zeros), and the partials meet in a pairwise tree.
+template <typename T>
+bool split_k_matches_tree(std::size_t n, std::size_t slices, const char* name) {
+    namespace alg = fpstudy::algorithms;
+    std::mt19937 engine(static_cast<uint32_t>(n * 13 + slices));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(n * n);
+    std::vector<double> B(n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : B) v = dist(engine);
+    auto At = fpstudy::formats::cast_vector<T>(A);
+    auto Bt = fpstudy::formats::cast_vector<T>(B);
+
+    std::vector<std::vector<T>> partials;
+    for (std::size_t s = 0; s < slices; ++s) {
+        auto masked = At;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = 0; k < n; ++k) {
+                if (k < n * s / slices || k >= n * (s + 1) / slices) {
+                    masked[i * n + k] = T(0.0);
+                }
+            }
+        }
+        partials.push_back(alg::matmul_square<T>(masked, Bt, n));
+    }
+    for (std::size_t stride = 1; stride < slices; stride *= 2) {
+        for (std::size_t s = 0; s + stride < slices; s += 2 * stride) {
+            for (std::size_t i = 0; i < n * n; ++i) {
+                partials[s][i] = partials[s][i] + partials[s + stride][i];
+            }
+        }
+    }
+    alg::MatMulOptions opts;
+    opts.split_k = slices;
+    auto C = alg::matmul_square<T>(At, Bt, n, opts);
+    for (std::size_t i = 0; i < C.size(); ++i) {
+        if (value_bits(C[i]) != value_bits(partials[0][i])) {
+            std::cerr << "split-K matmul (" << name << ", n=" << n << ", split_k=" << slices
+                      << ") differs from the tree of slice products at index " << i << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split-K results must not depend on the backend or the thread count.
+template <typename T>
+bool split_k_invariant(std::size_t n, std::size_t slices, const char* name) {
+    namespace alg = fpstudy::algorithms;
+    std::mt19937 engine(static_cast<uint32_t>(n * 29 + slices));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(n * n);
+    std::vector<double> B(n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : B) v = dist(engine);
+    auto At = fpstudy::formats::cast_vector<T>(A);
+    auto Bt = fpstudy::formats::cast_vector<T>(B);
+
+    for (bool kahan : {false, true}) {
+        for (bool fp32 : {false, true}) {
+            alg::MatMulOptions base{kahan, fp32};
+            base.split_k = slices;
+            auto ref = alg::matmul_square<T>(At, Bt, n, base);
+            for (auto backend : {alg::Backend::Blocked, alg::Backend::Vectorized}) {
+                for (std::size_t threads : {std::size_t(1), std::size_t(3)}) {
+                    auto opts = base;
+                    opts.backend = backend;
+                    opts.threads = threads;
+                    auto C = alg::matmul_square<T>(At, Bt, n, opts);
+                    for (std::size_t i = 0; i < ref.size(); ++i) {
+                        if (value_bits(ref[i]) != value_bits(C[i])) {
+                            std::cerr << "split-K matmul (" << name << ", n=" << n << ", kahan=" << kahan
+                                      << ", fp32=" << fp32 << ", threads=" << threads << ", "
+                                      << alg::backend_to_string(backend) << ") differs at index " << i << "\n";
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// MX products against an FP64 product of the decoded operands, within the
+// FP32 rounding of the block sums; the batched form must reproduce each
+// square product exactly. A and Bt may use different element layouts.
+bool mx_matmul_within_bound(std::size_t n, const fpstudy::formats::P3109Layout& a_layout,
+                            const fpstudy::formats::P3109Layout& b_layout) {
+    namespace alg = fpstudy::algorithms;
+    using fpstudy::formats::MxVector;
+    constexpr std::size_t batch = 2;
+    std::mt19937 engine(static_cast<uint32_t>(n));
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> A(batch * n * n);
+    std::vector<double> Bt(batch * n * n);
+    for (double& v : A) v = dist(engine);
+    for (double& v : Bt) v = std::ldexp(dist(engine), static_cast<int>(engine() % 9) - 4);
+    auto Am = MxVector::encode(a_layout, A, n);
+    auto Bm = MxVector::encode(b_layout, Bt, n);
+    std::vector<float> batched(batch * n * n);
+    alg::matmul_batched_mx_into(Am, Bm, n, batch, batched);
+    auto Ad = Am.to_doubles();
+    auto Bd = Bm.to_doubles();
+    for (std::size_t e = 0; e < batch; ++e) {
+        auto Ae = MxVector::encode(a_layout, std::span<const double>(A).subspan(e * n * n, n * n), n);
+        auto Be = MxVector::encode(b_layout, std::span<const double>(Bt).subspan(e * n * n, n * n), n);
+        auto C = alg::matmul_square_mx(Ae, Be, n, {true});
+        auto plain = alg::matmul_square_mx(Ae, Be, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                double exact = 0.0;
+                double magnitude = 0.0;
+                for (std::size_t k = 0; k < n; ++k) {
+                    const double prod = Ad[e * n * n + i * n + k] * Bd[e * n * n + j * n + k];
+                    exact += prod;
+                    magnitude += std::fabs(prod);
+                }
+                const std::size_t c = i * n + j;
+                if (std::fabs(C[c] - exact) > 1e-6 * magnitude || plain[c] != batched[e * n * n + c]) {
+                    std::cerr << "matmul_mx n=" << n << ": element " << c << " of batch " << e << " is off\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 bool run_matmul_tests() {
     std::vector<double> A = {1.0, 2.0, 3.0, 4.0};
     std::vector<double> B = {5.0, 6.0, 7.0, 8.0};
@@ -18,12 +229,96 @@ bool run_matmul_tests() {
             return false;
         }
     }
+
+    // The blocked engine must reproduce the reference bit for bit, including
+    // ragged edge tiles and sizes spanning several k panels.
+    using fpstudy::algorithms::Backend;
+    for (std::size_t n : {1, 5, 13, 67, 261}) {
+        if (!backend_matches_reference<double>(n, Backend::Blocked, "fp64") ||
+            !backend_matches_reference<float>(n, Backend::Blocked, "fp32")) {
+            return false;
+        }
+    }
+    for (std::size_t n : {3, 13, 67}) {
+        if (!backend_matches_reference<fpstudy::formats::BF16>(n, Backend::Blocked, "bf16") ||
+            !backend_matches_reference<fpstudy::formats::P3109Number<>>(n, Backend::Blocked, "p3109_8")) {
+            return false;
+        }
+    }
+
+    // Fixed-size kernels at every specialized size, and a size that falls back.
+    for (std::size_t n : {16, 32, 64, 24}) {
+        if (!backend_matches_reference<double>(n, Backend::Fixed, "fp64") ||
+            !backend_matches_reference<float>(n, Backend::Fixed, "fp32") ||
+            !backend_matches_reference<fpstudy::formats::BF16>(n, Backend::Fixed, "bf16") ||
+            !backend_matches_reference<fpstudy::formats::P3109Number<>>(n, Backend::Fixed, "p3109_8")) {
+            return false;
+        }
+    }
+
+    // FP32-emulated lanes must agree with the cfloat arithmetic they replace.
+    if (!fpstudy::formats::fp32_emulation_verified<fpstudy::formats::BF16>() ||
+        !fpstudy::formats::fp32_emulation_verified<fpstudy::formats::TF32>()) {
+        std::cerr << "FP32 emulation does not match cfloat arithmetic\n";
+        return false;
+    }
+    if (!backend_matches_reference<float>(261, Backend::Vectorized, "fp32")) {
+        return false;
+    }
+    for (std::size_t n : {1, 7, 37, 70}) {
+        if (!backend_matches_reference<float>(n, Backend::Vectorized, "fp32") ||
+            !backend_matches_reference<fpstudy::formats::BF16>(n, Backend::Vectorized, "bf16") ||
+            !backend_matches_reference<fpstudy::formats::TF32>(n, Backend::Vectorized, "tf32")) {
+            return false;
+        }
+    }
+
+    for (auto backend : {Backend::Reference, Backend::Blocked, Backend::Vectorized}) {
+        if (!batched_matches_single<double>(9, 3, backend, "fp64") ||
+            !batched_matches_single<fpstudy::formats::BF16>(9, 3, backend, "bf16")) {
+            return false;
+        }
+    }
+    bool rejected = false;
+    try {
+        std::vector<double> short_operand(7);
+        fpstudy::algorithms::matmul_batched<double>(short_operand, short_operand, 2, 2);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    if (!rejected) {
+        std::cerr << "matmul_batched accepted mismatched operand sizes\n";
+        return false;
+    }
+
+    for (std::size_t slices : {2, 3, 5}) {
+        if (!split_k_matches_tree<float>(37, slices, "fp32") ||
+            !split_k_matches_tree<fpstudy::formats::BF16>(37, slices, "bf16") ||
+            !split_k_matches_tree<fpstudy::formats::P3109Number<>>(37, slices, "p3109_8")) {
+            return false;
+        }
+    }
+    if (!split_k_matches_tree<double>(300, 4, "fp64") || !split_k_invariant<double>(300, 4, "fp64") ||
+        !split_k_invariant<fpstudy::formats::BF16>(23, 6, "bf16") ||
+        !split_k_invariant<fpstudy::formats::TF32>(3, 8, "tf32")) {
+        return false;
+    }
+
+    using fpstudy::formats::P3109Layout;
+    for (std::size_t n : {1, 32, 45, 70}) {
+        if (!mx_matmul_within_bound(n, P3109Layout{4, 3, 7}, P3109Layout{4, 3, 7}) ||
+            !mx_matmul_within_bound(n, P3109Layout{4, 3, 7}, P3109Layout{5, 2, 15}) ||
+            !mx_matmul_within_bound(n, P3109Layout{2, 1, 1}, P3109Layout{3, 2, 3})) {
+            return false;
+        }
+    }
     return true;
 }
 
 bool run_iterative_tests();
 bool run_io_tests();
 bool run_fir_tests();
+bool run_format_tests();
 
 int main(int argc, char** argv) {
     if (argc < 2) {
@@ -40,6 +335,8 @@ int main(int argc, char** argv) {
         ok = run_io_tests();
     } else if (suite == "FIR") {
         ok = run_fir_tests();
+    } else if (suite == "Formats") {
+        ok = run_format_tests();
     } else {
         std::cerr << "Unknown test suite: " << suite << "\n";
         return 1;